@@ -222,6 +222,20 @@ _REV_EXTERN int revCountDisks(RevBoard *board, RevDiskType disk_type);
  */
 _REV_EXTERN RevDiskType revGetWinner(RevBoard *board);
 
+/**
+ * Gets disks that can never be flipped for the rest of the game.
+ * A disk is counted when each line through it is full, or is blocked by the edge
+ * or by another stable disk of the same color.
+ *
+ * @note The result is a lower bound. Some stable disks might be missing from it.
+ *
+ * @param board RevBoard instance
+ * @param disk_type #DISK_BLACK or #DISK_WHITE
+ * @returns A bitboard of stable disks.
+ * @memberof RevBoard
+ */
+_REV_EXTERN RevBitboard revGetStableDisks(RevBoard *board, RevDiskType disk_type);
+
 /**
  * Sets a disk on a board.
  * 
@@ -297,6 +311,18 @@ _REV_EXTERN int *revGetMobilityAsArray(RevBoard *board);
  */
 _REV_EXTERN int revGetMobilityCount(RevBoard *board);
 
+/**
+ * Gets legal moves sorted from the most promising one.
+ * Moves are ranked by corners, X-squares and C-squares next to empty corners,
+ * and the opponent's mobility after the move.
+ *
+ * @param board RevBoard instance
+ * @param moves An array to store positions. Its size should be revGetMobilityCount() or more.
+ * @returns Number of legal moves.
+ * @memberof RevBoard
+ */
+_REV_EXTERN int revGetSortedMoves(RevBoard *board, int *moves);
+
 /**
  * Returns whether or not the current player has legal moves.
  * 
@@ -440,6 +466,1283 @@ _REV_EXTERN void revMoveRandomToEnd(RevBoard *board);
  */
 _REV_EXTERN int revGenMoveMonteCarlo(RevBoard *board, int trials);
 
+/**
+ * Class for a transposition table.
+ * It caches results of the alpha-beta search, and can be shared by threads and searches.
+ *
+ * @struct RevHashTable
+ */
+typedef struct RevHashTable RevHashTable;
+
+/**
+ * Creates a new transposition table.
+ * Same as revNewHashTableWithFlags() with #REV_HASH_TRANSPARENT_HUGE_PAGES.
+ *
+ * @param size_mb Memory size in megabytes. It's rounded down to a power of 2.
+ * @returns A new table. `NULL` if it failed to allocate memory.
+ * @memberof RevHashTable
+ */
+_REV_EXTERN RevHashTable *revNewHashTable(int size_mb);
+
+/**
+ * Flag of revNewHashTableWithFlags() to use huge pages that are reserved by the system.
+ * Linux needs pages in `/proc/sys/vm/nr_hugepages`. Windows needs the
+ * "Lock pages in memory" privilege. Otherwise, it falls back to transparent huge pages.
+ */
+#define REV_HASH_HUGE_PAGES 1
+
+/**
+ * Flag of revNewHashTableWithFlags() to ask Linux to back the table with transparent
+ * 2 MB pages. Probes of big tables are random accesses, and each of them can miss the TLB
+ * with 4 KB pages. It's ignored on other systems.
+ */
+#define REV_HASH_TRANSPARENT_HUGE_PAGES 2
+
+/**
+ * Flag of revNewHashTableWithFlags() to spread the table over all NUMA nodes on Linux,
+ * so that threads on every node share the memory bandwidth. It's ignored when the system
+ * has only one node.
+ */
+#define REV_HASH_NUMA_INTERLEAVE 4
+
+/**
+ * Creates a new transposition table with options for page types and memory placement.
+ * Options that are not available fall back to normal memory, so they never cause a failure.
+ * Tables smaller than 2 MB always use normal memory.
+ *
+ * @param size_mb Memory size in megabytes. It's rounded down to a power of 2.
+ * @param flags Bitwise OR of #REV_HASH_HUGE_PAGES, #REV_HASH_TRANSPARENT_HUGE_PAGES,
+ *              and #REV_HASH_NUMA_INTERLEAVE. Zero means normal memory.
+ * @returns A new table. `NULL` if it failed to allocate memory.
+ * @memberof RevHashTable
+ */
+_REV_EXTERN RevHashTable *revNewHashTableWithFlags(int size_mb, int flags);
+
+/**
+ * Flag of revOpenHashTable() to use a POSIX shared memory object instead of a file.
+ * The name should look like `"/reversi_hash"`. The object is kept in memory until
+ * revRemoveHashTable() or a reboot, so it doesn't survive a restart of the machine.
+ */
+#define REV_HASH_SHARED_MEMORY 8
+
+/**
+ * Opens a transposition table that lives in a file or a shared memory object.
+ * Processes that open the same name share entries, and a process that opens it again
+ * later starts with the entries of the previous runs.
+ *
+ * The file starts with a header that has a version and the layout of entries.
+ * A table that is broken or was made by another version is created again,
+ * but only when no other process has it open. Otherwise, this function fails.
+ * It also fails instead of overwriting files that are not tables.
+ *
+ * @note It's only available on Linux, macOS, and other Unix-like systems.
+ *       It returns `NULL` on Windows.
+ * @note Free the table with revFreeHashTable(). The file is kept.
+ * @note revClearHashTable() clears the table for all processes.
+ *
+ * @param name Path to a file, or the name of a shared memory object
+ *             with #REV_HASH_SHARED_MEMORY.
+ * @param size_mb Memory size in megabytes for a new table. It's rounded down to a power of 2.
+ *                Existing tables keep their size.
+ * @param flags Zero or #REV_HASH_SHARED_MEMORY.
+ * @returns The table. `NULL` if it failed to open, create, or map the file.
+ * @memberof RevHashTable
+ */
+_REV_EXTERN RevHashTable *revOpenHashTable(const char *name, int size_mb, int flags);
+
+/**
+ * Removes the file or shared memory object of revOpenHashTable().
+ * Processes that have the table open can keep using it.
+ *
+ * @param name Path to a file, or the name of a shared memory object
+ *             with #REV_HASH_SHARED_MEMORY.
+ * @param flags Zero or #REV_HASH_SHARED_MEMORY.
+ * @returns TRUE if it removed the table.
+ * @memberof RevHashTable
+ */
+_REV_EXTERN int revRemoveHashTable(const char *name, int flags);
+
+/**
+ * Gets the options that took effect when the table was created.
+ * #REV_HASH_TRANSPARENT_HUGE_PAGES means that the system accepted the request.
+ * It may still use 4 KB pages when 2 MB blocks of memory are not available.
+ *
+ * @param hash RevHashTable instance
+ * @returns Bitwise OR of #REV_HASH_HUGE_PAGES, #REV_HASH_TRANSPARENT_HUGE_PAGES,
+ *          #REV_HASH_NUMA_INTERLEAVE, and #REV_HASH_SHARED_MEMORY.
+ * @memberof RevHashTable
+ */
+_REV_EXTERN int revGetHashTableFlags(const RevHashTable *hash);
+
+/**
+ * Frees the memory of a transposition table.
+ *
+ * @note It should not be used by running searches.
+ *
+ * @param hash The table to free memory
+ * @memberof RevHashTable
+ */
+_REV_EXTERN void revFreeHashTable(RevHashTable *hash);
+
+/**
+ * Removes all entries from a transposition table.
+ *
+ * @note It should not be used by running searches.
+ *
+ * @param hash RevHashTable instance
+ * @memberof RevHashTable
+ */
+_REV_EXTERN void revClearHashTable(RevHashTable *hash);
+
+/**
+ * Number of game stages for #RevProbCutParams. Each stage covers 10 empty squares.
+ */
+#define REV_PROBCUT_STAGES 6
+
+/**
+ * Max depth that #RevProbCutParams can have parameters for.
+ */
+#define REV_PROBCUT_MAX_DEPTH 24
+
+/**
+ * Class for regression parameters of Multi-ProbCut.
+ * For each stage and depth, a shallow search predicts the score of the deep search as
+ * `a * shallow_score + b`, and `sigma` is the standard deviation of the error.
+ * Branches are pruned when the prediction is far enough outside of the search window.
+ *
+ * It can be saved to and loaded from a text file.
+ * Each line of the file is `stage depth shallow_depth a b sigma`.
+ * tools/probcut.c fits the parameters from logged searches.
+ *
+ * @struct RevProbCutParams
+ */
+typedef struct RevProbCutParams RevProbCutParams;
+
+/**
+ * Creates ProbCut parameters with the built-in values.
+ *
+ * @returns New parameters. `NULL` if it failed to allocate memory.
+ * @memberof RevProbCutParams
+ */
+_REV_EXTERN RevProbCutParams *revNewProbCutParams();
+
+/**
+ * Loads ProbCut parameters from a text file.
+ * Stages and depths that the file doesn't have are not pruned by ProbCut.
+ *
+ * @param path Path to a file that was written by revSaveProbCutParams().
+ * @returns New parameters. `NULL` if it failed to read the file or the file was broken.
+ * @memberof RevProbCutParams
+ */
+_REV_EXTERN RevProbCutParams *revLoadProbCutParams(const char *path);
+
+/**
+ * Saves ProbCut parameters to a text file.
+ *
+ * @param params RevProbCutParams instance
+ * @param path Path to the file.
+ * @returns `TRUE` on success.
+ * @memberof RevProbCutParams
+ */
+_REV_EXTERN int revSaveProbCutParams(const RevProbCutParams *params, const char *path);
+
+/**
+ * Sets the parameters for a stage and a depth.
+ *
+ * @param params RevProbCutParams instance
+ * @param stage Game stage. See revGetProbCutStage().
+ * @param depth Depth of the deep search. 3 to #REV_PROBCUT_MAX_DEPTH.
+ * @param shallow_depth Depth of the shallow search. It should be less than depth.
+ * @param a Slope of the prediction. It should be positive.
+ * @param b Intercept of the prediction.
+ * @param sigma Standard deviation of the error. Zero disables ProbCut for the depth.
+ * @returns `TRUE` on success. `FALSE` if any of the values is out of range.
+ * @memberof RevProbCutParams
+ */
+_REV_EXTERN int revSetProbCutEntry(RevProbCutParams *params, int stage, int depth,
+                                   int shallow_depth, double a, double b, double sigma);
+
+/**
+ * Frees the memory of ProbCut parameters.
+ *
+ * @note It should not be used by running searches.
+ *
+ * @param params The parameters to free memory
+ * @memberof RevProbCutParams
+ */
+_REV_EXTERN void revFreeProbCutParams(RevProbCutParams *params);
+
+/**
+ * Gets the game stage of a board for #RevProbCutParams.
+ *
+ * @param board RevBoard instance
+ * @returns `(60 - empties) / 10` clamped to 0 to #REV_PROBCUT_STAGES - 1.
+ * @memberof RevBoard
+ */
+_REV_EXTERN int revGetProbCutStage(RevBoard *board);
+
+/**
+ * Number of game stages that #RevEvalWeights has weights for.
+ */
+#define REV_EVAL_STAGES 10
+
+/**
+ * Number of features that revGetEvalFeatures() extracts from a board.
+ * 11 patterns are read in all 8 symmetries of the board, and the last feature is a bias.
+ */
+#define REV_EVAL_FEATURES 89
+
+/**
+ * Number of weights for each game stage of #RevEvalWeights.
+ */
+#define REV_EVAL_WEIGHTS 167266
+
+/**
+ * Class for weights of the pattern evaluation.
+ * The evaluation of a board is the sum of the weights of its features
+ * for the game stage, and estimates the final disk difference for the player to move.
+ * Patterns are lines, diagonals, edges, and corners. Each pattern has a weight for every
+ * combination of disks on its squares, and it's shared by the 8 symmetries of the board.
+ *
+ * It can be saved to and loaded from a binary file.
+ * tools/train.c fits the weights from position records.
+ *
+ * @struct RevEvalWeights
+ */
+typedef struct RevEvalWeights RevEvalWeights;
+
+/**
+ * Creates pattern weights that are all zero.
+ *
+ * @returns New weights. `NULL` if it failed to allocate memory.
+ * @memberof RevEvalWeights
+ */
+_REV_EXTERN RevEvalWeights *revNewEvalWeights();
+
+/**
+ * Loads pattern weights from a file.
+ *
+ * @param path Path to a file that was written by revSaveEvalWeights().
+ * @returns New weights. `NULL` if it failed to read the file, the file was broken,
+ *          or it was written on a machine with another byte order.
+ * @memberof RevEvalWeights
+ */
+_REV_EXTERN RevEvalWeights *revLoadEvalWeights(const char *path);
+
+/**
+ * Saves pattern weights to a file.
+ *
+ * @param weights RevEvalWeights instance
+ * @param path Path to the file.
+ * @returns `TRUE` on success.
+ * @memberof RevEvalWeights
+ */
+_REV_EXTERN int revSaveEvalWeights(const RevEvalWeights *weights, const char *path);
+
+/**
+ * Sets a weight.
+ *
+ * @note Weights are stored in 1/64 disks from -512 to 512 disks.
+ *       The value is rounded and clamped to them.
+ *
+ * @param weights RevEvalWeights instance
+ * @param stage Game stage. See revGetEvalFeatures().
+ * @param feature Index of the weight. 0 to #REV_EVAL_WEIGHTS - 1.
+ * @param value The weight in disks.
+ * @returns `TRUE` on success. `FALSE` if stage or feature is out of range.
+ * @memberof RevEvalWeights
+ */
+_REV_EXTERN int revSetEvalWeight(RevEvalWeights *weights, int stage, int feature, double value);
+
+/**
+ * Gets a weight.
+ *
+ * @param weights RevEvalWeights instance
+ * @param stage Game stage. See revGetEvalFeatures().
+ * @param feature Index of the weight. 0 to #REV_EVAL_WEIGHTS - 1.
+ * @returns The weight in disks. Zero if stage or feature is out of range.
+ * @memberof RevEvalWeights
+ */
+_REV_EXTERN double revGetEvalWeight(const RevEvalWeights *weights, int stage, int feature);
+
+/**
+ * Frees the memory of pattern weights.
+ *
+ * @note It should not be used by running searches.
+ *
+ * @param weights The weights to free memory
+ * @memberof RevEvalWeights
+ */
+_REV_EXTERN void revFreeEvalWeights(RevEvalWeights *weights);
+
+/**
+ * Gets the features of a board from the player to move.
+ * The evaluation is the sum of the weights of the features for the returned stage.
+ * Training tools use it to find the weights that a board depends on.
+ *
+ * @param board RevBoard instance
+ * @param features An array to store indices of weights. Its size should be
+ *                 #REV_EVAL_FEATURES. An index can appear more than once.
+ * @returns Game stage of the board. `(60 - empties) / 6` clamped to 0 to
+ *          #REV_EVAL_STAGES - 1.
+ * @memberof RevBoard
+ */
+_REV_EXTERN int revGetEvalFeatures(RevBoard *board, int *features);
+
+/**
+ * Evaluates a board with pattern weights.
+ *
+ * @param weights RevEvalWeights instance
+ * @param board RevBoard instance
+ * @returns Estimated final disk difference for the player to move.
+ * @memberof RevEvalWeights
+ */
+_REV_EXTERN double revEvaluate(const RevEvalWeights *weights, RevBoard *board);
+
+/**
+ * A position and its target score for revTrainEvalWeights().
+ * Files of records are arrays of it in the native byte order, 24 bytes per record.
+ *
+ * @struct RevEvalRecord
+ */
+typedef struct RevEvalRecord {
+    RevBitboard p_board;  //!< Disks of the player to move.
+    RevBitboard o_board;  //!< Disks of the opponent.
+    double score;  //!< Target score for the player to move, like the final disk difference.
+} RevEvalRecord;
+
+/**
+ * Callback for revTrainEvalWeights().
+ *
+ * @param epoch Number of finished epochs. 1 to `epochs` of RevTrainParams.
+ * @param mse Mean squared error of the records before the update of the epoch.
+ * @param user_data The pointer in RevTrainParams.
+ */
+typedef void (*RevTrainCallback)(int epoch, double mse, void *user_data);
+
+/**
+ * Parameters for revTrainEvalWeights().
+ * Call revInitTrainParams() to fill it with the default values before editing members.
+ *
+ * @struct RevTrainParams
+ */
+typedef struct RevTrainParams {
+    /**
+     * Number of threads. Zero means all logical processors.
+     * Each thread keeps its own gradient of 13 MB.
+     */
+    int threads;
+    int epochs;  //!< Number of passes over the records.
+    /**
+     * Step size of gradient descent. Each weight moves by the mean error of the boards
+     * that have it, times `learning_rate / #REV_EVAL_FEATURES`.
+     * Training diverges when it's too large, usually above 2.
+     */
+    double learning_rate;
+    RevTrainCallback callback;  //!< Called after each epoch. It can be `NULL`.
+    void *user_data;  //!< A pointer that will be passed to callback.
+} RevTrainParams;
+
+/**
+ * Fills training parameters with the default values.
+ *
+ * @note The default is all logical processors, 20 epochs, a learning rate of 1.0,
+ *       and no callback.
+ *
+ * @param params RevTrainParams instance
+ */
+_REV_EXTERN void revInitTrainParams(RevTrainParams *params);
+
+/**
+ * Fits pattern weights to records with full-batch gradient descent on the squared error.
+ * Threads share the records in contiguous blocks, and add up their gradients after each
+ * epoch. Weights of each game stage are trained with the records of the stage.
+ * Weights that no records have are kept as they are.
+ *
+ * @param weights Initial weights. They are updated with the trained ones.
+ * @param records Records to fit.
+ * @param count Number of records.
+ * @param params Training parameters.
+ * @returns `TRUE` on success. `FALSE` if it failed to allocate memory.
+ * @memberof RevEvalWeights
+ */
+_REV_EXTERN int revTrainEvalWeights(RevEvalWeights *weights, const RevEvalRecord *records,
+                                    size_t count, const RevTrainParams *params);
+
+/**
+ * Number of planes that revExtractFeatures() writes for each board.
+ * They are the disks of the player to move, the disks of the opponent,
+ * empty squares, and legal moves of the player to move.
+ */
+#define REV_FEATURE_PLANES 4
+
+/**
+ * A flag for revExtractFeatures(). It writes `uint8_t` values instead of `float` values.
+ */
+#define REV_FEATURES_UINT8 1
+
+/**
+ * A flag for revExtractFeatures(). It writes the 8 symmetric copies of each board.
+ */
+#define REV_FEATURES_SYMMETRIES 2
+
+/**
+ * Writes boards as dense input tensors for external models.
+ * Each tensor has #REV_FEATURE_PLANES planes of 64 squares,
+ * and a square at (x, y) is `x + y * 8` in its plane. Values are 1 for set squares and 0 for
+ * the others. Tensors are written contiguously, so the buffer is a `[n][4][8][8]` array.
+ *
+ * With #REV_FEATURES_SYMMETRIES, copy j of board i is tensor `i * 8 + j`.
+ * Copy j swaps x and y if bit 2 of j is set, and then mirrors x if bit 0 is set and y if bit 1
+ * is set. Copy 0 is the board itself.
+ *
+ * @note It doesn't allocate memory. Planes are expanded from bitboards 4 squares at a time.
+ *
+ * @param boards An array of boards.
+ * @param count Number of boards.
+ * @param out A buffer of `count * REV_FEATURE_PLANES * 64` values,
+ *            or 8 times as many with #REV_FEATURES_SYMMETRIES.
+ *            Values are `float` unless #REV_FEATURES_UINT8 is set.
+ * @param flags Bitwise OR of #REV_FEATURES_UINT8 and #REV_FEATURES_SYMMETRIES, or zero.
+ * @returns Number of written tensors.
+ * @memberof RevBoard
+ */
+_REV_EXTERN int revExtractFeatures(RevBoard **boards, int count, void *out, int flags);
+
+/**
+ * Search algorithms for revSearch().
+ *
+ * @enum RevSearchType
+ */
+_REV_ENUM(RevSearchType) {
+    SEARCH_MONTE_CARLO = 0,  //!< The Monte Carlo Search. Same as revGenMoveMonteCarlo().
+    SEARCH_ALPHA_BETA,  //!< Alpha-beta search with iterative deepening.
+    SEARCH_MCTS,  //!< Monte Carlo tree search with UCT. Use revSearchMcts() to reuse the tree.
+    SEARCH_WLD,  //!< Endgame solver that only proves a win, a loss, or a draw. See revSolveWLD().
+};
+
+#define REV_WLD_WIN 1  //!< The current player wins with perfect play.
+#define REV_WLD_DRAW 0  //!< The game is a draw with perfect play.
+#define REV_WLD_LOSS -1  //!< The current player loses with perfect play.
+
+#define REV_MAX_PV_LENGTH 64  //!< Max number of moves in RevPvLine::pv.
+#define REV_MAX_MULTI_PV 16  //!< Max number of lines in RevSearchInfo.
+
+/**
+ * A line of play from the current position, which is expected from both players.
+ *
+ * @struct RevPvLine
+ */
+typedef struct RevPvLine {
+    int score;  //!< Score of the line. The unit is the same as RevSearchResult::score.
+    int length;  //!< Number of moves in pv. At least 1.
+    /**
+     * Moves from the current position. pv[0] is the move of the current player.
+     * A pass is -1. Alpha-beta lines come from the transposition table, so they can be
+     * shorter than the depth.
+     */
+    int pv[REV_MAX_PV_LENGTH];
+} RevPvLine;
+
+/**
+ * Progress of a search for RevInfoCallback.
+ *
+ * @struct RevSearchInfo
+ */
+typedef struct RevSearchInfo {
+    /**
+     * Depth of the finished iteration for #SEARCH_ALPHA_BETA.
+     * Length of the first line for #SEARCH_MCTS.
+     */
+    int depth;
+    /**
+     * Nodes visited by the calling thread for #SEARCH_ALPHA_BETA, or nodes in the tree for
+     * #SEARCH_MCTS.
+     */
+    uint64_t nodes;
+    uint64_t playouts;  //!< Playouts of #SEARCH_MCTS so far.
+    /**
+     * Nodes per second for #SEARCH_ALPHA_BETA, or playouts per second for #SEARCH_MCTS.
+     */
+    uint64_t speed;
+    int elapsed_ms;  //!< Elapsed time in milliseconds.
+    int line_count;  //!< Number of lines. Up to `multi_pv` of RevSearchParams.
+    /**
+     * The best lines in order. Alpha-beta scores are exact for all of them.
+     * MCTS lines are sorted by visits.
+     */
+    RevPvLine lines[REV_MAX_MULTI_PV];
+} RevSearchInfo;
+
+/**
+ * Callback for progress of a search. See `info_callback` of RevSearchParams.
+ * It's called on the thread that runs the search.
+ *
+ * @param info Progress of the search.
+ * @param user_data `info_data` of RevSearchParams.
+ */
+typedef void (*RevInfoCallback)(const RevSearchInfo *info, void *user_data);
+
+/**
+ * Parameters for revSearch().
+ * Call revInitSearchParams() to fill it with the default values before editing members.
+ *
+ * @struct RevSearchParams
+ */
+typedef struct RevSearchParams {
+    RevSearchType type;  //!< Search algorithm.
+    int depth;  //!< Max depth for #SEARCH_ALPHA_BETA. Zero means no limit.
+    /**
+     * Max number of playouts for #SEARCH_MONTE_CARLO and #SEARCH_MCTS. Zero means no limit.
+     */
+    int trials;
+    int time_ms;  //!< Time budget in milliseconds. Zero means no limit.
+    /**
+     * Number of threads for #SEARCH_ALPHA_BETA and #SEARCH_MONTE_CARLO.
+     * Zero means all logical processors.
+     * Alpha-beta threads share the transposition table (Lazy SMP).
+     * Monte Carlo threads play blocks of 64 games and add up the results.
+     * #SEARCH_WLD always uses one thread.
+     */
+    int threads;
+    /**
+     * Transposition table. It can be `NULL`.
+     * When it's `NULL` and `threads` is not 1, a temporary table is used during the search.
+     * #SEARCH_WLD always uses a table.
+     */
+    RevHashTable *hash;
+    /**
+     * Selectivity of Multi-ProbCut for #SEARCH_ALPHA_BETA. Zero means a full-width search.
+     * Levels 1 to 5 prune more as they go up. They cut a branch when the shallow search
+     * predicts the result with 99%, 95%, 90%, 80%, or 70% confidence.
+     * Endgame positions that are searched to the end are never pruned by it.
+     */
+    int selectivity;
+    /**
+     * Parameters for Multi-ProbCut. `NULL` means the built-in values.
+     * It should be kept alive until the search finishes.
+     */
+    const RevProbCutParams *probcut;
+    /**
+     * Pattern weights for the static evaluation of #SEARCH_ALPHA_BETA.
+     * `NULL` means the built-in evaluation of square weights and mobility.
+     * It should be kept alive until the search finishes.
+     */
+    const RevEvalWeights *eval;
+    /**
+     * Seed for random playouts. Zero means a seed from the generator of revInitGenRandom().
+     * Each block of #SEARCH_MONTE_CARLO has its own random stream derived from the seed and
+     * the block index. So, the same seed and `trials` give the same move and score
+     * with any number of threads, as long as `time_ms` doesn't stop the search.
+     */
+    uint64_t seed;
+    /**
+     * Called with the progress of #SEARCH_ALPHA_BETA after each iteration of iterative
+     * deepening, and of #SEARCH_MCTS periodically. Other types don't call it.
+     * It can be `NULL`. When it's set and `hash` is `NULL`, #SEARCH_ALPHA_BETA uses a
+     * temporary table to find principal variations.
+     */
+    RevInfoCallback info_callback;
+    void *info_data;  //!< A pointer that will be passed to `info_callback`.
+    /**
+     * Minimum interval of `info_callback` in milliseconds.
+     * Progress within the interval is skipped, except for the last one of the search.
+     * So callbacks don't slow down searches that finish many iterations quickly.
+     */
+    int info_interval_ms;
+    /**
+     * Number of best moves to report to `info_callback`, from 1 to #REV_MAX_MULTI_PV.
+     * #SEARCH_ALPHA_BETA searches the top moves with full windows, which costs more nodes.
+     */
+    int multi_pv;
+} RevSearchParams;
+
+/**
+ * Results of revSearch().
+ *
+ * @struct RevSearchResult
+ */
+typedef struct RevSearchResult {
+    int move;  //!< The best move. -1 when the current player has no legal moves.
+    /**
+     * Score of the best move.
+     * It's an estimated disk difference for #SEARCH_ALPHA_BETA,
+     * and a win rate in percent for #SEARCH_MONTE_CARLO and #SEARCH_MCTS.
+     * #SEARCH_WLD sets #REV_WLD_WIN, #REV_WLD_DRAW, or #REV_WLD_LOSS, even when the current
+     * player has to pass. It's #REV_WLD_DRAW when the search timed out.
+     */
+    int score;
+    int depth;  //!< The deepest depth that was searched completely.
+    /**
+     * Number of nodes visited by #SEARCH_ALPHA_BETA, or number of nodes in the tree
+     * for #SEARCH_MCTS.
+     */
+    uint64_t nodes;
+    uint64_t playouts;  //!< Number of games played to the end by the Monte Carlo Search.
+    int elapsed_ms;  //!< Elapsed time in milliseconds.
+    int timed_out;  //!< `TRUE` if the search was stopped by the time budget.
+} RevSearchResult;
+
+/**
+ * Fills search parameters with the default values.
+ *
+ * @note The default is #SEARCH_ALPHA_BETA with depth 6, 20000 trials, no time limit,
+ *       one thread, no transposition table, no selectivity, the built-in evaluation,
+ *       a random seed, no info callback with an interval of 100 ms, and one line of multi-PV.
+ *
+ * @param params RevSearchParams instance
+ */
+_REV_EXTERN void revInitSearchParams(RevSearchParams *params);
+
+/**
+ * Searches the best move with specified parameters.
+ * When the time budget runs out, it returns the best move found so far.
+ * The clock is checked every 1024 nodes or 64 playouts, so the overrun is small.
+ *
+ * @note #SEARCH_MONTE_CARLO and #SEARCH_MCTS require revInitGenRandom() before calling,
+ *       unless `seed` is set.
+ * @note At least one of `trials` and `time_ms` should be positive for #SEARCH_MONTE_CARLO
+ *       and #SEARCH_MCTS.
+ *
+ * @param board RevBoard instance
+ * @param params Search parameters
+ * @param result A struct to store how much work the search completed. It can be `NULL`.
+ * @returns a position on a bitboard. -1 when the current player has no legal moves.
+ * @memberof RevBoard
+ */
+_REV_EXTERN int revSearch(RevBoard *board, const RevSearchParams *params,
+                          RevSearchResult *result);
+
+/**
+ * Searches the best move with the alpha-beta search.
+ *
+ * @param board RevBoard instance
+ * @param depth Max depth of the search tree. Zero means searching to the end of the game.
+ * @returns a position on a bitboard. -1 when the current player has no legal moves.
+ * @memberof RevBoard
+ */
+_REV_EXTERN int revGenMoveAlphaBeta(RevBoard *board, int depth);
+
+/**
+ * Solves the endgame and tells whether the current player wins, loses, or draws.
+ * It's several times faster than searching the exact score with revGenMoveAlphaBeta().
+ * Use revSearch() with #SEARCH_WLD to get the winning move or to set a time budget.
+ *
+ * @note It searches to the end of the game, so it's only practical for about 24 empties or less.
+ *
+ * @param board RevBoard instance
+ * @returns #REV_WLD_WIN, #REV_WLD_DRAW, or #REV_WLD_LOSS for the current player.
+ * @memberof RevBoard
+ */
+_REV_EXTERN int revSolveWLD(RevBoard *board);
+
+/**
+ * Calls revMoveRandomToEnd() for each legal move until the time budget runs out,
+ * and returns the best move that has the highest win rate.
+ *
+ * @note This method requires revInitGenRandom() before calling.
+ * @note Use revSearch() with #SEARCH_ALPHA_BETA and `time_ms` for the tree search,
+ *       or to get the number of playouts.
+ *
+ * @param board RevBoard instance
+ * @param budget_ms Time budget in milliseconds.
+ * @returns a position on a bitboard. -1 when the current player has no legal moves.
+ * @memberof RevBoard
+ */
+_REV_EXTERN int revGenMoveTimed(RevBoard *board, int budget_ms);
+
+/**
+ * Class for a Monte Carlo search tree that is kept between moves.
+ * Nodes are allocated from one block of memory. When the root moves to a child or
+ * a grandchild, the subtree keeps its statistics and other nodes are freed.
+ *
+ * @struct RevMcts
+ */
+typedef struct RevMcts RevMcts;
+
+/**
+ * Creates a new search tree.
+ *
+ * @param size_mb Memory size in megabytes. The tree stops growing when it's full.
+ * @returns A new tree. `NULL` if it failed to allocate memory.
+ * @memberof RevMcts
+ */
+_REV_EXTERN RevMcts *revNewMcts(int size_mb);
+
+/**
+ * Frees the memory of a search tree.
+ *
+ * @param mcts The tree to free memory
+ * @memberof RevMcts
+ */
+_REV_EXTERN void revFreeMcts(RevMcts *mcts);
+
+/**
+ * Removes all nodes from a search tree.
+ *
+ * @param mcts RevMcts instance
+ * @memberof RevMcts
+ */
+_REV_EXTERN void revClearMcts(RevMcts *mcts);
+
+/**
+ * Searches the best move with the Monte Carlo tree search.
+ * If the board is the root of the tree, or one or two plies below it,
+ * the search continues from the existing statistics. Otherwise the tree is cleared.
+ * So calling it on every turn of a game reuses the work of the previous turn.
+ *
+ * @note This method requires revInitGenRandom() before calling.
+ * @note `type`, `depth`, `threads`, and `hash` of params are ignored.
+ * @note Leaves are evaluated with random playouts unless revSetMctsEvaluator() was called.
+ *
+ * @param mcts RevMcts instance
+ * @param board RevBoard instance
+ * @param params Search parameters. At least one of `trials` and `time_ms` should be positive.
+ * @param result A struct to store how much work the search completed. It can be `NULL`.
+ * @returns a position on a bitboard. -1 when the current player has no legal moves.
+ * @memberof RevMcts
+ */
+_REV_EXTERN int revSearchMcts(RevMcts *mcts, RevBoard *board, const RevSearchParams *params,
+                              RevSearchResult *result);
+
+/**
+ * Moves the root of a search tree to a child, and frees nodes that are no longer reachable.
+ * revSearchMcts() finds the new root by itself, but calling it right after each move
+ * frees memory earlier.
+ *
+ * @param mcts RevMcts instance
+ * @param move The move that was played. -1 for a pass.
+ * @returns `TRUE` if the subtree was kept. `FALSE` if the tree didn't have the move and
+ *          was cleared.
+ * @memberof RevMcts
+ */
+_REV_EXTERN int revMctsAdvance(RevMcts *mcts, int move);
+
+/**
+ * Gets the number of playouts that have passed through the root.
+ * It includes playouts of previous searches that are kept in the tree.
+ *
+ * @param mcts RevMcts instance
+ * @returns Number of visits of the root. Zero for an empty tree.
+ * @memberof RevMcts
+ */
+_REV_EXTERN int revMctsGetRootVisits(RevMcts *mcts);
+
+/**
+ * Enables Rapid Action Value Estimation (RAVE) for revSearchMcts().
+ * Each simulation also updates all-moves-as-first (AMAF) statistics of the moves that
+ * were played later in it, including moves of the random playout. So one playout informs
+ * many nodes. The win rate of a node is blended with its AMAF win rate by
+ * `beta = sqrt(equivalence / (3 * visits + equivalence))`.
+ * The AMAF value guides the search while a node has few visits, and fades out later.
+ *
+ * @note With revSetMctsEvaluator(), only moves in the tree update AMAF statistics.
+ *
+ * @param mcts RevMcts instance
+ * @param equivalence Number of visits at which the win rate and the AMAF win rate
+ *                    have the same weight. Zero disables RAVE. It's disabled by default.
+ *                    Around 300 works well for random playouts.
+ *                    RAVE helps most when there are a few hundred playouts per move.
+ * @memberof RevMcts
+ */
+_REV_EXTERN void revSetMctsRave(RevMcts *mcts, float equivalence);
+
+/**
+ * A position from the player to move.
+ *
+ * @struct RevPosition
+ */
+typedef struct RevPosition {
+    RevBitboard player;  //!< Disks of the player to move.
+    RevBitboard opponent;  //!< Disks of the opponent.
+} RevPosition;
+
+/**
+ * Max number of positions in a batch of RevMctsEvaluator.
+ */
+#define REV_MCTS_MAX_BATCH 1024
+
+/**
+ * Evaluator of leaves for revSetMctsEvaluator().
+ * Positions that are at the end of the game are never passed to it.
+ *
+ * @param positions Positions to evaluate. The player to move may have to pass.
+ * @param count Number of positions.
+ * @param values An array to store values. Each value is the win rate of the player to move,
+ *               from 0 to 1. A draw is 0.5.
+ * @param user_data The pointer that was passed to revSetMctsEvaluator().
+ */
+typedef void (*RevMctsEvaluator)(const RevPosition *positions, int count, float *values,
+                                 void *user_data);
+
+/**
+ * Makes revSearchMcts() evaluate leaves with a callback instead of random playouts.
+ * The search collects leaves from several descents, and passes them to the callback at once.
+ * Paths that are waiting for values count as losses, so descents of a batch
+ * spread to different leaves. Values are backed up after the callback returns.
+ *
+ * @note `trials` of the search parameters counts evaluated leaves.
+ * @note The clock is checked once per batch, so the time budget can be overrun
+ *       by one call of the callback.
+ *
+ * @param mcts RevMcts instance
+ * @param evaluate The evaluator. `NULL` goes back to random playouts.
+ * @param batch_size Max number of positions per call, from 1 to #REV_MCTS_MAX_BATCH.
+ * @param user_data A pointer that will be passed to evaluate.
+ * @returns `TRUE` on success. `FALSE` if it failed to allocate memory.
+ *          The tree uses random playouts then.
+ * @memberof RevMcts
+ */
+_REV_EXTERN int revSetMctsEvaluator(RevMcts *mcts, RevMctsEvaluator evaluate, int batch_size,
+                                    void *user_data);
+
+/**
+ * Callback for each position of revAnalyzeBatch().
+ * It's called on worker threads in the order positions finish, but never at the same time.
+ *
+ * @param index Index of the position in the array.
+ * @param result Results of the search.
+ * @param user_data The pointer that was passed to revAnalyzeBatch().
+ */
+typedef void (*RevBatchCallback)(int index, const RevSearchResult *result, void *user_data);
+
+/**
+ * Searches many positions in parallel and returns when all of them are finished.
+ * Worker threads take the next position as soon as they finish one,
+ * and share one transposition table.
+ *
+ * @note `params->threads` is the number of workers. Each position is searched by one thread.
+ * @note `params->time_ms` is the time budget for each position.
+ * @note When `params->hash` is `NULL`, a temporary table is used for #SEARCH_ALPHA_BETA
+ *       and #SEARCH_WLD.
+ * @note #SEARCH_MONTE_CARLO requires revInitGenRandom() before calling.
+ *
+ * @param boards An array of boards to analyze.
+ * @param count The size of the array.
+ * @param params Search parameters for each position.
+ * @param results An array to store results. Its size should be count. It can be `NULL`.
+ * @param callback A function to receive each result as soon as it's ready. It can be `NULL`.
+ * @param user_data A pointer that will be passed to callback.
+ */
+_REV_EXTERN void revAnalyzeBatch(RevBoard **boards, int count, const RevSearchParams *params,
+                                 RevSearchResult *results, RevBatchCallback callback,
+                                 void *user_data);
+
+/**
+ * Callback for revCountUniquePositions().
+ *
+ * @param ply Number of moves from the initial position.
+ * @param count Number of unique positions at the ply.
+ * @param user_data The pointer in RevEnumParams.
+ */
+typedef void (*RevEnumCallback)(int ply, uint64_t count, void *user_data);
+
+/**
+ * Parameters for revCountUniquePositions().
+ * Call revInitEnumParams() to fill it with the default values before editing members.
+ *
+ * @struct RevEnumParams
+ */
+typedef struct RevEnumParams {
+    int threads;  //!< Number of threads. Zero means all logical processors.
+    /**
+     * Memory budget in MB. Positions take 16 bytes each.
+     * Plies that don't fit are sorted in parts and written to temporary files.
+     */
+    int memory_mb;
+    /**
+     * Directory for temporary files. `NULL` means the system's one (tmpfile()).
+     */
+    const char *temp_dir;
+    /**
+     * File to save the positions of the last ply. It can be `NULL`.
+     * Each position is two 64-bit integers in the native byte order,
+     * the disks of the player to move and the disks of the opponent, sorted in ascending order.
+     */
+    const char *output_path;
+    RevEnumCallback callback;  //!< Called when each ply is counted. It can be `NULL`.
+    void *user_data;  //!< A pointer that will be passed to callback.
+} RevEnumParams;
+
+/**
+ * Fills enumeration parameters with the default values.
+ *
+ * @note The default is all logical processors, 1024 MB, the system's temporary directory,
+ *       no output file, and no callback.
+ *
+ * @param params RevEnumParams instance
+ */
+_REV_EXTERN void revInitEnumParams(RevEnumParams *params);
+
+/**
+ * Counts unique positions that can be reached from the initial position at each ply.
+ * Transpositions and the 8 symmetries of the board are counted once.
+ * Positions are compared from the player to move, so colors don't matter.
+ * When a player has to pass, the position is counted with the other player to move.
+ *
+ * @param depth The last ply to count.
+ * @param params Enumeration parameters.
+ * @param counts An array to store the counts. Its size should be depth + 1.
+ * @returns `TRUE` on success. `FALSE` if it ran out of memory or failed to use files.
+ */
+_REV_EXTERN int revCountUniquePositions(int depth, const RevEnumParams *params,
+                                        uint64_t *counts);
+
+/**
+ * Class for many games in contiguous memory.
+ * Boards are allocated in cache-aligned slabs, and freed slots are reused in constant time.
+ * Games are accessed with handles, so a handle of a freed game never reaches a new game.
+ *
+ * @note Methods of an arena are not thread-safe. But boards of different games can be
+ *       searched in parallel, e.g. with revAnalyzeBatch(), while the arena isn't modified.
+ *
+ * @struct RevGameArena
+ */
+typedef struct RevGameArena RevGameArena;
+
+/**
+ * Handle for a game in RevGameArena.
+ *
+ * @typedef RevGameHandle
+ */
+typedef uint64_t RevGameHandle;
+
+#define REV_NO_GAME 0  //!< Invalid handle
+
+#define REV_ARENA_AI_BLACK 1  //!< Black is played by the AI.
+#define REV_ARENA_AI_WHITE 2  //!< White is played by the AI.
+
+/**
+ * Creates a new arena with no games.
+ *
+ * @returns A new arena. `NULL` if it failed to allocate memory.
+ * @memberof RevGameArena
+ */
+_REV_EXTERN RevGameArena *revNewGameArena(void);
+
+/**
+ * Frees the memory of an arena and all games in it.
+ *
+ * @param arena The arena to free memory
+ * @memberof RevGameArena
+ */
+_REV_EXTERN void revFreeGameArena(RevGameArena *arena);
+
+/**
+ * Adds a game with the initial board.
+ *
+ * @param arena RevGameArena instance
+ * @returns A handle for the new game. #REV_NO_GAME if it failed to allocate memory.
+ * @memberof RevGameArena
+ */
+_REV_EXTERN RevGameHandle revArenaNewGame(RevGameArena *arena);
+
+/**
+ * Removes a game from an arena. The handle and the board of the game become invalid.
+ *
+ * @param arena RevGameArena instance
+ * @param handle Handle for the game. Stale handles are ignored.
+ * @memberof RevGameArena
+ */
+_REV_EXTERN void revArenaFreeGame(RevGameArena *arena, RevGameHandle handle);
+
+/**
+ * Gets the number of games in an arena.
+ *
+ * @param arena RevGameArena instance
+ * @returns Number of games that are not freed.
+ * @memberof RevGameArena
+ */
+_REV_EXTERN int revArenaGetGameCount(RevGameArena *arena);
+
+/**
+ * Gets the board of a game.
+ * The pointer stays valid until the game is freed, even if other games are added.
+ *
+ * @note Changes made directly to the board are not recorded in the history.
+ *
+ * @param arena RevGameArena instance
+ * @param handle Handle for the game.
+ * @returns The board of the game. `NULL` if the handle is stale.
+ * @memberof RevGameArena
+ */
+_REV_EXTERN RevBoard *revArenaGetBoard(RevGameArena *arena, RevGameHandle handle);
+
+/**
+ * Attaches a pointer to a game, e.g. a session of your server.
+ *
+ * @param arena RevGameArena instance
+ * @param handle Handle for the game.
+ * @param user_data Any pointer. The arena doesn't free it.
+ * @memberof RevGameArena
+ */
+_REV_EXTERN void revArenaSetUserData(RevGameArena *arena, RevGameHandle handle,
+                                     void *user_data);
+
+/**
+ * Gets the pointer that was attached with revArenaSetUserData().
+ *
+ * @param arena RevGameArena instance
+ * @param handle Handle for the game.
+ * @returns The attached pointer. `NULL` if the handle is stale or nothing is attached.
+ * @memberof RevGameArena
+ */
+_REV_EXTERN void *revArenaGetUserData(RevGameArena *arena, RevGameHandle handle);
+
+/**
+ * Sets which players of a game are played by the AI.
+ * revArenaNextWaitingGames() returns games where one of them is to move.
+ *
+ * @param arena RevGameArena instance
+ * @param handle Handle for the game.
+ * @param ai_players #REV_ARENA_AI_BLACK, #REV_ARENA_AI_WHITE, both of them, or zero.
+ * @memberof RevGameArena
+ */
+_REV_EXTERN void revArenaSetAIPlayers(RevGameArena *arena, RevGameHandle handle,
+                                      int ai_players);
+
+/**
+ * Plays a move in a game and records it in the history.
+ * When the opponent has no legal moves, the turn comes back and a pass is recorded.
+ *
+ * @param arena RevGameArena instance
+ * @param handle Handle for the game.
+ * @param pos a position on a bitboard. pos = x + y * 8
+ * @returns `TRUE` if the move was played.
+ *          `FALSE` if the move is illegal or the handle is stale.
+ * @memberof RevGameArena
+ */
+_REV_EXTERN int revArenaMove(RevGameArena *arena, RevGameHandle handle, int pos);
+
+/**
+ * Gets moves that have been played in a game with revArenaMove().
+ *
+ * @param arena RevGameArena instance
+ * @param handle Handle for the game.
+ * @param moves An array to store moves from the first one. -1 means a pass.
+ * @param max_moves The size of the array.
+ * @returns Number of moves in the history. It can be larger than max_moves.
+ *          Zero if the handle is stale.
+ * @memberof RevGameArena
+ */
+_REV_EXTERN int revArenaGetHistory(RevGameArena *arena, RevGameHandle handle,
+                                   int *moves, int max_moves);
+
+/**
+ * Gets the next games where the AI is to move, in memory order.
+ * Start with `*cursor == 0` and call it until it returns zero.
+ * The boards can be passed to revAnalyzeBatch() as they are.
+ *
+ * @code
+ * int cursor = 0;
+ * int count;
+ * while ((count = revArenaNextWaitingGames(arena, &cursor, handles, boards, 256)) > 0) {
+ *     revAnalyzeBatch(boards, count, &params, results, NULL, NULL);
+ *     for (int i = 0; i < count; i++)
+ *         revArenaMove(arena, handles[i], results[i].move);
+ * }
+ * @endcode
+ *
+ * @param arena RevGameArena instance
+ * @param cursor Position of the iteration. It's updated by this method.
+ * @param handles An array to store handles. It can be `NULL`.
+ * @param boards An array to store boards. It can be `NULL`.
+ * @param max_games The size of the arrays.
+ * @returns Number of games that were stored. Zero when the iteration is finished.
+ * @memberof RevGameArena
+ */
+_REV_EXTERN int revArenaNextWaitingGames(RevGameArena *arena, int *cursor,
+                                         RevGameHandle *handles, RevBoard **boards,
+                                         int max_games);
+
+/**
+ * Class for an asynchronous search engine.
+ * It owns a background thread that runs searches,
+ * so the caller's thread never blocks on a long search.
+ *
+ * @struct RevEngine
+ */
+typedef struct RevEngine RevEngine;
+
+/**
+ * Callback for a finished search.
+ * It's called on the engine thread.
+ *
+ * @param result Results of the search.
+ * @param user_data The pointer that was passed to revSearchStart().
+ */
+typedef void (*RevSearchCallback)(const RevSearchResult *result, void *user_data);
+
+/**
+ * Creates a new engine and starts its background thread.
+ *
+ * @returns A new engine. `NULL` if it failed to allocate memory or to create a thread.
+ * @memberof RevEngine
+ */
+_REV_EXTERN RevEngine *revNewEngine();
+
+/**
+ * Stops the running search, joins the background thread, and frees the engine.
+ *
+ * @note The callback of the stopped search is not called.
+ *
+ * @param engine The engine to free memory
+ * @memberof RevEngine
+ */
+_REV_EXTERN void revFreeEngine(RevEngine *engine);
+
+/**
+ * Starts a search on the background thread and returns immediately.
+ * When the engine is already searching, the running search is stopped first.
+ * A search that was queued but hasn't started yet is replaced without calling its callback.
+ *
+ * If the engine is pondering the same position, the pondering search turns into
+ * this search and keeps its work. The time budget restarts from this call then,
+ * but other parameters of revPonderStart() are kept.
+ *
+ * @note This method requires revInitGenRandom() before calling.
+ *
+ * @param engine RevEngine instance
+ * @param board The position to search. It's copied, so it can be edited after the call.
+ * @param params Search parameters
+ * @param callback A function called with results when the search finishes. It can be `NULL`.
+ * @param user_data A pointer passed to callback.
+ * @memberof RevEngine
+ */
+_REV_EXTERN void revSearchStart(RevEngine *engine, RevBoard *board, const RevSearchParams *params,
+                                RevSearchCallback callback, void *user_data);
+
+/**
+ * Starts pondering during the opponent's turn.
+ * The engine plays the predicted reply and searches the position after it with no time limit.
+ * Call revSearchStart() with the actual position when the opponent moves.
+ *
+ * @note This method requires revInitGenRandom() before calling.
+ *
+ * @param engine RevEngine instance
+ * @param board The position where the opponent is to move.
+ * @param predicted_move The predicted reply.
+ *                       When it's not a legal move, the engine predicts it with a short search.
+ * @param params Search parameters. `time_ms` is ignored while pondering.
+ * @memberof RevEngine
+ */
+_REV_EXTERN void revPonderStart(RevEngine *engine, RevBoard *board, int predicted_move,
+                                const RevSearchParams *params);
+
+/**
+ * Requests the running search or pondering to stop, and returns immediately.
+ * A stopped search still calls its callback with the best move found so far.
+ *
+ * @param engine RevEngine instance
+ * @memberof RevEngine
+ */
+_REV_EXTERN void revSearchStop(RevEngine *engine);
+
+/**
+ * Waits until the search started by revSearchStart() finishes.
+ * It doesn't wait for pondering.
+ *
+ * @param engine RevEngine instance
+ * @param result A struct to store results of the last search. It can be `NULL`.
+ * @returns The best move of the last search.
+ * @memberof RevEngine
+ */
+_REV_EXTERN int revSearchWait(RevEngine *engine, RevSearchResult *result);
+
+/**
+ * Returns whether or not a search started by revSearchStart() is running.
+ *
+ * @param engine RevEngine instance
+ * @returns `TRUE` if the engine is searching, `FALSE` if it's idle or pondering.
+ * @memberof RevEngine
+ */
+_REV_EXTERN int revIsSearching(RevEngine *engine);
+
+/**
+ * API calls that have latency histograms.
+ *
+ * @enum RevLatencyApi
+ */
+_REV_ENUM(RevLatencyApi) {
+    REV_LATENCY_SEARCH = 0,  //!< revSearch(), #RevEngine from revSearchStart() to the result
+                             //!< (pondering counts from a ponder hit),
+                             //!< and each position of revAnalyzeBatch()
+    REV_LATENCY_SEARCH_MCTS,  //!< revSearchMcts()
+    REV_LATENCY_GEN_MOVE_MONTE_CARLO,  //!< revGenMoveMonteCarlo()
+    REV_LATENCY_ANALYZE_BATCH,  //!< Whole calls of revAnalyzeBatch()
+    REV_LATENCY_ARENA_MOVE,  //!< revArenaMove(), which plays moves of many games
+    REV_LATENCY_API_COUNT,  //!< Number of APIs
+};
+
+/**
+ * Summary of a latency histogram. Values are in nanoseconds.
+ * Percentiles are the largest values of their buckets, which are within 1/32 of each other,
+ * and never more than `max_ns`.
+ *
+ * @struct RevLatencyStats
+ */
+typedef struct RevLatencyStats {
+    uint64_t count;  //!< Number of calls. Zero if the API has not been recorded.
+    uint64_t min_ns;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p90_ns;
+    uint64_t p99_ns;
+    uint64_t p999_ns;
+    uint64_t max_ns;
+} RevLatencyStats;
+
+/**
+ * Starts or stops recording latencies of the calls in #RevLatencyApi.
+ * It's off by default. Each thread records into its own histograms without locks,
+ * and it costs two reads of the clock per call.
+ * When a thread exits, its histograms are kept and reused by the next thread that records.
+ *
+ * @param enabled `TRUE` to record.
+ */
+_REV_EXTERN void revSetLatencyRecording(int enabled);
+
+/**
+ * Clears the histograms of all threads.
+ * Calls that finish while it's running might be kept.
+ */
+_REV_EXTERN void revResetLatencyStats(void);
+
+/**
+ * Takes a snapshot of the histograms of all threads for an API.
+ *
+ * @param api One of #RevLatencyApi.
+ * @param stats A struct to store the summary.
+ */
+_REV_EXTERN void revGetLatencyStats(RevLatencyApi api, RevLatencyStats *stats);
+
+/**
+ * Gets the name of an API in the outputs of revFormatLatencyStats(), such as `"search"`.
+ *
+ * @param api One of #RevLatencyApi.
+ * @returns The name. `NULL` if api is out of range.
+ */
+_REV_EXTERN const char *revGetLatencyApiName(RevLatencyApi api);
+
+#define REV_LATENCY_TEXT 0  //!< Format of revFormatLatencyStats() for humans, in microseconds.
+#define REV_LATENCY_JSON 1  //!< Format of revFormatLatencyStats() for tools, in nanoseconds.
+
+/**
+ * Writes the stats of all APIs as a table or a JSON object.
+ * The table skips APIs that have no calls. The JSON object has all of them.
+ *
+ * @code
+ * {"search":{"count":100,"min_ns":...,"mean_ns":...,"p50_ns":...,"p90_ns":...,
+ *            "p99_ns":...,"p999_ns":...,"max_ns":...},"search_mcts":{...},...}
+ * @endcode
+ *
+ * @param buffer Buffer for the null-terminated text. It can be `NULL` when size is zero.
+ * @param size Size of buffer in bytes. Longer text is truncated.
+ * @param format #REV_LATENCY_TEXT or #REV_LATENCY_JSON.
+ * @returns Length of the whole text without the null terminator, like snprintf().
+ */
+_REV_EXTERN int revFormatLatencyStats(char *buffer, int size, int format);
+
 #ifdef __cplusplus
 }
 #endif
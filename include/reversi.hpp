@@ -0,0 +1,630 @@
+#ifndef __REVERSI_INCLUDE_REVERSI_HPP__
+#define __REVERSI_INCLUDE_REVERSI_HPP__
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include "reversi.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * Header-only C++17 wrapper for reversi-core.
+ *
+ * rev::Board is a trivially copyable value type, and its methods are inlined.
+ * Move generation uses the same algorithms as the C library,
+ * and direction masks are generated at compile time.
+ * Methods that take a side as a template parameter let the compiler constant-fold the color.
+ * rev::BasicBoard<N> is the same for N x N boards, such as rev::Board6 and rev::Board10.
+ *
+ * @code
+ * rev::Board board;
+ * for (int pos : rev::squares(board.mobility<rev::Color::Black>()))
+ *     printf("%d\n", pos);
+ * board.play<rev::Color::Black>(19);
+ * @endcode
+ */
+namespace rev {
+
+using Bitboard = RevBitboard;
+
+/**
+ * Color of a player. The values are the same as #DISK_BLACK and #DISK_WHITE.
+ */
+enum class Color : uint8_t {
+    Black = DISK_BLACK,
+    White = DISK_WHITE,
+};
+
+constexpr Color opponent(Color color) {
+    return (color == Color::Black) ? Color::White : Color::Black;
+}
+
+constexpr int toIndex(Color color) {
+    return static_cast<int>(color);
+}
+
+/**
+ * Counts number of positive bits in a bitboard.
+ */
+inline int countOnes(Bitboard b) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt64(b));
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+/**
+ * Counts leading zeros of a bitboard. Returns 64 when the input is zero.
+ */
+inline int countFirstZeros(Bitboard b) {
+#ifdef _MSC_VER
+    return static_cast<int>(_lzcnt_u64(b));
+#else
+    // __builtin_clzll(b) is undefined when b == 0
+    return static_cast<int>(__builtin_clzll(b) * (b != 0) + 64 * (b == 0));
+#endif
+}
+
+/**
+ * Returns the position of the lowest populated bit. b should not be zero.
+ */
+inline int firstOnePos(Bitboard b) {
+#ifdef _MSC_VER
+    return static_cast<int>(_tzcnt_u64(b));
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+/**
+ * 128-bit bitboard for boards larger than 8x8.
+ * It has only the operators that move generation needs.
+ */
+struct Bits128 {
+    uint64_t lo;
+    uint64_t hi;
+
+    constexpr Bits128(uint64_t low = 0, uint64_t high = 0) : lo(low), hi(high) {}
+
+    friend constexpr Bits128 operator&(Bits128 a, Bits128 b) {
+        return { a.lo & b.lo, a.hi & b.hi };
+    }
+    friend constexpr Bits128 operator|(Bits128 a, Bits128 b) {
+        return { a.lo | b.lo, a.hi | b.hi };
+    }
+    friend constexpr Bits128 operator^(Bits128 a, Bits128 b) {
+        return { a.lo ^ b.lo, a.hi ^ b.hi };
+    }
+    friend constexpr Bits128 operator~(Bits128 a) { return { ~a.lo, ~a.hi }; }
+    friend constexpr Bits128 operator-(Bits128 a, Bits128 b) {
+        return { a.lo - b.lo, a.hi - b.hi - static_cast<uint64_t>(a.lo < b.lo) };
+    }
+    friend constexpr Bits128 operator<<(Bits128 a, int n) {
+        return (n == 0) ? a :
+               (n >= 64) ? Bits128(0, a.lo << (n - 64)) :
+               Bits128(a.lo << n, (a.hi << n) | (a.lo >> (64 - n)));
+    }
+    friend constexpr Bits128 operator>>(Bits128 a, int n) {
+        return (n == 0) ? a :
+               (n >= 64) ? Bits128(a.hi >> (n - 64), 0) :
+               Bits128((a.lo >> n) | (a.hi << (64 - n)), a.hi >> n);
+    }
+    Bits128 &operator&=(Bits128 b) { return *this = *this & b; }
+    Bits128 &operator|=(Bits128 b) { return *this = *this | b; }
+    Bits128 &operator^=(Bits128 b) { return *this = *this ^ b; }
+    friend constexpr bool operator==(Bits128 a, Bits128 b) {
+        return a.lo == b.lo && a.hi == b.hi;
+    }
+    friend constexpr bool operator!=(Bits128 a, Bits128 b) { return !(a == b); }
+};
+
+inline int countOnes(Bits128 b) {
+    return countOnes(b.lo) + countOnes(b.hi);
+}
+
+/**
+ * Returns the position of the lowest populated bit. b should not be zero.
+ */
+inline int firstOnePos(Bits128 b) {
+    return (b.lo != 0) ? firstOnePos(b.lo) : 64 + firstOnePos(b.hi);
+}
+
+/**
+ * Range of positions of populated bits, from the lowest to the highest.
+ *
+ * @code
+ * for (int pos : rev::squares(b)) { ... }
+ * @endcode
+ */
+template <class Bits>
+class BasicSquares {
+ public:
+    class Iterator {
+     public:
+        constexpr explicit Iterator(Bits b) : b_(b) {}
+        int operator*() const { return firstOnePos(b_); }
+        Iterator &operator++() {
+            b_ &= b_ - Bits(1);
+            return *this;
+        }
+        constexpr bool operator!=(const Iterator &other) const { return b_ != other.b_; }
+        constexpr bool operator==(const Iterator &other) const { return b_ == other.b_; }
+
+     private:
+        Bits b_;
+    };
+
+    constexpr explicit BasicSquares(Bits b) : b_(b) {}
+    constexpr Iterator begin() const { return Iterator(b_); }
+    constexpr Iterator end() const { return Iterator(Bits(0)); }
+
+ private:
+    Bits b_;
+};
+
+using Squares = BasicSquares<Bitboard>;
+
+constexpr Squares squares(Bitboard b) {
+    return Squares(b);
+}
+
+constexpr BasicSquares<Bits128> squares(Bits128 b) {
+    return BasicSquares<Bits128>(b);
+}
+
+namespace detail {
+
+// Bits of a column. x is 0 for the left edge.
+constexpr Bitboard makeColumnMask(int x) {
+    Bitboard mask = 0;
+    for (int y = 0; y < 8; y++)
+        mask |= Bitboard(1) << (x + y * 8);
+    return mask;
+}
+
+// Ray to higher bits. Shifting it left by pos gives pos + step, pos + step * 2, ...
+constexpr Bitboard makeRayUp(int step) {
+    Bitboard mask = 0;
+    for (int i = 1; i < 8 && i * step < 64; i++)
+        mask |= Bitboard(1) << (i * step);
+    return mask;
+}
+
+// Ray to lower bits. Shifting it right by 63 - pos gives pos - step, pos - step * 2, ...
+constexpr Bitboard makeRayDown(int step) {
+    Bitboard mask = 0;
+    for (int i = 1; i < 8 && i * step < 64; i++)
+        mask |= Bitboard(1) << (63 - i * step);
+    return mask;
+}
+
+}  // namespace detail
+
+/**
+ * Squares that are not on the left or right edge.
+ */
+constexpr Bitboard INNER_COLUMNS = ~(detail::makeColumnMask(0) | detail::makeColumnMask(7));
+
+/**
+ * A line direction on a bitboard.
+ * Rays except vertical ones wrap around to the next row,
+ * so the opponent's disks are masked with #INNER_COLUMNS for them.
+ */
+struct Direction {
+    int step;  // Distance between adjacent squares on a bitboard
+    Bitboard ray_down;
+    Bitboard ray_up;
+};
+
+constexpr Direction makeDirection(int step) {
+    return Direction{ step, detail::makeRayDown(step), detail::makeRayUp(step) };
+}
+
+/**
+ * Vertical, horizontal, and diagonal directions.
+ */
+constexpr std::array<Direction, 4> DIRECTIONS = {
+    makeDirection(8), makeDirection(1), makeDirection(7), makeDirection(9),
+};
+
+static_assert(INNER_COLUMNS == 0x7e7e7e7e7e7e7e7e, "INNER_COLUMNS is broken.");
+static_assert(DIRECTIONS[0].ray_down == 0x0080808080808080 &&
+              DIRECTIONS[0].ray_up == 0x0101010101010100, "Vertical masks are broken.");
+static_assert(DIRECTIONS[1].ray_down == 0x7f00000000000000 &&
+              DIRECTIONS[1].ray_up == 0x00000000000000fe, "Horizontal masks are broken.");
+static_assert(DIRECTIONS[2].ray_down == 0x0102040810204000 &&
+              DIRECTIONS[2].ray_up == 0x0002040810204080, "Diagonal masks are broken.");
+static_assert(DIRECTIONS[3].ray_down == 0x0040201008040201 &&
+              DIRECTIONS[3].ray_up == 0x8040201008040200, "Diagonal masks are broken.");
+
+namespace detail {
+
+// o_board should be masked with #INNER_COLUMNS unless the direction is vertical.
+template <int Dir>
+inline Bitboard mobilityOneDirection(Bitboard p_board, Bitboard masked_o) {
+    constexpr int shift = DIRECTIONS[Dir].step;
+    constexpr int shift_double = shift * 2;
+
+    Bitboard flip = masked_o & (p_board << shift);
+    flip |= masked_o & (flip << shift);
+    Bitboard pre = masked_o & (masked_o << shift);
+    flip |= pre & (flip << shift_double);
+    flip |= pre & (flip << shift_double);
+    Bitboard mobility = flip << shift;
+    flip = masked_o & (p_board >> shift);
+    flip |= masked_o & (flip >> shift);
+    pre = masked_o & (masked_o >> shift);
+    flip |= pre & (flip >> shift_double);
+    flip |= pre & (flip >> shift_double);
+    mobility |= flip >> shift;
+    return mobility;
+}
+
+template <int Dir>
+inline Bitboard flippedOneDirection(int pos, Bitboard p_board, Bitboard masked_o) {
+    constexpr Direction dir = DIRECTIONS[Dir];
+    Bitboard mask = dir.ray_down >> (63 - pos);
+    Bitboard outflank = (0x8000000000000000 >> countFirstZeros(~masked_o & mask)) & p_board;
+    Bitboard flipped = (-outflank * 2) & mask;
+
+    mask = dir.ray_up << pos;
+    outflank = mask & ((masked_o | ~mask) + 1) & p_board;
+    flipped |= (outflank - static_cast<Bitboard>(outflank != 0)) & mask;
+    return flipped;
+}
+
+}  // namespace detail
+
+/**
+ * Calculates legal moves for a player p_board against an opponent o_board.
+ */
+inline Bitboard mobility(Bitboard p_board, Bitboard o_board) {
+    const Bitboard masked_o = o_board & INNER_COLUMNS;
+    Bitboard moves = detail::mobilityOneDirection<1>(p_board, masked_o);
+    moves |= detail::mobilityOneDirection<0>(p_board, o_board);
+    moves |= detail::mobilityOneDirection<2>(p_board, masked_o);
+    moves |= detail::mobilityOneDirection<3>(p_board, masked_o);
+    return moves & ~(p_board | o_board);
+}
+
+/**
+ * Calculates disks that will be flipped when p_board puts a disk at pos.
+ */
+inline Bitboard flipped(Bitboard p_board, Bitboard o_board, int pos) {
+    const Bitboard masked_o = o_board & INNER_COLUMNS;
+    Bitboard disks = detail::flippedOneDirection<0>(pos, p_board, o_board);
+    disks |= detail::flippedOneDirection<1>(pos, p_board, masked_o);
+    disks |= detail::flippedOneDirection<2>(pos, p_board, masked_o);
+    disks |= detail::flippedOneDirection<3>(pos, p_board, masked_o);
+    return disks;
+}
+
+/**
+ * Reversi board as a value type.
+ * Unlike RevBoard, it doesn't cache legal moves. Call mobility() when you need them.
+ */
+class Board {
+ public:
+    /**
+     * Makes the initial board.
+     */
+    constexpr Board() : disks_{ 0x0000000810000000, 0x0000001008000000 }, player_(Color::Black) {}
+
+    constexpr Board(Bitboard black, Bitboard white, Color player)
+        : disks_{ black, white }, player_(player) {}
+
+    /**
+     * Copies disks and the turn from a RevBoard instance.
+     */
+    static Board fromC(RevBoard *board) {
+        return Board(revGetBitboard(board, DISK_BLACK), revGetBitboard(board, DISK_WHITE),
+                     static_cast<Color>(revGetCurrentPlayer(board)));
+    }
+
+    /**
+     * Copies disks and the turn to a RevBoard instance. Legal moves of it are updated.
+     */
+    void toC(RevBoard *board) const {
+        revSetBitboard(board, DISK_BLACK, disks_[toIndex(Color::Black)]);
+        revSetBitboard(board, DISK_WHITE, disks_[toIndex(Color::White)]);
+        if (revGetCurrentPlayer(board) != static_cast<RevDiskType>(player_))
+            revChangePlayer(board);
+        else
+            revUpdateMobility(board);
+    }
+
+    constexpr Color player() const { return player_; }
+
+    constexpr Bitboard disks(Color color) const { return disks_[toIndex(color)]; }
+
+    template <Color Side>
+    constexpr Bitboard disks() const { return disks_[toIndex(Side)]; }
+
+    constexpr Bitboard empties() const { return ~(disks_[0] | disks_[1]); }
+
+    /**
+     * Legal moves for the player to move.
+     */
+    Bitboard mobility() const {
+        const int p = toIndex(player_);
+        return rev::mobility(disks_[p], disks_[p ^ 1]);
+    }
+
+    /**
+     * Legal moves for Side. It doesn't have to be the player to move.
+     */
+    template <Color Side>
+    Bitboard mobility() const {
+        return rev::mobility(disks_[toIndex(Side)], disks_[toIndex(opponent(Side))]);
+    }
+
+    /**
+     * Puts a disk of the player to move at pos, and passes the turn to the opponent.
+     * pos should be a legal move.
+     *
+     * @returns Flipped disks.
+     */
+    Bitboard play(int pos) {
+        return (player_ == Color::Black) ? play<Color::Black>(pos) : play<Color::White>(pos);
+    }
+
+    /**
+     * Same as play(int) but the player to move has to be Side.
+     */
+    template <Color Side>
+    Bitboard play(int pos) {
+        constexpr int p = toIndex(Side);
+        constexpr int o = toIndex(opponent(Side));
+        const Bitboard flip = rev::flipped(disks_[p], disks_[o], pos);
+        disks_[p] ^= flip | (Bitboard(1) << pos);
+        disks_[o] ^= flip;
+        player_ = opponent(Side);
+        return flip;
+    }
+
+    /**
+     * Passes the turn to the opponent.
+     */
+    void pass() { player_ = opponent(player_); }
+
+    constexpr bool operator==(const Board &other) const {
+        return disks_[0] == other.disks_[0] && disks_[1] == other.disks_[1] &&
+               player_ == other.player_;
+    }
+
+    constexpr bool operator!=(const Board &other) const { return !(*this == other); }
+
+ private:
+    Bitboard disks_[2];
+    Color player_;
+};
+
+static_assert(std::is_trivially_copyable<Board>::value, "Board should be trivially copyable.");
+static_assert(sizeof(Board) <= 24, "Board should be as small as RevBoard.");
+
+/**
+ * Geometry of an N x N board. Square (x, y) is bit x + y * N.
+ * Boards up to 8x8 fit in a 64-bit integer, and larger ones use Bits128.
+ */
+template <int N>
+struct Geometry {
+    static_assert(N >= 4 && N <= 10 && N % 2 == 0, "The size should be 4, 6, 8, or 10.");
+
+    using Bits = typename std::conditional<(N * N <= 64), Bitboard, Bits128>::type;
+
+    static constexpr int SIZE = N;
+    static constexpr int SQUARES = N * N;
+
+    static constexpr Bits bit(int x, int y) { return Bits(1) << (x + y * N); }
+
+    static constexpr Bits makeColumn(int x) {
+        Bits mask = 0;
+        for (int y = 0; y < N; y++)
+            mask = mask | bit(x, y);
+        return mask;
+    }
+
+    static constexpr Bits makeAll() {
+        Bits mask = 0;
+        for (int x = 0; x < N; x++)
+            mask = mask | makeColumn(x);
+        return mask;
+    }
+
+    static constexpr Bits ALL = makeAll();
+    static constexpr Bits INNER_COLUMNS = ALL & ~(makeColumn(0) | makeColumn(N - 1));
+    static constexpr Bits INITIAL_BLACK = bit(N / 2, N / 2 - 1) | bit(N / 2 - 1, N / 2);
+    static constexpr Bits INITIAL_WHITE = bit(N / 2 - 1, N / 2 - 1) | bit(N / 2, N / 2);
+
+    // Same order as DIRECTIONS
+    static constexpr int STEPS[4] = { N, 1, N - 1, N + 1 };
+};
+
+static_assert(Geometry<8>::ALL == ~Bitboard(0) && Geometry<8>::INNER_COLUMNS == INNER_COLUMNS,
+              "Geometry<8> is broken.");
+static_assert(Geometry<8>::INITIAL_BLACK == 0x0000000810000000 &&
+              Geometry<8>::INITIAL_WHITE == 0x0000001008000000, "Geometry<8> is broken.");
+
+/**
+ * Move generation for any board size with shifts only.
+ * A line has N - 2 opponent's disks at most, so fills are unrolled N - 3 times.
+ * BasicBoard<8> doesn't use it, and calls rev::mobility() and rev::flipped() instead.
+ */
+template <int N>
+struct Kernels {
+    using G = Geometry<N>;
+    using Bits = typename G::Bits;
+
+    // o_board should be masked with INNER_COLUMNS unless the direction is vertical.
+    template <int Dir>
+    static Bits mobilityOneDirection(Bits p_board, Bits masked_o) {
+        constexpr int shift = G::STEPS[Dir];
+        Bits flip = masked_o & (p_board << shift);
+        for (int i = 0; i < N - 3; i++)
+            flip |= masked_o & (flip << shift);
+        Bits mobility = flip << shift;
+        flip = masked_o & (p_board >> shift);
+        for (int i = 0; i < N - 3; i++)
+            flip |= masked_o & (flip >> shift);
+        return mobility | (flip >> shift);
+    }
+
+    template <int Dir>
+    static Bits flippedOneDirection(Bits move, Bits p_board, Bits masked_o) {
+        constexpr int shift = G::STEPS[Dir];
+        Bits flipped = 0;
+        Bits flip = masked_o & (move << shift);
+        for (int i = 0; i < N - 3; i++)
+            flip |= masked_o & (flip << shift);
+        if (((flip << shift) & p_board) != Bits(0)) flipped = flip;
+        flip = masked_o & (move >> shift);
+        for (int i = 0; i < N - 3; i++)
+            flip |= masked_o & (flip >> shift);
+        if (((flip >> shift) & p_board) != Bits(0)) flipped |= flip;
+        return flipped;
+    }
+
+    static Bits mobility(Bits p_board, Bits o_board) {
+        const Bits masked_o = o_board & G::INNER_COLUMNS;
+        Bits moves = mobilityOneDirection<1>(p_board, masked_o);
+        moves |= mobilityOneDirection<0>(p_board, o_board);
+        moves |= mobilityOneDirection<2>(p_board, masked_o);
+        moves |= mobilityOneDirection<3>(p_board, masked_o);
+        return moves & ~(p_board | o_board) & G::ALL;
+    }
+
+    static Bits flipped(Bits p_board, Bits o_board, int pos) {
+        const Bits move = Bits(1) << pos;
+        const Bits masked_o = o_board & G::INNER_COLUMNS;
+        Bits disks = flippedOneDirection<0>(move, p_board, o_board);
+        disks |= flippedOneDirection<1>(move, p_board, masked_o);
+        disks |= flippedOneDirection<2>(move, p_board, masked_o);
+        disks |= flippedOneDirection<3>(move, p_board, masked_o);
+        return disks;
+    }
+};
+
+/**
+ * N x N board as a value type. The size is a compile-time parameter,
+ * so each size gets its own move generation. 8x8 uses the same kernels as rev::Board.
+ *
+ * @code
+ * rev::Board6 board;
+ * for (int pos : rev::squares(board.mobility()))
+ *     printf("(%d, %d)\n", pos % 6, pos / 6);
+ * @endcode
+ */
+template <int N>
+class BasicBoard {
+ public:
+    using Geometry = rev::Geometry<N>;
+    using Bits = typename Geometry::Bits;
+
+    static constexpr int toPos(int x, int y) { return x + y * N; }
+
+    /**
+     * Legal moves for a player p_board against an opponent o_board.
+     */
+    static Bits mobility(Bits p_board, Bits o_board) {
+        if constexpr (N == 8)
+            return rev::mobility(p_board, o_board);
+        else
+            return Kernels<N>::mobility(p_board, o_board);
+    }
+
+    /**
+     * Disks that will be flipped when p_board puts a disk at pos.
+     */
+    static Bits flipped(Bits p_board, Bits o_board, int pos) {
+        if constexpr (N == 8)
+            return rev::flipped(p_board, o_board, pos);
+        else
+            return Kernels<N>::flipped(p_board, o_board, pos);
+    }
+
+    /**
+     * Makes the initial board.
+     */
+    constexpr BasicBoard()
+        : disks_{ Geometry::INITIAL_BLACK, Geometry::INITIAL_WHITE }, player_(Color::Black) {}
+
+    constexpr BasicBoard(Bits black, Bits white, Color player)
+        : disks_{ black, white }, player_(player) {}
+
+    constexpr Color player() const { return player_; }
+
+    constexpr Bits disks(Color color) const { return disks_[toIndex(color)]; }
+
+    template <Color Side>
+    constexpr Bits disks() const { return disks_[toIndex(Side)]; }
+
+    constexpr Bits empties() const { return Geometry::ALL & ~(disks_[0] | disks_[1]); }
+
+    /**
+     * Legal moves for the player to move.
+     */
+    Bits mobility() const {
+        const int p = toIndex(player_);
+        return mobility(disks_[p], disks_[p ^ 1]);
+    }
+
+    /**
+     * Legal moves for Side. It doesn't have to be the player to move.
+     */
+    template <Color Side>
+    Bits mobility() const {
+        return mobility(disks_[toIndex(Side)], disks_[toIndex(opponent(Side))]);
+    }
+
+    /**
+     * Puts a disk of the player to move at pos, and passes the turn to the opponent.
+     * pos should be a legal move.
+     *
+     * @returns Flipped disks.
+     */
+    Bits play(int pos) {
+        return (player_ == Color::Black) ? play<Color::Black>(pos) : play<Color::White>(pos);
+    }
+
+    /**
+     * Same as play(int) but the player to move has to be Side.
+     */
+    template <Color Side>
+    Bits play(int pos) {
+        constexpr int p = toIndex(Side);
+        constexpr int o = toIndex(opponent(Side));
+        const Bits flip = flipped(disks_[p], disks_[o], pos);
+        disks_[p] ^= flip | (Bits(1) << pos);
+        disks_[o] ^= flip;
+        player_ = opponent(Side);
+        return flip;
+    }
+
+    /**
+     * Passes the turn to the opponent.
+     */
+    void pass() { player_ = opponent(player_); }
+
+    constexpr bool operator==(const BasicBoard &other) const {
+        return disks_[0] == other.disks_[0] && disks_[1] == other.disks_[1] &&
+               player_ == other.player_;
+    }
+
+    constexpr bool operator!=(const BasicBoard &other) const { return !(*this == other); }
+
+ private:
+    Bits disks_[2];
+    Color player_;
+};
+
+using Board6 = BasicBoard<6>;
+using Board10 = BasicBoard<10>;
+
+static_assert(std::is_trivially_copyable<Board10>::value, "Board10 should be trivially copyable.");
+
+}  // namespace rev
+
+#endif  // __REVERSI_INCLUDE_REVERSI_HPP__
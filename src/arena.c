@@ -0,0 +1,232 @@
+#include <string.h>
+#include "reversi.h"
+#include "internal.h"
+#include "latency.h"
+
+// Games are allocated in slabs of ARENA_SLAB_GAMES.
+// Slabs never move, so pointers to boards stay valid until their games are freed.
+#define ARENA_SLAB_GAMES 1024
+
+// A game has 60 moves and passes between them at most.
+#define ARENA_MAX_HISTORY 128
+
+#define ARENA_NO_SLOT 0xffffffff
+
+// Fields that are read by sweeps. Each game fills one cache line.
+typedef struct ArenaGame {
+    RevBoard board;
+    void *user_data;
+    uint32_t generation;  // Incremented when the game is freed, so old handles become stale.
+    uint32_t next_free;  // Next slot in the free list. Only for freed games.
+    uint8_t live;
+    uint8_t ai_players;  // REV_ARENA_AI_BLACK | REV_ARENA_AI_WHITE
+    uint8_t history_length;
+    uint8_t padding[64 - sizeof(RevBoard) - sizeof(void *) - 11];
+} ArenaGame;
+
+typedef struct ArenaSlab {
+    ArenaGame *games;  // Aligned to a cache line
+    int8_t (*history)[ARENA_MAX_HISTORY];  // Cold data is kept apart from games.
+    void *memory;  // Unaligned pointer for free()
+} ArenaSlab;
+
+struct RevGameArena {
+    ArenaSlab *slabs;
+    uint32_t slab_count;
+    uint32_t slab_capacity;
+    uint32_t free_head;  // First slot of the free list
+    int game_count;
+};
+
+static inline uint32_t slotOfHandle(RevGameHandle handle) {
+    return (uint32_t)handle;
+}
+
+static inline uint32_t generationOfHandle(RevGameHandle handle) {
+    return (uint32_t)(handle >> 32);
+}
+
+static inline ArenaGame *getGame(const RevGameArena *arena, uint32_t slot) {
+    return &arena->slabs[slot / ARENA_SLAB_GAMES].games[slot % ARENA_SLAB_GAMES];
+}
+
+static inline int8_t *getHistory(const RevGameArena *arena, uint32_t slot) {
+    return arena->slabs[slot / ARENA_SLAB_GAMES].history[slot % ARENA_SLAB_GAMES];
+}
+
+// Returns NULL if the handle is stale.
+static ArenaGame *findGame(const RevGameArena *arena, RevGameHandle handle) {
+    const uint32_t slot = slotOfHandle(handle);
+    if (slot >= arena->slab_count * ARENA_SLAB_GAMES) return NULL;
+    ArenaGame *game = getGame(arena, slot);
+    if (!game->live || game->generation != generationOfHandle(handle)) return NULL;
+    return game;
+}
+
+RevGameArena *revNewGameArena(void) {
+    RevGameArena *arena = (RevGameArena *)malloc(sizeof(RevGameArena));
+    if (arena == NULL) return NULL;
+    arena->slabs = NULL;
+    arena->slab_count = 0;
+    arena->slab_capacity = 0;
+    arena->free_head = ARENA_NO_SLOT;
+    arena->game_count = 0;
+    return arena;
+}
+
+void revFreeGameArena(RevGameArena *arena) {
+    for (uint32_t i = 0; i < arena->slab_count; i++)
+        free(arena->slabs[i].memory);
+    free(arena->slabs);
+    free(arena);
+}
+
+// Adds a slab and pushes its slots to the free list. Returns FALSE when out of memory.
+static int addSlab(RevGameArena *arena) {
+    if (arena->slab_count >= ARENA_NO_SLOT / ARENA_SLAB_GAMES) return 0;
+    if (arena->slab_count == arena->slab_capacity) {
+        const uint32_t capacity = (arena->slab_capacity > 0) ? arena->slab_capacity * 2 : 4;
+        ArenaSlab *slabs = (ArenaSlab *)realloc(arena->slabs, sizeof(ArenaSlab) * capacity);
+        if (slabs == NULL) return 0;
+        arena->slabs = slabs;
+        arena->slab_capacity = capacity;
+    }
+
+    const size_t games_bytes = sizeof(ArenaGame) * ARENA_SLAB_GAMES;
+    ArenaSlab *slab = &arena->slabs[arena->slab_count];
+    slab->memory = malloc(games_bytes + sizeof(int8_t) * ARENA_MAX_HISTORY * ARENA_SLAB_GAMES + 63);
+    if (slab->memory == NULL) return 0;
+    slab->games = (ArenaGame *)(((uintptr_t)slab->memory + 63) & ~(uintptr_t)63);
+    slab->history = (int8_t (*)[ARENA_MAX_HISTORY])((char *)slab->games + games_bytes);
+
+    // Lower slots are used first, so live games stay packed at the start of the arena.
+    const uint32_t first = arena->slab_count * ARENA_SLAB_GAMES;
+    for (uint32_t i = 0; i < ARENA_SLAB_GAMES; i++) {
+        ArenaGame *game = &slab->games[i];
+        memset(game, 0, sizeof(ArenaGame));
+        game->generation = 1;
+        game->next_free = (i + 1 < ARENA_SLAB_GAMES) ? first + i + 1 : arena->free_head;
+    }
+    arena->free_head = first;
+    arena->slab_count++;
+    return 1;
+}
+
+RevGameHandle revArenaNewGame(RevGameArena *arena) {
+    if (arena->free_head == ARENA_NO_SLOT && !addSlab(arena))
+        return REV_NO_GAME;
+    const uint32_t slot = arena->free_head;
+    ArenaGame *game = getGame(arena, slot);
+    arena->free_head = game->next_free;
+
+    revInitBoard(&game->board);
+    game->user_data = NULL;
+    game->live = 1;
+    game->ai_players = 0;
+    game->history_length = 0;
+    arena->game_count++;
+    return ((RevGameHandle)game->generation << 32) | slot;
+}
+
+void revArenaFreeGame(RevGameArena *arena, RevGameHandle handle) {
+    ArenaGame *game = findGame(arena, handle);
+    if (game == NULL) return;
+    game->live = 0;
+    // Generation 0 is skipped so a handle is never REV_NO_GAME.
+    game->generation = (game->generation + 1 != 0) ? game->generation + 1 : 1;
+    game->next_free = arena->free_head;
+    arena->free_head = slotOfHandle(handle);
+    arena->game_count--;
+}
+
+int revArenaGetGameCount(RevGameArena *arena) {
+    return arena->game_count;
+}
+
+RevBoard *revArenaGetBoard(RevGameArena *arena, RevGameHandle handle) {
+    ArenaGame *game = findGame(arena, handle);
+    return (game != NULL) ? &game->board : NULL;
+}
+
+void revArenaSetUserData(RevGameArena *arena, RevGameHandle handle, void *user_data) {
+    ArenaGame *game = findGame(arena, handle);
+    if (game != NULL) game->user_data = user_data;
+}
+
+void *revArenaGetUserData(RevGameArena *arena, RevGameHandle handle) {
+    ArenaGame *game = findGame(arena, handle);
+    return (game != NULL) ? game->user_data : NULL;
+}
+
+void revArenaSetAIPlayers(RevGameArena *arena, RevGameHandle handle, int ai_players) {
+    ArenaGame *game = findGame(arena, handle);
+    if (game != NULL)
+        game->ai_players = (uint8_t)(ai_players & (REV_ARENA_AI_BLACK | REV_ARENA_AI_WHITE));
+}
+
+// Same as revChangePlayer() but inlined for sweeps over many games.
+static inline void changePlayer(RevBoard *board) {
+    board->current_player = !board->current_player;
+    board->mobility = calcMobility(board->bitboards[board->current_player],
+                                   board->bitboards[!board->current_player]);
+    board->mobility_count = countOnes(board->mobility);
+}
+
+static int playMove(RevGameArena *arena, RevGameHandle handle, int pos) {
+    ArenaGame *game = findGame(arena, handle);
+    if (game == NULL || pos < 0 || pos >= 64 || !((game->board.mobility >> pos) & 1))
+        return 0;
+    int8_t *history = getHistory(arena, slotOfHandle(handle));
+    RevBoard *board = &game->board;
+    const RevDiskType player = board->current_player;
+    const RevBitboard flipped = calcFlipped(board->bitboards[player], board->bitboards[!player],
+                                            pos);
+    board->bitboards[player] ^= flipped | ((RevBitboard)1 << pos);
+    board->bitboards[!player] ^= flipped;
+    changePlayer(board);
+    history[game->history_length++] = (int8_t)pos;
+    if (board->mobility_count == 0) {
+        // The opponent has to pass. If neither player can move, the game is over.
+        changePlayer(board);
+        if (board->mobility_count > 0)
+            history[game->history_length++] = -1;
+    }
+    return 1;
+}
+
+int revArenaMove(RevGameArena *arena, RevGameHandle handle, int pos) {
+    const uint64_t latency_start = latencyStart();
+    const int ok = playMove(arena, handle, pos);
+    latencyEnd(REV_LATENCY_ARENA_MOVE, latency_start);
+    return ok;
+}
+
+int revArenaGetHistory(RevGameArena *arena, RevGameHandle handle, int *moves, int max_moves) {
+    ArenaGame *game = findGame(arena, handle);
+    if (game == NULL) return 0;
+    const int8_t *history = getHistory(arena, slotOfHandle(handle));
+    const int count = (game->history_length < max_moves) ? game->history_length : max_moves;
+    for (int i = 0; i < count; i++)
+        moves[i] = history[i];
+    return game->history_length;
+}
+
+int revArenaNextWaitingGames(RevGameArena *arena, int *cursor, RevGameHandle *handles,
+                             RevBoard **boards, int max_games) {
+    const uint32_t end = arena->slab_count * ARENA_SLAB_GAMES;
+    uint32_t slot = (*cursor > 0) ? (uint32_t)*cursor : 0;
+    int count = 0;
+    for (; slot < end && count < max_games; slot++) {
+        ArenaGame *game = getGame(arena, slot);
+        if (!game->live || game->board.mobility_count == 0 ||
+            !((game->ai_players >> game->board.current_player) & 1))
+            continue;
+        if (handles != NULL)
+            handles[count] = ((RevGameHandle)game->generation << 32) | slot;
+        if (boards != NULL)
+            boards[count] = &game->board;
+        count++;
+    }
+    *cursor = (int)slot;
+    return count;
+}
@@ -0,0 +1,99 @@
+#include "reversi.h"
+#include "internal.h"
+#include "search.h"
+#include "hash.h"
+#include "latency.h"
+#include "rng.h"
+#include "thread.h"
+
+typedef struct Batch {
+    RevBoard **boards;
+    int count;
+    const RevSearchParams *params;  // Parameters for each position. threads is 1.
+    RevHashTable *hash;  // Shared by all workers. Can be NULL.
+    RevSearchResult *results;  // Can be NULL.
+    RevBatchCallback callback;  // Can be NULL.
+    void *user_data;
+    uint64_t seed;
+    int next;  // Index of the next position to analyze. Accessed with atomics.
+    Mutex lock;  // Callbacks are called one at a time.
+} Batch;
+
+// Workers take positions one by one, so fast ones don't wait for slow ones.
+static void analyzePositions(Batch *batch) {
+    for (;;) {
+        const int i = atomicFetchAddInt(&batch->next, 1);
+        if (i >= batch->count) break;
+
+        // Seeds depend only on the index, not on the worker that takes it.
+        uint64_t state = batch->seed + (uint64_t)i;
+        SearchControl control;
+        RevSearchResult result;
+        const uint64_t latency_start = latencyStart();
+        initSearchControl(&control, batch->params->time_ms);
+        searchWithHash(batch->boards[i], batch->params, batch->hash, &control,
+                       splitMix64(&state), &result);
+        latencyEnd(REV_LATENCY_SEARCH, latency_start);
+
+        if (batch->results != NULL)
+            batch->results[i] = result;
+        if (batch->callback != NULL) {
+            mutexLock(&batch->lock);
+            batch->callback(i, &result, batch->user_data);
+            mutexUnlock(&batch->lock);
+        }
+    }
+}
+
+static void batchThread(void *arg) {
+    analyzePositions((Batch *)arg);
+}
+
+void revAnalyzeBatch(RevBoard **boards, int count, const RevSearchParams *params,
+                     RevSearchResult *results, RevBatchCallback callback, void *user_data) {
+    if (count <= 0) return;
+    const uint64_t latency_start = latencyStart();
+    int threads = (params->threads > 0) ? params->threads : getCpuCount();
+    if (threads > count) threads = count;
+
+    // Parallelism comes from positions. Each position is searched by one thread.
+    RevSearchParams position_params = *params;
+    position_params.threads = 1;
+
+    Batch batch;
+    batch.boards = boards;
+    batch.count = count;
+    batch.params = &position_params;
+    batch.hash = params->hash;
+    if (batch.hash == NULL &&
+        (params->type == SEARCH_ALPHA_BETA || params->type == SEARCH_WLD))
+        batch.hash = revNewHashTable(DEFAULT_HASH_MB);
+    if (batch.hash != NULL)
+        hashNewSearch(batch.hash);
+    batch.results = results;
+    batch.callback = callback;
+    batch.user_data = user_data;
+    batch.seed = getSearchSeed(params);
+    batch.next = 0;
+    mutexInit(&batch.lock);
+
+    // The caller's thread works as one of the workers.
+    Thread *workers = NULL;
+    int started = 0;
+    if (threads > 1)
+        workers = (Thread *)malloc(sizeof(Thread) * (threads - 1));
+    if (workers != NULL) {
+        for (; started < threads - 1; started++) {
+            if (threadCreate(&workers[started], batchThread, &batch) != 0) break;
+        }
+    }
+    analyzePositions(&batch);
+    for (int i = 0; i < started; i++)
+        threadJoin(workers[i]);
+    free(workers);
+
+    mutexDestroy(&batch.lock);
+    if (batch.hash != params->hash)
+        revFreeHashTable(batch.hash);
+    latencyEnd(REV_LATENCY_ANALYZE_BATCH, latency_start);
+}
@@ -0,0 +1,258 @@
+#include <string.h>
+#include "reversi.h"
+#include "internal.h"
+#include "latency.h"
+#include "search.h"
+#include "thread.h"
+#include "timer.h"
+
+// Depth of the search that predicts the opponent's reply for pondering.
+#define PREDICT_DEPTH 4
+
+typedef struct SearchJob {
+    RevBoard board;
+    RevSearchParams params;
+    RevSearchCallback callback;
+    void *user_data;
+    uint64_t seed;
+    int ponder;  // TRUE for pondering. board is the opponent's turn then.
+    int predicted_move;
+    int deliver_only;  // TRUE to pass the finished ponder result to callback.
+    uint64_t latency_start;  // latencyStart() of revSearchStart(). Zero for pondering.
+} SearchJob;
+
+struct RevEngine {
+    Thread thread;
+    Mutex lock;
+    Cond cond;
+    SearchControl control;
+
+    // Members below are protected by lock.
+    SearchJob pending;
+    int has_job;  // TRUE when pending is waiting for the engine thread.
+    int running;  // TRUE while a job is being processed.
+    int pondering;  // TRUE while the running or finished search is not requested yet.
+    int ponder_done;  // TRUE when pondering finished before the opponent moved.
+    RevBoard ponder_board;  // The position after the predicted reply.
+    RevSearchCallback callback;  // Callback for the running search. A ponder hit sets it.
+    void *user_data;
+    uint64_t latency_start;  // When the running search was requested. A ponder hit sets it.
+    RevSearchResult result;
+    int quit;
+};
+
+static int isSamePosition(RevBoard *b1, RevBoard *b2) {
+    return b1->bitboards[DISK_BLACK] == b2->bitboards[DISK_BLACK] &&
+           b1->bitboards[DISK_WHITE] == b2->bitboards[DISK_WHITE] &&
+           b1->current_player == b2->current_player;
+}
+
+// Plays the predicted reply on job->board. It runs on the engine thread.
+static void playPredictedMove(SearchJob *job) {
+    RevBoard *board = &job->board;
+    if (revHasLegalMoves(board)) {
+        int move = job->predicted_move;
+        if (!revIsLegalMove(board, move)) {
+            SearchControl control;
+            RevSearchParams params;
+            RevSearchResult result;
+            initSearchControl(&control, 0);
+            revInitSearchParams(&params);
+            params.depth = PREDICT_DEPTH;
+            searchBoard(board, &params, &control, job->seed, &result);
+            move = result.move;
+        }
+        revMove(board, move);
+    } else {
+        revChangePlayer(board);  // The opponent has to pass.
+    }
+}
+
+static void engineThread(void *arg) {
+    RevEngine *engine = (RevEngine *)arg;
+    mutexLock(&engine->lock);
+    for (;;) {
+        while (!engine->has_job && !engine->quit)
+            condWait(&engine->cond, &engine->lock);
+        if (engine->quit) break;
+
+        SearchJob job = engine->pending;
+        engine->has_job = 0;
+        engine->running = 1;
+        engine->pondering = job.ponder;
+        engine->ponder_done = 0;
+        engine->callback = job.callback;
+        engine->user_data = job.user_data;
+        engine->latency_start = job.latency_start;
+
+        if (!job.deliver_only) {
+            initSearchControl(&engine->control, job.ponder ? 0 : job.params.time_ms);
+            if (job.ponder) {
+                engine->ponder_board.current_player = DISK_NONE;  // Not predicted yet.
+                mutexUnlock(&engine->lock);
+                playPredictedMove(&job);
+                mutexLock(&engine->lock);
+                engine->ponder_board = job.board;
+            }
+            mutexUnlock(&engine->lock);
+
+            RevSearchResult result;
+            searchBoard(&job.board, &job.params, &engine->control, job.seed, &result);
+
+            mutexLock(&engine->lock);
+            engine->result = result;
+        }
+
+        if (engine->pondering) {
+            // Keep the result until the opponent plays the predicted move.
+            engine->ponder_done = !engine->has_job;
+        } else if (!engine->quit) {
+            // Nothing is delivered after revFreeEngine(). The caller is tearing down its state.
+            // Latency of a request runs from revSearchStart() to the delivery of the result.
+            // Pondering has no deadline, so it only counts from a ponder hit.
+            latencyEnd(REV_LATENCY_SEARCH, engine->latency_start);
+            if (engine->callback != NULL) {
+                RevSearchResult result = engine->result;
+                RevSearchCallback callback = engine->callback;
+                void *user_data = engine->user_data;
+                mutexUnlock(&engine->lock);
+                callback(&result, user_data);
+                mutexLock(&engine->lock);
+            }
+        }
+        engine->running = 0;
+        condBroadcast(&engine->cond);
+    }
+    mutexUnlock(&engine->lock);
+}
+
+RevEngine *revNewEngine() {
+    RevEngine *engine = (RevEngine *)malloc(sizeof(RevEngine));
+    if (engine == NULL) return NULL;
+    mutexInit(&engine->lock);
+    condInit(&engine->cond);
+    initSearchControl(&engine->control, 0);
+    engine->has_job = 0;
+    engine->running = 0;
+    engine->pondering = 0;
+    engine->ponder_done = 0;
+    engine->callback = NULL;
+    engine->user_data = NULL;
+    memset(&engine->result, 0, sizeof(engine->result));
+    engine->result.move = -1;
+    engine->quit = 0;
+    if (threadCreate(&engine->thread, engineThread, engine) != 0) {
+        condDestroy(&engine->cond);
+        mutexDestroy(&engine->lock);
+        free(engine);
+        return NULL;
+    }
+    return engine;
+}
+
+void revFreeEngine(RevEngine *engine) {
+    mutexLock(&engine->lock);
+    engine->quit = 1;
+    atomicStoreInt(&engine->control.stop, 1);
+    condBroadcast(&engine->cond);
+    mutexUnlock(&engine->lock);
+    threadJoin(engine->thread);
+    condDestroy(&engine->cond);
+    mutexDestroy(&engine->lock);
+    free(engine);
+}
+
+// Queues a job and stops the running search. engine->lock should be locked.
+static void queueJob(RevEngine *engine, const SearchJob *job) {
+    if (engine->running)
+        atomicStoreInt(&engine->control.stop, 1);
+    engine->pending = *job;
+    engine->has_job = 1;
+    engine->ponder_done = 0;
+    condBroadcast(&engine->cond);
+}
+
+void revSearchStart(RevEngine *engine, RevBoard *board, const RevSearchParams *params,
+                    RevSearchCallback callback, void *user_data) {
+    SearchJob job;
+    job.board = *board;
+    job.params = *params;
+    job.callback = callback;
+    job.user_data = user_data;
+    job.seed = getSearchSeed(params);
+    job.ponder = 0;
+    job.predicted_move = -1;
+    job.deliver_only = 0;
+    job.latency_start = latencyStart();
+
+    mutexLock(&engine->lock);
+    if (engine->pondering && !engine->has_job && isSamePosition(&engine->ponder_board, board)) {
+        // Ponder hit. Reuse the search on the predicted position.
+        engine->pondering = 0;
+        if (engine->running) {
+            engine->callback = callback;
+            engine->user_data = user_data;
+            engine->latency_start = job.latency_start;
+            atomicStoreU64(&engine->control.deadline,
+                           (params->time_ms > 0) ? getTimeMs() + (uint64_t)params->time_ms : 0);
+            mutexUnlock(&engine->lock);
+            return;
+        }
+        if (engine->ponder_done) {
+            job.deliver_only = 1;
+        }
+    }
+    engine->pondering = 0;
+    queueJob(engine, &job);
+    mutexUnlock(&engine->lock);
+}
+
+void revPonderStart(RevEngine *engine, RevBoard *board, int predicted_move,
+                    const RevSearchParams *params) {
+    SearchJob job;
+    job.board = *board;
+    job.params = *params;
+    job.callback = NULL;
+    job.user_data = NULL;
+    job.seed = getSearchSeed(params);
+    job.ponder = 1;
+    job.predicted_move = predicted_move;
+    job.deliver_only = 0;
+    job.latency_start = 0;
+
+    mutexLock(&engine->lock);
+    queueJob(engine, &job);
+    mutexUnlock(&engine->lock);
+}
+
+void revSearchStop(RevEngine *engine) {
+    mutexLock(&engine->lock);
+    if (engine->running)
+        atomicStoreInt(&engine->control.stop, 1);
+    mutexUnlock(&engine->lock);
+}
+
+// Returns TRUE while a requested search is queued or running. engine->lock should be locked.
+// Pondering is not counted, so it never blocks the caller.
+static int isSearching(RevEngine *engine) {
+    return (engine->has_job && !engine->pending.ponder) ||
+           (engine->running && !engine->pondering);
+}
+
+int revSearchWait(RevEngine *engine, RevSearchResult *result) {
+    mutexLock(&engine->lock);
+    while (isSearching(engine))
+        condWait(&engine->cond, &engine->lock);
+    if (result != NULL)
+        *result = engine->result;
+    const int move = engine->result.move;
+    mutexUnlock(&engine->lock);
+    return move;
+}
+
+int revIsSearching(RevEngine *engine) {
+    mutexLock(&engine->lock);
+    const int searching = isSearching(engine);
+    mutexUnlock(&engine->lock);
+    return searching;
+}
@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <string.h>
+#include "reversi.h"
+#include "internal.h"
+#include "eval.h"
+
+#define EVAL_FILE_MAGIC "REVEVAL"
+#define EVAL_FILE_VERSION 1
+#define EVAL_FILE_BYTE_ORDER 0x01020304u
+
+// Followed by int16_t weights of each stage.
+typedef struct EvalFileHeader {
+    char magic[8];  // EVAL_FILE_MAGIC
+    uint32_t version;  // EVAL_FILE_VERSION
+    uint32_t byte_order;  // EVAL_FILE_BYTE_ORDER in the byte order of the writer
+    uint32_t stages;  // REV_EVAL_STAGES
+    uint32_t weights;  // REV_EVAL_WEIGHTS
+    uint32_t scale;  // EVAL_SCALE
+} EvalFileHeader;
+
+// Patterns on a copy of the board. The 8 copies cover the other lines and corners.
+#define PATTERN_LINE2 0  // The 2nd row
+#define PATTERN_LINE3 1  // The 3rd row
+#define PATTERN_LINE4 2  // The 4th row
+#define PATTERN_DIAG8 3  // The diagonal from the corner, and shorter ones below it
+#define PATTERN_DIAG7 4
+#define PATTERN_DIAG6 5
+#define PATTERN_DIAG5 6
+#define PATTERN_DIAG4 7
+#define PATTERN_EDGE 8  // The 1st row, B2, and G2
+#define PATTERN_CORNER3X3 9  // 3x3 squares at the corner
+#define PATTERN_CORNER2X5 10  // 2x5 squares at the corner
+#define PATTERN_COUNT 11
+
+// Index of the first weight of each pattern. A pattern of n squares has 3^n weights.
+static const int pattern_offsets[PATTERN_COUNT] = {
+    0, 6561, 13122, 19683, 26244, 28431, 29160, 29403, 29484, 88533, 108216,
+};
+
+// The last weight is the bias, which every board has.
+#define BIAS_FEATURE (REV_EVAL_WEIGHTS - 1)
+
+// Binary digits of 5 bits as base 3 digits.
+static const int ternary5[32] = {
+    0, 1, 3, 4, 9, 10, 12, 13, 27, 28, 30, 31, 36, 37, 39, 40,
+    81, 82, 84, 85, 90, 91, 93, 94, 108, 109, 111, 112, 117, 118, 120, 121,
+};
+
+// Converts bits of up to 10 squares to a base 3 index.
+static inline int ternaryIndex(unsigned p_bits, unsigned o_bits) {
+    return ternary5[p_bits & 31] + 243 * ternary5[p_bits >> 5] +
+           2 * (ternary5[o_bits & 31] + 243 * ternary5[o_bits >> 5]);
+}
+
+static inline unsigned gatherRow(RevBitboard b, int row) {
+    return (unsigned)(b >> (row * 8)) & 0xff;
+}
+
+// Gathers the diagonal from (0, row) to (7 - row, 7). A square of each column
+// moves to the top byte by the multiplication without carries.
+static inline unsigned gatherDiagonal(RevBitboard b, int row) {
+    return (unsigned)(((b & (0x8040201008040201 << (row * 8))) * 0x0101010101010101) >> 56);
+}
+
+// The 1st row, B2, and G2.
+static inline unsigned gatherEdge(RevBitboard b) {
+    return (unsigned)((b & 0xff) | ((b >> 1) & 0x100) | ((b >> 5) & 0x200));
+}
+
+static inline unsigned gatherCorner3x3(RevBitboard b) {
+    return (unsigned)((b & 0x7) | ((b >> 5) & 0x38) | ((b >> 10) & 0x1c0));
+}
+
+static inline unsigned gatherCorner2x5(RevBitboard b) {
+    return (unsigned)((b & 0x1f) | ((b >> 3) & 0x3e0));
+}
+
+// Writes PATTERN_COUNT features of a copy of the board.
+static inline void readPatterns(RevBitboard p_board, RevBitboard o_board, int *features) {
+    for (int row = 1; row <= 3; row++) {
+        features[PATTERN_LINE2 + row - 1] = pattern_offsets[PATTERN_LINE2 + row - 1] +
+            ternaryIndex(gatherRow(p_board, row), gatherRow(o_board, row));
+    }
+    for (int row = 0; row <= 4; row++) {
+        features[PATTERN_DIAG8 + row] = pattern_offsets[PATTERN_DIAG8 + row] +
+            ternaryIndex(gatherDiagonal(p_board, row), gatherDiagonal(o_board, row));
+    }
+    features[PATTERN_EDGE] = pattern_offsets[PATTERN_EDGE] +
+        ternaryIndex(gatherEdge(p_board), gatherEdge(o_board));
+    features[PATTERN_CORNER3X3] = pattern_offsets[PATTERN_CORNER3X3] +
+        ternaryIndex(gatherCorner3x3(p_board), gatherCorner3x3(o_board));
+    features[PATTERN_CORNER2X5] = pattern_offsets[PATTERN_CORNER2X5] +
+        ternaryIndex(gatherCorner2x5(p_board), gatherCorner2x5(o_board));
+}
+
+int getEvalFeatures(RevBitboard p_board, RevBitboard o_board, int *features) {
+    const int stage = getEvalStageFromEmpties(64 - countOnes(p_board | o_board));
+    for (int i = 0; i < 8; i++) {
+        // Transforms are applied to the previous copy. The sequence visits all 8 copies.
+        if (i == 4) {
+            p_board = flipDiagonal(p_board);
+            o_board = flipDiagonal(o_board);
+        } else if (i & 1) {
+            p_board = flipVertical(p_board);
+            o_board = flipVertical(o_board);
+        } else if (i > 0) {
+            p_board = mirrorHorizontal(p_board);
+            o_board = mirrorHorizontal(o_board);
+        }
+        readPatterns(p_board, o_board, features + i * PATTERN_COUNT);
+    }
+    features[8 * PATTERN_COUNT] = BIAS_FEATURE;
+    return stage;
+}
+
+int evaluatePatterns(const RevEvalWeights *weights, RevBitboard p_board, RevBitboard o_board) {
+    int features[REV_EVAL_FEATURES];
+    const int16_t *stage_weights = weights->weights[getEvalFeatures(p_board, o_board, features)];
+    int score = 0;
+    for (int i = 0; i < REV_EVAL_FEATURES; i++)
+        score += stage_weights[features[i]];
+    return score;
+}
+
+RevEvalWeights *revNewEvalWeights() {
+    return (RevEvalWeights *)calloc(1, sizeof(RevEvalWeights));
+}
+
+void revFreeEvalWeights(RevEvalWeights *weights) {
+    free(weights);
+}
+
+int revSetEvalWeight(RevEvalWeights *weights, int stage, int feature, double value) {
+    if (stage < 0 || stage >= REV_EVAL_STAGES || feature < 0 || feature >= REV_EVAL_WEIGHTS)
+        return 0;
+    double scaled = value * EVAL_SCALE;
+    if (scaled > INT16_MAX) scaled = INT16_MAX;
+    if (scaled < INT16_MIN) scaled = INT16_MIN;
+    weights->weights[stage][feature] = (int16_t)(scaled + ((scaled >= 0) ? 0.5 : -0.5));
+    return 1;
+}
+
+double revGetEvalWeight(const RevEvalWeights *weights, int stage, int feature) {
+    if (stage < 0 || stage >= REV_EVAL_STAGES || feature < 0 || feature >= REV_EVAL_WEIGHTS)
+        return 0;
+    return (double)weights->weights[stage][feature] / EVAL_SCALE;
+}
+
+RevEvalWeights *revLoadEvalWeights(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    RevEvalWeights *weights = (RevEvalWeights *)malloc(sizeof(RevEvalWeights));
+    if (weights == NULL) {
+        fclose(file);
+        return NULL;
+    }
+
+    EvalFileHeader header;
+    const int ok = fread(&header, sizeof(header), 1, file) == 1 &&
+                   memcmp(header.magic, EVAL_FILE_MAGIC, sizeof(header.magic)) == 0 &&
+                   header.version == EVAL_FILE_VERSION &&
+                   header.byte_order == EVAL_FILE_BYTE_ORDER &&
+                   header.stages == REV_EVAL_STAGES && header.weights == REV_EVAL_WEIGHTS &&
+                   header.scale == EVAL_SCALE &&
+                   fread(weights->weights, sizeof(weights->weights), 1, file) == 1 &&
+                   fgetc(file) == EOF;
+    fclose(file);
+    if (!ok) {
+        free(weights);
+        return NULL;
+    }
+    return weights;
+}
+
+int revSaveEvalWeights(const RevEvalWeights *weights, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) return 0;
+    EvalFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, EVAL_FILE_MAGIC, sizeof(header.magic));
+    header.version = EVAL_FILE_VERSION;
+    header.byte_order = EVAL_FILE_BYTE_ORDER;
+    header.stages = REV_EVAL_STAGES;
+    header.weights = REV_EVAL_WEIGHTS;
+    header.scale = EVAL_SCALE;
+    const int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(weights->weights, sizeof(weights->weights), 1, file) == 1;
+    return (fclose(file) == 0) && ok;
+}
+
+int revGetEvalFeatures(RevBoard *board, int *features) {
+    const RevBitboard p_board = board->bitboards[board->current_player];
+    const RevBitboard o_board = board->bitboards[!board->current_player];
+    return getEvalFeatures(p_board, o_board, features);
+}
+
+double revEvaluate(const RevEvalWeights *weights, RevBoard *board) {
+    const RevBitboard p_board = board->bitboards[board->current_player];
+    const RevBitboard o_board = board->bitboards[!board->current_player];
+    return (double)evaluatePatterns(weights, p_board, o_board) / EVAL_SCALE;
+}
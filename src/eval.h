@@ -0,0 +1,30 @@
+#ifndef __REVERSI_SRC_EVAL_H__
+#define __REVERSI_SRC_EVAL_H__
+#include "reversi.h"
+
+// Pattern evaluation. Each pattern reads its squares as a number in base 3
+// (0: empty, 1: player, 2: opponent), and the number is an index of its weights.
+// Patterns are read from the 8 symmetric copies of the board with the same weights,
+// so symmetric boards get the same evaluation.
+
+// Weights are stored in 1/EVAL_SCALE disks.
+#define EVAL_SCALE 64
+
+struct RevEvalWeights {
+    int16_t weights[REV_EVAL_STAGES][REV_EVAL_WEIGHTS];
+};
+
+static inline int getEvalStageFromEmpties(int empties) {
+    const int stage = (60 - empties) / 6;
+    if (stage < 0) return 0;
+    if (stage >= REV_EVAL_STAGES) return REV_EVAL_STAGES - 1;
+    return stage;
+}
+
+// Writes REV_EVAL_FEATURES indices of weights for p_board, and returns the game stage.
+int getEvalFeatures(RevBitboard p_board, RevBitboard o_board, int *features);
+
+// Returns the evaluation for p_board in 1/EVAL_SCALE disks.
+int evaluatePatterns(const RevEvalWeights *weights, RevBitboard p_board, RevBitboard o_board);
+
+#endif  // __REVERSI_SRC_EVAL_H__
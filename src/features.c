@@ -0,0 +1,67 @@
+#include <string.h>
+#include "reversi.h"
+#include "internal.h"
+
+// Dense input tensors for external models.
+// Each nibble of a bitboard is expanded to 4 values with a table, and copied at once.
+// Compilers turn the fixed-size copies into single stores, which are much faster than
+// writing squares one by one.
+
+#define SQUARES 64
+#define TENSOR_SIZE (REV_FEATURE_PLANES * SQUARES)
+
+static const float nibble_floats[16][4] = {
+    { 0, 0, 0, 0 }, { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 1, 1, 0, 0 },
+    { 0, 0, 1, 0 }, { 1, 0, 1, 0 }, { 0, 1, 1, 0 }, { 1, 1, 1, 0 },
+    { 0, 0, 0, 1 }, { 1, 0, 0, 1 }, { 0, 1, 0, 1 }, { 1, 1, 0, 1 },
+    { 0, 0, 1, 1 }, { 1, 0, 1, 1 }, { 0, 1, 1, 1 }, { 1, 1, 1, 1 },
+};
+
+static const uint8_t nibble_bytes[16][4] = {
+    { 0, 0, 0, 0 }, { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 1, 1, 0, 0 },
+    { 0, 0, 1, 0 }, { 1, 0, 1, 0 }, { 0, 1, 1, 0 }, { 1, 1, 1, 0 },
+    { 0, 0, 0, 1 }, { 1, 0, 0, 1 }, { 0, 1, 0, 1 }, { 1, 1, 0, 1 },
+    { 0, 0, 1, 1 }, { 1, 0, 1, 1 }, { 0, 1, 1, 1 }, { 1, 1, 1, 1 },
+};
+
+static inline void expandFloats(RevBitboard b, float *out) {
+    for (int i = 0; i < SQUARES / 4; i++, b >>= 4)
+        memcpy(out + i * 4, nibble_floats[b & 15], sizeof(nibble_floats[0]));
+}
+
+static inline void expandBytes(RevBitboard b, uint8_t *out) {
+    for (int i = 0; i < SQUARES / 4; i++, b >>= 4)
+        memcpy(out + i * 4, nibble_bytes[b & 15], sizeof(nibble_bytes[0]));
+}
+
+static inline RevBitboard transformBitboard(RevBitboard b, int symmetry) {
+    if (symmetry & 4) b = flipDiagonal(b);
+    if (symmetry & 1) b = mirrorHorizontal(b);
+    if (symmetry & 2) b = flipVertical(b);
+    return b;
+}
+
+int revExtractFeatures(RevBoard **boards, int count, void *out, int flags) {
+    if (count <= 0) return 0;
+    const int copies = (flags & REV_FEATURES_SYMMETRIES) ? 8 : 1;
+    size_t tensor = 0;
+    for (int i = 0; i < count; i++) {
+        const RevBoard *board = boards[i];
+        const RevBitboard p_board = board->bitboards[board->current_player];
+        const RevBitboard o_board = board->bitboards[!board->current_player];
+        const RevBitboard planes[REV_FEATURE_PLANES] = {
+            p_board, o_board, ~(p_board | o_board), calcMobility(p_board, o_board),
+        };
+        for (int symmetry = 0; symmetry < copies; symmetry++, tensor++) {
+            for (int plane = 0; plane < REV_FEATURE_PLANES; plane++) {
+                const RevBitboard b = transformBitboard(planes[plane], symmetry);
+                const size_t offset = tensor * TENSOR_SIZE + (size_t)plane * SQUARES;
+                if (flags & REV_FEATURES_UINT8)
+                    expandBytes(b, (uint8_t *)out + offset);
+                else
+                    expandFloats(b, (float *)out + offset);
+            }
+        }
+    }
+    return (int)tensor;
+}
@@ -0,0 +1,387 @@
+#ifdef __linux__
+// mmap() flags, madvise(), and syscall() are hidden in strict C99 mode.
+#define _GNU_SOURCE
+#endif
+#include <string.h>
+#include "reversi.h"
+#include "internal.h"
+#include "hash.h"
+#include "thread.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define HASH_FILE_SUPPORT
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+// Tables that are smaller than a huge page use malloc().
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+// Constants of <numaif.h>, which comes with libnuma instead of the C library.
+#define NUMA_MPOL_INTERLEAVE 3
+#define NUMA_MPOL_F_MEMS_ALLOWED 4
+#define NUMA_MAX_NODES 1024
+
+// Tables of revOpenHashTable() start with a header page, so that entries stay aligned.
+// Bump the version when keys or the layout of entries change. Old files are rebuilt then.
+#define HASH_FILE_MAGIC "REVHASH"
+#define HASH_FILE_VERSION 1
+#define HASH_FILE_HEADER_SIZE 4096
+#define HASH_FILE_BYTE_ORDER 0x01020304u
+
+typedef struct HashFileHeader {
+    char magic[8];  // HASH_FILE_MAGIC
+    uint32_t version;  // HASH_FILE_VERSION
+    uint32_t byte_order;  // HASH_FILE_BYTE_ORDER in the byte order of the writer
+    uint32_t entry_size;  // sizeof(HashEntry)
+    uint32_t bucket_size;  // HASH_BUCKET_SIZE
+    uint64_t bucket_count;
+    int generation;  // Shared by all processes that use the table.
+    int ready;  // TRUE after entries are cleared. FALSE if the creator died halfway.
+} HashFileHeader;
+
+// Bits of HashEntry::data
+// 0-7: move, 8-15: depth, 16-23: score + 128, 24-25: bound, 32-39: generation,
+// 40-43: selectivity
+static inline uint64_t packData(int move, int depth, int score, int bound, int selectivity,
+                                int generation) {
+    return (uint64_t)move | ((uint64_t)depth << 8) | ((uint64_t)(score + 128) << 16) |
+           ((uint64_t)bound << 24) | ((uint64_t)(generation & 0xff) << 32) |
+           ((uint64_t)(selectivity & 0xf) << 40);
+}
+
+static inline int dataGeneration(uint64_t data) {
+    return (int)((data >> 32) & 0xff);
+}
+
+static inline int dataDepth(uint64_t data) {
+    return (int)((data >> 8) & 0xff);
+}
+
+#ifdef __linux__
+// Spreads pages over all NUMA nodes that the process can use.
+// Returns FALSE if there is only one node, or the kernel doesn't support NUMA.
+static int interleaveNodes(void *memory, size_t size) {
+    unsigned long nodes[NUMA_MAX_NODES / (8 * sizeof(unsigned long))] = { 0 };
+    if (syscall(SYS_get_mempolicy, NULL, nodes, (unsigned long)NUMA_MAX_NODES, NULL,
+                (unsigned long)NUMA_MPOL_F_MEMS_ALLOWED) != 0)
+        return 0;
+    int count = 0;
+    for (size_t i = 0; i < sizeof(nodes) / sizeof(nodes[0]); i++)
+        count += countOnes((RevBitboard)nodes[i]);
+    if (count < 2) return 0;
+    return syscall(SYS_mbind, memory, (unsigned long)size, (unsigned long)NUMA_MPOL_INTERLEAVE,
+                   nodes, (unsigned long)NUMA_MAX_NODES, 0u) == 0;
+}
+#endif
+
+// Allocates memory for entries with the page types and the placement of flags.
+// Each of them falls back to the next one: explicit huge pages, transparent huge pages,
+// and malloc(). Sets flags that took effect to hash->flags.
+static int allocateEntries(RevHashTable *hash, size_t size, int flags) {
+    hash->flags = 0;
+    hash->mapped = 0;
+    if (size >= HUGE_PAGE_SIZE) {
+#ifdef _WIN32
+        // It needs the "Lock pages in memory" privilege.
+        const SIZE_T large_page = GetLargePageMinimum();
+        if ((flags & REV_HASH_HUGE_PAGES) && large_page > 0 && size % large_page == 0) {
+            hash->memory = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                                        PAGE_READWRITE);
+            if (hash->memory != NULL) {
+                hash->entries = (HashEntry *)hash->memory;
+                hash->mapped = 1;
+                hash->flags = REV_HASH_HUGE_PAGES;
+                return 1;
+            }
+        }
+#elif defined(__linux__)
+        // It needs pages reserved in /proc/sys/vm/nr_hugepages.
+        void *memory = MAP_FAILED;
+        size_t mapped_size = size;
+        if (flags & REV_HASH_HUGE_PAGES) {
+            memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (memory != MAP_FAILED)
+                hash->flags |= REV_HASH_HUGE_PAGES;
+        }
+        if (memory == MAP_FAILED && (flags & (REV_HASH_HUGE_PAGES |
+                                              REV_HASH_TRANSPARENT_HUGE_PAGES))) {
+            // Transparent huge pages need 2 MB aligned memory. Trim the extra space.
+            mapped_size = size + HUGE_PAGE_SIZE;
+            memory = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory != MAP_FAILED) {
+                const uintptr_t start = (uintptr_t)memory;
+                const uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+                if (aligned > start)
+                    munmap(memory, aligned - start);
+                if (aligned + size < start + mapped_size)
+                    munmap((void *)(aligned + size), start + mapped_size - aligned - size);
+                memory = (void *)aligned;
+                mapped_size = size;
+                if (madvise(memory, size, MADV_HUGEPAGE) == 0)
+                    hash->flags |= REV_HASH_TRANSPARENT_HUGE_PAGES;
+            }
+        }
+        if (memory == MAP_FAILED && (flags & REV_HASH_NUMA_INTERLEAVE)) {
+            memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                          -1, 0);
+        }
+        if (memory != MAP_FAILED) {
+            // Pages are placed when they are touched first, so set the policy before clearing.
+            if ((flags & REV_HASH_NUMA_INTERLEAVE) && interleaveNodes(memory, mapped_size))
+                hash->flags |= REV_HASH_NUMA_INTERLEAVE;
+            hash->memory = memory;
+            hash->entries = (HashEntry *)memory;
+            hash->memory_size = mapped_size;
+            hash->mapped = 1;
+            return 1;
+        }
+#endif
+    }
+    hash->memory = malloc(size + 63);
+    if (hash->memory == NULL) return 0;
+    hash->entries = (HashEntry *)(((uintptr_t)hash->memory + 63) & ~(uintptr_t)63);
+    return 1;
+}
+
+// Returns the largest power of 2 buckets that fit in size_mb.
+static uint64_t bucketsForSize(int size_mb) {
+    const uint64_t bucket_bytes = sizeof(HashEntry) * HASH_BUCKET_SIZE;
+    const uint64_t max_buckets = ((uint64_t)(size_mb > 0 ? size_mb : 1) << 20) / bucket_bytes;
+    uint64_t buckets = 1;
+    while (buckets * 2 <= max_buckets) buckets *= 2;
+    return buckets;
+}
+
+RevHashTable *revNewHashTableWithFlags(int size_mb, int flags) {
+    RevHashTable *hash = (RevHashTable *)malloc(sizeof(RevHashTable));
+    if (hash == NULL) return NULL;
+
+    const uint64_t buckets = bucketsForSize(size_mb);
+    if (!allocateEntries(hash, (size_t)(buckets * sizeof(HashEntry) * HASH_BUCKET_SIZE), flags)) {
+        free(hash);
+        return NULL;
+    }
+    hash->fd = -1;
+    hash->bucket_mask = buckets - 1;
+    hash->local_generation = 0;
+    hash->generation = &hash->local_generation;
+    revClearHashTable(hash);
+    return hash;
+}
+
+RevHashTable *revNewHashTable(int size_mb) {
+    return revNewHashTableWithFlags(size_mb, REV_HASH_TRANSPARENT_HUGE_PAGES);
+}
+
+int revGetHashTableFlags(const RevHashTable *hash) {
+    return hash->flags;
+}
+
+#ifdef HASH_FILE_SUPPORT
+// Returns TRUE if the file has the size of a table with count buckets.
+// Bucket count should be a power of 2.
+static int isTableSize(off_t file_size, uint64_t count) {
+    return count > 0 && (count & (count - 1)) == 0 &&
+           (uint64_t)file_size == HASH_FILE_HEADER_SIZE +
+                                  count * sizeof(HashEntry) * HASH_BUCKET_SIZE;
+}
+
+static int isHeaderCompatible(const HashFileHeader *header, off_t file_size) {
+    if (memcmp(header->magic, HASH_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != HASH_FILE_VERSION || header->byte_order != HASH_FILE_BYTE_ORDER ||
+        header->entry_size != sizeof(HashEntry) || header->bucket_size != HASH_BUCKET_SIZE ||
+        !header->ready)
+        return 0;
+    return isTableSize(file_size, header->bucket_count);
+}
+
+// Returns TRUE if the file is not a table of any version, and has data that must be kept.
+static int isForeignFile(const HashFileHeader *header, off_t file_size) {
+    static const HashFileHeader zeros;
+    if (file_size == 0) return 0;
+    if (file_size < (off_t)sizeof(HashFileHeader)) return 1;
+    if (memcmp(header->magic, HASH_FILE_MAGIC, sizeof(header->magic)) == 0) return 0;
+    // A creator that died before writing the header leaves a whole header of zeros,
+    // and the file already has the size of a table. Other files are kept.
+    const uint64_t bucket_bytes = sizeof(HashEntry) * HASH_BUCKET_SIZE;
+    return memcmp(header, &zeros, sizeof(HashFileHeader)) != 0 ||
+           file_size < HASH_FILE_HEADER_SIZE ||
+           !isTableSize(file_size, (uint64_t)(file_size - HASH_FILE_HEADER_SIZE) / bucket_bytes);
+}
+
+// Resizes the file to a new table. The caller has to be the only user of the file.
+static int createTableFile(int fd, off_t file_size, uint64_t buckets) {
+    const off_t size = (off_t)(HASH_FILE_HEADER_SIZE +
+                               buckets * sizeof(HashEntry) * HASH_BUCKET_SIZE);
+    // Truncating to zero discards old entries without writing them.
+    if (file_size != 0 && ftruncate(fd, 0) != 0) return 0;
+    if (ftruncate(fd, size) != 0) return 0;
+    HashFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HASH_FILE_MAGIC, sizeof(header.magic));
+    header.version = HASH_FILE_VERSION;
+    header.byte_order = HASH_FILE_BYTE_ORDER;
+    header.entry_size = sizeof(HashEntry);
+    header.bucket_size = HASH_BUCKET_SIZE;
+    header.bucket_count = buckets;
+    header.ready = 1;  // New pages are zeros, which are empty entries.
+    return pwrite(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header);
+}
+#endif
+
+RevHashTable *revOpenHashTable(const char *name, int size_mb, int flags) {
+#ifdef HASH_FILE_SUPPORT
+    int fd;
+    if (flags & REV_HASH_SHARED_MEMORY)
+        fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+    else
+        fd = open(name, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return NULL;
+
+    // Attach protocol:
+    // - Whoever gets the exclusive lock checks the header, and rebuilds the table if it's
+    //   incompatible or broken. Nobody else has it mapped at that time.
+    // - Then everyone holds a shared lock while the table is mapped. Others wait for
+    //   the shared lock while a table is being created, and never rebuild a table in use.
+    const int exclusive = flock(fd, LOCK_EX | LOCK_NB) == 0;
+    if (!exclusive && flock(fd, LOCK_SH) != 0) {
+        close(fd);
+        return NULL;
+    }
+    struct stat st;
+    HashFileHeader header;
+    memset(&header, 0, sizeof(header));
+    if (fstat(fd, &st) != 0 ||
+        (st.st_size >= (off_t)sizeof(header) &&
+         pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))) {
+        close(fd);
+        return NULL;
+    }
+    if (!isHeaderCompatible(&header, st.st_size)) {
+        if (!exclusive || isForeignFile(&header, st.st_size) ||
+            !createTableFile(fd, st.st_size, bucketsForSize(size_mb)) ||
+            fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != sizeof(header)) {
+            close(fd);
+            return NULL;
+        }
+    }
+    if (exclusive) {
+        // Let other processes attach. flock() converts the lock in place.
+        flock(fd, LOCK_SH);
+    }
+
+    RevHashTable *hash = (RevHashTable *)malloc(sizeof(RevHashTable));
+    void *memory = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (hash == NULL || memory == MAP_FAILED) {
+        if (memory != MAP_FAILED) munmap(memory, (size_t)st.st_size);
+        free(hash);
+        close(fd);
+        return NULL;
+    }
+    hash->memory = memory;
+    hash->memory_size = (size_t)st.st_size;
+    hash->mapped = 1;
+    hash->flags = flags & REV_HASH_SHARED_MEMORY;
+    hash->fd = fd;
+    hash->entries = (HashEntry *)((char *)memory + HASH_FILE_HEADER_SIZE);
+    hash->bucket_mask = header.bucket_count - 1;
+    hash->local_generation = 0;
+    hash->generation = &((HashFileHeader *)memory)->generation;
+    return hash;
+#else
+    (void)name;
+    (void)size_mb;
+    (void)flags;
+    return NULL;
+#endif
+}
+
+int revRemoveHashTable(const char *name, int flags) {
+#ifdef HASH_FILE_SUPPORT
+    if (flags & REV_HASH_SHARED_MEMORY)
+        return shm_unlink(name) == 0;
+    return unlink(name) == 0;
+#else
+    (void)name;
+    (void)flags;
+    return 0;
+#endif
+}
+
+void revFreeHashTable(RevHashTable *hash) {
+    if (!hash->mapped) {
+        free(hash->memory);
+    } else {
+#ifdef _WIN32
+        VirtualFree(hash->memory, 0, MEM_RELEASE);
+#elif defined(HASH_FILE_SUPPORT)
+        munmap(hash->memory, hash->memory_size);
+        // Closing the file releases the shared lock.
+        if (hash->fd >= 0) close(hash->fd);
+#endif
+    }
+    free(hash);
+}
+
+void revClearHashTable(RevHashTable *hash) {
+    const uint64_t size = (hash->bucket_mask + 1) * HASH_BUCKET_SIZE * sizeof(HashEntry);
+    memset(hash->entries, 0, (size_t)size);
+}
+
+void hashNewSearch(RevHashTable *hash) {
+    atomicFetchAddInt(hash->generation, 1);
+}
+
+int hashProbe(RevHashTable *hash, uint64_t key, HashData *data) {
+    HashEntry *entry = getBucket(hash, key);
+    for (int i = 0; i < HASH_BUCKET_SIZE; i++, entry++) {
+        const uint64_t d = atomicLoadU64(&entry->data);
+        if ((atomicLoadU64(&entry->key) ^ d) == key && d != 0) {
+            data->move = (int)(d & 0xff);
+            data->depth = dataDepth(d);
+            data->score = (int)((d >> 16) & 0xff) - 128;
+            data->bound = (int)((d >> 24) & 3);
+            data->selectivity = (int)((d >> 40) & 0xf);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void hashStore(RevHashTable *hash, uint64_t key, int depth, int score, int bound,
+               int selectivity, int move) {
+    const int generation = atomicLoadInt(hash->generation);
+    HashEntry *bucket = getBucket(hash, key);
+    HashEntry *replace = bucket;
+    int worst = 0x7fffffff;
+    for (int i = 0; i < HASH_BUCKET_SIZE; i++) {
+        HashEntry *entry = bucket + i;
+        const uint64_t d = atomicLoadU64(&entry->data);
+        if ((atomicLoadU64(&entry->key) ^ d) == key) {
+            // Keep the known best move when this search has no idea.
+            if (move == HASH_NO_MOVE) move = (int)(d & 0xff);
+            replace = entry;
+            break;
+        }
+        // Replace the shallowest entry. Entries from old searches go first.
+        const int value = dataDepth(d) + ((dataGeneration(d) == (generation & 0xff)) << 8);
+        if (value < worst) {
+            worst = value;
+            replace = entry;
+        }
+    }
+    const uint64_t data = packData(move, depth, score, bound, selectivity, generation);
+    atomicStoreU64(&replace->key, key ^ data);
+    atomicStoreU64(&replace->data, data);
+}
@@ -0,0 +1,84 @@
+#ifndef __REVERSI_SRC_HASH_H__
+#define __REVERSI_SRC_HASH_H__
+#include "reversi.h"
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+// Transposition table shared by search threads.
+// Entries are lockless. Each one stores key ^ data and data,
+// so an entry torn by concurrent writes fails the key check instead of returning garbage.
+
+#define HASH_BUCKET_SIZE 4  // 4 entries of 16 bytes fill a cache line.
+#define HASH_NO_MOVE 64
+
+#define BOUND_UPPER 1
+#define BOUND_LOWER 2
+#define BOUND_EXACT 3
+
+typedef struct HashEntry {
+    uint64_t key;  // Hash key XORed with data
+    uint64_t data;
+} HashEntry;
+
+struct RevHashTable {
+    HashEntry *entries;
+    void *memory;  // Unaligned pointer for free(), or the start of mapped pages
+    size_t memory_size;  // Size of mapped pages
+    int mapped;  // TRUE if memory is from mmap() or VirtualAlloc() instead of malloc()
+    int flags;  // REV_HASH_* flags that took effect
+    int fd;  // File that keeps a shared lock while a table of revOpenHashTable() is attached
+    uint64_t bucket_mask;  // Number of buckets - 1
+    int *generation;  // Incremented every search to find old entries. Shared with other processes
+                      // when the table is in a file.
+    int local_generation;
+};
+
+typedef struct HashData {
+    int move;  // HASH_NO_MOVE if unknown
+    int depth;
+    int score;
+    int bound;  // BOUND_UPPER, BOUND_LOWER, or BOUND_EXACT
+    int selectivity;  // Selectivity of the search that stored the entry. 0 for exact results.
+} HashData;
+
+// Finalizer of SplitMix64. Every input bit affects every output bit.
+static inline uint64_t hashMix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+// Mixes p_board fully before o_board joins. Multiplications only carry upward, so
+// combining products of both boards let a disk on the top rows change sides
+// without changing the key.
+static inline uint64_t hashPosition(RevBitboard p_board, RevBitboard o_board) {
+    return hashMix(hashMix(p_board) ^ o_board);
+}
+
+static inline HashEntry *getBucket(RevHashTable *hash, uint64_t key) {
+    return hash->entries + (key & hash->bucket_mask) * HASH_BUCKET_SIZE;
+}
+
+// Starts loading the bucket of a key into the cache, so that a later probe doesn't wait.
+static inline void hashPrefetch(RevHashTable *hash, uint64_t key) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(getBucket(hash, key));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch((const char *)getBucket(hash, key), _MM_HINT_T0);
+#else
+    (void)hash;
+    (void)key;
+#endif
+}
+
+// Increments the generation. Call it once at the start of each search.
+void hashNewSearch(RevHashTable *hash);
+
+// Returns TRUE and fills data if the table has the position.
+int hashProbe(RevHashTable *hash, uint64_t key, HashData *data);
+
+void hashStore(RevHashTable *hash, uint64_t key, int depth, int score, int bound,
+               int selectivity, int move);
+
+#endif  // __REVERSI_SRC_HASH_H__
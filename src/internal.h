@@ -0,0 +1,142 @@
+#ifndef __REVERSI_SRC_INTERNAL_H__
+#define __REVERSI_SRC_INTERNAL_H__
+#include "reversi.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Definitions shared by the source files of reversi-core.
+// Nothing in this header is exported from the library.
+
+struct RevBoard {
+    // bitboards for disks on a 8 x 8 board
+    // bitboards[0] : black disks
+    // bitboards[1] : white disks
+    RevBitboard bitboards[2];
+    RevBitboard mobility;
+    RevDiskType current_player;  // 0 means black's turn. 1 means white's turn.
+    int mobility_count;  // The number of legal moves.
+};
+
+// Generates a 64-bit seed with the global mersenne twister.
+uint64_t genSeed64(void);
+
+// Returns disks of p_board that can never be flipped. It's a lower bound, not the exact set.
+RevBitboard calcStableDisks(RevBitboard p_board, RevBitboard o_board);
+
+static inline int countFirstZeros(RevBitboard b) {
+#ifdef _MSC_VER
+    return (int)_lzcnt_u64(b);
+#else
+    // __builtin_clzll(b) is undefined when b == 0
+    return (int)(__builtin_clzll(b) * (b != 0) + 64 * (b == 0));
+#endif
+}
+
+static inline int countOnes(RevBitboard b) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(b);
+#else
+    return (int)__builtin_popcountll(b);
+#endif
+}
+
+// Returns the position of the lowest populated bit. b should not be zero.
+static inline int firstOnePos(RevBitboard b) {
+#ifdef _MSC_VER
+    return (int)_tzcnt_u64(b);
+#else
+    return (int)__builtin_ctzll(b);
+#endif
+}
+
+static inline RevBitboard getMobilityOneDirection(RevBitboard p_board, RevBitboard masked_o,
+                                                  int shift) {
+    RevBitboard mobility;
+    RevBitboard flip, pre;
+    const int shift_double = shift * 2;
+
+    flip = masked_o & (p_board << shift);
+    flip |= masked_o & (flip << shift);
+    pre = masked_o & (masked_o << shift);
+    flip |= pre & (flip << shift_double);
+    flip |= pre & (flip << shift_double);
+    mobility = flip << shift;
+    flip = masked_o & (p_board >> shift);
+    flip |= masked_o & (flip >> shift);
+    pre = masked_o & (masked_o >> shift);
+    flip |= pre & (flip >> shift_double);
+    flip |= pre & (flip >> shift_double);
+    mobility |= flip >> shift;
+    return mobility;
+}
+
+// Calculates legal moves for a player p_board against an opponent o_board.
+static inline RevBitboard calcMobility(RevBitboard p_board, RevBitboard o_board) {
+    RevBitboard mobility;
+    const RevBitboard masked_o = o_board & 0x7e7e7e7e7e7e7e7e;
+
+    mobility = getMobilityOneDirection(p_board, masked_o, 1);  // horizontal
+    mobility |= getMobilityOneDirection(p_board, o_board, 8);  // vertical
+    mobility |= getMobilityOneDirection(p_board, masked_o, 7);  // diagonal
+    mobility |= getMobilityOneDirection(p_board, masked_o, 9);
+    return mobility & ~(p_board | o_board);
+}
+
+static inline RevBitboard flipDisksOneDirection(int pos,
+                                                RevBitboard p_board, RevBitboard o_board,
+                                                RevBitboard masked_o,
+                                                RevBitboard mask_r, RevBitboard mask_l) {
+    RevBitboard outflank, flipped;
+    RevBitboard mask = mask_r >> (63 - pos);
+    outflank = (0x8000000000000000 >> countFirstZeros(~masked_o & mask)) & p_board;
+    flipped  = (-outflank * 2) & mask;
+
+    mask = mask_l << pos;
+    outflank = mask & ((masked_o | ~mask) + 1) & p_board;
+    flipped |= (outflank - (RevBitboard)(outflank != 0)) & mask;
+    return flipped;
+}
+
+// Calculates disks that will be flipped when p_board puts a disk at pos.
+static inline RevBitboard calcFlipped(RevBitboard p_board, RevBitboard o_board, int pos) {
+    RevBitboard flipped;
+    RevBitboard masked_o = o_board & 0x7e7e7e7e7e7e7e7e;
+    flipped = flipDisksOneDirection(pos, p_board, o_board, o_board,
+                                    0x0080808080808080, 0x0101010101010100);  // horizontal
+    flipped |= flipDisksOneDirection(pos, p_board, o_board, masked_o,
+                                     0x7f00000000000000, 0x00000000000000fe);  // vertical
+    flipped |= flipDisksOneDirection(pos, p_board, o_board, masked_o,
+                                     0x0102040810204000, 0x0002040810204080);  // diagonal
+    flipped |= flipDisksOneDirection(pos, p_board, o_board, masked_o,
+                                     0x0040201008040201, 0x8040201008040200);
+    return flipped;
+}
+
+// Swaps the bits of mask with the bits delta above them.
+static inline RevBitboard deltaSwap(RevBitboard b, RevBitboard mask, int delta) {
+    const RevBitboard t = (b ^ (b >> delta)) & mask;
+    return b ^ t ^ (t << delta);
+}
+
+// Symmetries of the board. Each of them is its own inverse.
+static inline RevBitboard flipVertical(RevBitboard b) {
+    b = deltaSwap(b, 0x00ff00ff00ff00ff, 8);
+    b = deltaSwap(b, 0x0000ffff0000ffff, 16);
+    return (b >> 32) | (b << 32);
+}
+
+static inline RevBitboard mirrorHorizontal(RevBitboard b) {
+    b = deltaSwap(b, 0x5555555555555555, 1);
+    b = deltaSwap(b, 0x3333333333333333, 2);
+    return deltaSwap(b, 0x0f0f0f0f0f0f0f0f, 4);
+}
+
+static inline RevBitboard flipDiagonal(RevBitboard b) {
+    b = deltaSwap(b, 0x00aa00aa00aa00aa, 7);
+    b = deltaSwap(b, 0x0000cccc0000cccc, 14);
+    return deltaSwap(b, 0x00000000f0f0f0f0, 28);
+}
+
+#endif  // __REVERSI_SRC_INTERNAL_H__
@@ -0,0 +1,253 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "reversi.h"
+#include "internal.h"
+#include "latency.h"
+
+// Log-linear buckets like HdrHistogram. Values below 2^LATENCY_SUB_BITS ns have their own
+// buckets. Each larger power of 2 is split into 2^LATENCY_SUB_BITS buckets, so a bucket is
+// within 1 / 32 of its values. Values are capped at 2^(LATENCY_MAX_BIT + 1) - 1 ns,
+// which is about 36 minutes.
+#define LATENCY_SUB_BITS 5
+#define LATENCY_SUB_COUNT (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_BIT 40
+#define LATENCY_MAX_NS (((uint64_t)2 << LATENCY_MAX_BIT) - 1)
+#define LATENCY_BUCKETS ((LATENCY_MAX_BIT - LATENCY_SUB_BITS + 2) << LATENCY_SUB_BITS)
+
+// Only the owner thread writes a histogram. Readers and resets use relaxed atomics,
+// so they see each counter as a whole, but maybe not all counters of the same moment.
+typedef struct LatencyHistogram {
+    uint64_t buckets[LATENCY_BUCKETS];
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t min_ns_plus_one;  // Zero if empty
+} LatencyHistogram;
+
+typedef struct LatencyBlock {
+    struct LatencyBlock *next;  // Blocks are never freed, so readers walk the list freely.
+    int in_use;  // TRUE while a thread owns the block
+    LatencyHistogram *histograms[REV_LATENCY_API_COUNT];  // Allocated on the first record
+} LatencyBlock;
+
+// States of block_key
+#define KEY_NONE 0
+#define KEY_CREATING 1
+#define KEY_READY 2
+#define KEY_FAILED 3
+
+int latency_enabled = 0;
+static LatencyBlock *latency_blocks = NULL;
+static THREAD_LOCAL LatencyBlock *thread_block = NULL;
+static ThreadKey block_key;  // Releases the block of a thread when it exits.
+static int block_key_state = KEY_NONE;
+
+static const char *const latency_names[REV_LATENCY_API_COUNT] = {
+    "search", "search_mcts", "gen_move_monte_carlo", "analyze_batch", "arena_move",
+};
+
+static inline int bucketOfValue(uint64_t ns) {
+    if (ns < LATENCY_SUB_COUNT) return (int)ns;
+    if (ns > LATENCY_MAX_NS) ns = LATENCY_MAX_NS;
+    const int shift = 63 - countFirstZeros(ns) - LATENCY_SUB_BITS;
+    return ((shift + 1) << LATENCY_SUB_BITS) + (int)((ns >> shift) - LATENCY_SUB_COUNT);
+}
+
+// Returns the largest value in a bucket.
+static uint64_t maxValueOfBucket(int bucket) {
+    if (bucket < LATENCY_SUB_COUNT) return (uint64_t)bucket;
+    const int shift = (bucket >> LATENCY_SUB_BITS) - 1;
+    const uint64_t sub = (uint64_t)(bucket & (LATENCY_SUB_COUNT - 1));
+    return ((LATENCY_SUB_COUNT + sub) << shift) + (((uint64_t)1 << shift) - 1);
+}
+
+// Lets another thread reuse the block. It's called when the owner thread exits.
+static void THREAD_KEY_CALL releaseBlock(void *value) {
+    LatencyBlock *block = (LatencyBlock *)value;
+    if (block == thread_block)
+        thread_block = NULL;
+    atomicCompareExchangeInt(&block->in_use, 1, 0);
+}
+
+// Creates block_key on the first call. Returns FALSE if it's unavailable.
+// Blocks of exiting threads are leaked then.
+// Exchanges are full barriers, so block_key is visible once the state is KEY_READY.
+static int initBlockKey(void) {
+    if (atomicCompareExchangeInt(&block_key_state, KEY_NONE, KEY_CREATING)) {
+        const int state = (threadKeyCreate(&block_key, releaseBlock) == 0) ? KEY_READY :
+                                                                             KEY_FAILED;
+        atomicCompareExchangeInt(&block_key_state, KEY_CREATING, state);
+    }
+    // Another thread may be creating it. It happens once, and it's quick.
+    while (atomicCompareExchangeInt(&block_key_state, KEY_CREATING, KEY_CREATING)) {}
+    return atomicCompareExchangeInt(&block_key_state, KEY_READY, KEY_READY);
+}
+
+// Takes a released block, or adds a new one to the list.
+// The block goes back to the list when the calling thread exits.
+static LatencyBlock *claimBlock(void) {
+    const int has_key = initBlockKey();
+    LatencyBlock *block = (LatencyBlock *)atomicLoadPtr((void **)&latency_blocks);
+    for (; block != NULL; block = block->next) {
+        if (!atomicLoadInt(&block->in_use) && atomicCompareExchangeInt(&block->in_use, 0, 1))
+            break;
+    }
+    if (block == NULL) {
+        block = (LatencyBlock *)calloc(1, sizeof(LatencyBlock));
+        if (block == NULL) return NULL;
+        block->in_use = 1;
+        do {
+            block->next = (LatencyBlock *)atomicLoadPtr((void **)&latency_blocks);
+        } while (!atomicCompareExchangePtr((void **)&latency_blocks, block->next, block));
+    }
+    if (has_key)
+        threadKeySet(block_key, block);
+    return block;
+}
+
+void latencyEnd(RevLatencyApi api, uint64_t start) {
+    if (start == 0) return;
+    const uint64_t ns = getTimeNs() - start;
+    if (thread_block == NULL) {
+        thread_block = claimBlock();
+        if (thread_block == NULL) return;
+    }
+    LatencyHistogram *histogram = thread_block->histograms[api];
+    if (histogram == NULL) {
+        histogram = (LatencyHistogram *)calloc(1, sizeof(LatencyHistogram));
+        if (histogram == NULL) return;
+        atomicStorePtr((void **)&thread_block->histograms[api], histogram);
+    }
+    uint64_t *bucket = &histogram->buckets[bucketOfValue(ns)];
+    atomicStoreU64(bucket, atomicLoadU64(bucket) + 1);
+    atomicStoreU64(&histogram->sum_ns, atomicLoadU64(&histogram->sum_ns) + ns);
+    if (ns > atomicLoadU64(&histogram->max_ns))
+        atomicStoreU64(&histogram->max_ns, ns);
+    const uint64_t min_plus_one = atomicLoadU64(&histogram->min_ns_plus_one);
+    if (min_plus_one == 0 || ns + 1 < min_plus_one)
+        atomicStoreU64(&histogram->min_ns_plus_one, ns + 1);
+}
+
+void revSetLatencyRecording(int enabled) {
+    atomicStoreInt(&latency_enabled, enabled != 0);
+}
+
+void revResetLatencyStats(void) {
+    LatencyBlock *block = (LatencyBlock *)atomicLoadPtr((void **)&latency_blocks);
+    for (; block != NULL; block = block->next) {
+        for (int api = 0; api < REV_LATENCY_API_COUNT; api++) {
+            LatencyHistogram *histogram =
+                (LatencyHistogram *)atomicLoadPtr((void **)&block->histograms[api]);
+            if (histogram == NULL) continue;
+            for (int i = 0; i < LATENCY_BUCKETS; i++)
+                atomicStoreU64(&histogram->buckets[i], 0);
+            atomicStoreU64(&histogram->sum_ns, 0);
+            atomicStoreU64(&histogram->max_ns, 0);
+            atomicStoreU64(&histogram->min_ns_plus_one, 0);
+        }
+    }
+}
+
+// Returns the smallest value that rank values are less than or equal to.
+static uint64_t valueAtRank(const uint64_t *buckets, uint64_t rank, uint64_t max_ns) {
+    uint64_t total = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        total += buckets[i];
+        if (total >= rank) {
+            const uint64_t value = maxValueOfBucket(i);
+            return (value < max_ns) ? value : max_ns;
+        }
+    }
+    return max_ns;
+}
+
+void revGetLatencyStats(RevLatencyApi api, RevLatencyStats *stats) {
+    memset(stats, 0, sizeof(RevLatencyStats));
+    if (api >= REV_LATENCY_API_COUNT) return;
+    uint64_t *buckets = (uint64_t *)calloc(LATENCY_BUCKETS, sizeof(uint64_t));
+    if (buckets == NULL) return;
+    uint64_t sum_ns = 0;
+    uint64_t min_ns_plus_one = 0;
+    LatencyBlock *block = (LatencyBlock *)atomicLoadPtr((void **)&latency_blocks);
+    for (; block != NULL; block = block->next) {
+        LatencyHistogram *histogram =
+            (LatencyHistogram *)atomicLoadPtr((void **)&block->histograms[api]);
+        if (histogram == NULL) continue;
+        for (int i = 0; i < LATENCY_BUCKETS; i++)
+            buckets[i] += atomicLoadU64(&histogram->buckets[i]);
+        sum_ns += atomicLoadU64(&histogram->sum_ns);
+        const uint64_t max_ns = atomicLoadU64(&histogram->max_ns);
+        if (max_ns > stats->max_ns) stats->max_ns = max_ns;
+        const uint64_t min_plus_one = atomicLoadU64(&histogram->min_ns_plus_one);
+        if (min_plus_one != 0 && (min_ns_plus_one == 0 || min_plus_one < min_ns_plus_one))
+            min_ns_plus_one = min_plus_one;
+    }
+    // Count buckets instead of keeping a counter, so that percentiles agree with the count.
+    for (int i = 0; i < LATENCY_BUCKETS; i++)
+        stats->count += buckets[i];
+    if (stats->count > 0) {
+        const uint64_t count = stats->count;
+        stats->min_ns = (min_ns_plus_one > 0) ? min_ns_plus_one - 1 : 0;
+        stats->mean_ns = sum_ns / count;
+        // Rank of percentile p is ceil(count * p).
+        stats->p50_ns = valueAtRank(buckets, (count * 500 + 999) / 1000, stats->max_ns);
+        stats->p90_ns = valueAtRank(buckets, (count * 900 + 999) / 1000, stats->max_ns);
+        stats->p99_ns = valueAtRank(buckets, (count * 990 + 999) / 1000, stats->max_ns);
+        stats->p999_ns = valueAtRank(buckets, (count * 999 + 999) / 1000, stats->max_ns);
+    }
+    free(buckets);
+}
+
+const char *revGetLatencyApiName(RevLatencyApi api) {
+    return (api < REV_LATENCY_API_COUNT) ? latency_names[api] : NULL;
+}
+
+// Appends formatted text like snprintf(), and keeps the length that the whole text needs.
+static void appendText(char *buffer, int size, int *length, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    const int offset = (*length < size) ? *length : size;
+    char *dst = (buffer != NULL) ? buffer + offset : NULL;
+    const int written = vsnprintf(dst, (size_t)(size - offset), format, args);
+    va_end(args);
+    if (written > 0) *length += written;
+}
+
+int revFormatLatencyStats(char *buffer, int size, int format) {
+    if (buffer == NULL || size < 0) size = 0;
+    if (size == 0) buffer = NULL;
+    int length = 0;
+    if (format == REV_LATENCY_JSON) {
+        appendText(buffer, size, &length, "{");
+    } else {
+        appendText(buffer, size, &length, "%-20s %10s %10s %10s %10s %10s %10s %10s %10s\n",
+                   "api", "count", "min(us)", "mean(us)", "p50(us)", "p90(us)", "p99(us)",
+                   "p999(us)", "max(us)");
+    }
+    for (int api = 0; api < REV_LATENCY_API_COUNT; api++) {
+        RevLatencyStats s;
+        revGetLatencyStats((RevLatencyApi)api, &s);
+        if (format == REV_LATENCY_JSON) {
+            // All APIs are listed, so that the schema doesn't depend on what was called.
+            appendText(buffer, size, &length,
+                       "%s\"%s\":{\"count\":%llu,\"min_ns\":%llu,\"mean_ns\":%llu,"
+                       "\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,"
+                       "\"max_ns\":%llu}",
+                       (api > 0) ? "," : "", latency_names[api], (unsigned long long)s.count,
+                       (unsigned long long)s.min_ns, (unsigned long long)s.mean_ns,
+                       (unsigned long long)s.p50_ns, (unsigned long long)s.p90_ns,
+                       (unsigned long long)s.p99_ns, (unsigned long long)s.p999_ns,
+                       (unsigned long long)s.max_ns);
+        } else if (s.count > 0) {
+            appendText(buffer, size, &length,
+                       "%-20s %10llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                       latency_names[api], (unsigned long long)s.count, s.min_ns / 1000.0,
+                       s.mean_ns / 1000.0, s.p50_ns / 1000.0, s.p90_ns / 1000.0,
+                       s.p99_ns / 1000.0, s.p999_ns / 1000.0, s.max_ns / 1000.0);
+        }
+    }
+    if (format == REV_LATENCY_JSON)
+        appendText(buffer, size, &length, "}");
+    return length;
+}
@@ -0,0 +1,26 @@
+#ifndef __REVERSI_SRC_LATENCY_H__
+#define __REVERSI_SRC_LATENCY_H__
+#include "reversi.h"
+#include "thread.h"
+#include "timer.h"
+
+// Latency histograms of API calls. Each thread records into its own histograms
+// without locks, and readers add up the histograms of all threads.
+//
+// Usage:
+//     const uint64_t start = latencyStart();
+//     ...
+//     latencyEnd(REV_LATENCY_SEARCH, start);
+
+// TRUE while revSetLatencyRecording() is on.
+extern int latency_enabled;
+
+// Returns the current time in nanoseconds, or zero when recording is off.
+static inline uint64_t latencyStart(void) {
+    return atomicLoadInt(&latency_enabled) ? getTimeNs() : 0;
+}
+
+// Records the time since latencyStart(). It does nothing when start is zero.
+void latencyEnd(RevLatencyApi api, uint64_t start);
+
+#endif  // __REVERSI_SRC_LATENCY_H__
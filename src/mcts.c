@@ -0,0 +1,592 @@
+#include <math.h>
+#include <string.h>
+#include "latency.h"
+#include "mcts.h"
+#include "rng.h"
+#include "timer.h"
+
+// Weight of the exploration term of UCT.
+#define MCTS_EXPLORATION 0.7f
+
+// Size of the temporary tree for revSearch().
+#define DEFAULT_MCTS_MB 16
+
+// Visits that a pending evaluation counts as. It keeps other descents of a batch
+// away from the same path.
+#define MCTS_VIRTUAL_LOSS 1
+
+// The clock is checked once per this many playouts.
+#define MCTS_CHECK_INTERVAL 64
+
+RevMcts *revNewMcts(int size_mb) {
+    RevMcts *mcts = (RevMcts *)malloc(sizeof(RevMcts));
+    if (mcts == NULL) return NULL;
+
+    // Each node needs 1 bit of live and 1/16 byte of live_rank for compaction.
+    const uint64_t bytes = (uint64_t)(size_mb > 0 ? size_mb : 1) << 20;
+    uint64_t capacity = bytes * 64 / (sizeof(MctsNode) * 64 + 8 + 4);
+    if (capacity > 0xfffffff0) capacity = 0xfffffff0;
+    const size_t words = (size_t)((capacity + 63) / 64);
+    mcts->rave_equivalence = 0;
+    mcts->evaluate = NULL;
+    mcts->evaluate_data = NULL;
+    mcts->batch_size = 0;
+    mcts->batch = NULL;
+    mcts->positions = NULL;
+    mcts->values = NULL;
+    mcts->nodes = (MctsNode *)malloc(sizeof(MctsNode) * (size_t)capacity);
+    mcts->live = (uint64_t *)malloc(sizeof(uint64_t) * words);
+    mcts->live_rank = (uint32_t *)malloc(sizeof(uint32_t) * words);
+    if (mcts->nodes == NULL || mcts->live == NULL || mcts->live_rank == NULL) {
+        revFreeMcts(mcts);
+        return NULL;
+    }
+    mcts->capacity = (uint32_t)capacity;
+    mcts->count = 0;
+    mcts->root_player = DISK_BLACK;
+    return mcts;
+}
+
+void revFreeMcts(RevMcts *mcts) {
+    free(mcts->nodes);
+    free(mcts->live);
+    free(mcts->live_rank);
+    free(mcts->batch);
+    free(mcts->positions);
+    free(mcts->values);
+    free(mcts);
+}
+
+int revSetMctsEvaluator(RevMcts *mcts, RevMctsEvaluator evaluate, int batch_size,
+                        void *user_data) {
+    free(mcts->batch);
+    free(mcts->positions);
+    free(mcts->values);
+    mcts->evaluate = NULL;
+    mcts->evaluate_data = NULL;
+    mcts->batch_size = 0;
+    mcts->batch = NULL;
+    mcts->positions = NULL;
+    mcts->values = NULL;
+    if (evaluate == NULL) return 1;
+
+    if (batch_size < 1) batch_size = 1;
+    if (batch_size > REV_MCTS_MAX_BATCH) batch_size = REV_MCTS_MAX_BATCH;
+    mcts->batch = (MctsBatchItem *)malloc(sizeof(MctsBatchItem) * (size_t)batch_size);
+    mcts->positions = (RevPosition *)malloc(sizeof(RevPosition) * (size_t)batch_size);
+    mcts->values = (float *)malloc(sizeof(float) * (size_t)batch_size);
+    if (mcts->batch == NULL || mcts->positions == NULL || mcts->values == NULL) {
+        revSetMctsEvaluator(mcts, NULL, 0, NULL);
+        return 0;
+    }
+    mcts->evaluate = evaluate;
+    mcts->evaluate_data = user_data;
+    mcts->batch_size = batch_size;
+    return 1;
+}
+
+void revSetMctsRave(RevMcts *mcts, float equivalence) {
+    mcts->rave_equivalence = (equivalence > 0) ? equivalence : 0;
+}
+
+void revClearMcts(RevMcts *mcts) {
+    mcts->count = 0;
+}
+
+static void initNode(MctsNode *node, RevBitboard p_board, RevBitboard o_board, int move) {
+    node->p_board = p_board;
+    node->o_board = o_board;
+    node->children = MCTS_NO_CHILDREN;
+    node->visits = 0;
+    node->wins = 0;
+    node->child_count = 0;
+    node->move = (uint8_t)move;
+    node->pending = 0;
+    node->amaf_visits = 0;
+    node->amaf_wins = 0;
+}
+
+static inline int isLive(const RevMcts *mcts, uint32_t i) {
+    return (int)((mcts->live[i / 64] >> (i % 64)) & 1);
+}
+
+// Returns the index of a live node after compaction.
+static inline uint32_t getLiveRank(const RevMcts *mcts, uint32_t i) {
+    const uint64_t lower = mcts->live[i / 64] & (((uint64_t)1 << (i % 64)) - 1);
+    return mcts->live_rank[i / 64] + (uint32_t)countOnes(lower);
+}
+
+// Makes nodes[root] the new root and slides the subtree down to the start of the array.
+// Other nodes are freed.
+static void compactTree(RevMcts *mcts, uint32_t root) {
+    const uint32_t words = (mcts->count + 63) / 64;
+    memset(mcts->live, 0, sizeof(uint64_t) * words);
+
+    // Parents come before children, so one pass marks the whole subtree.
+    mcts->live[root / 64] |= (uint64_t)1 << (root % 64);
+    for (uint32_t i = root; i < mcts->count; i++) {
+        const MctsNode *node = &mcts->nodes[i];
+        if (!isLive(mcts, i) || node->children == MCTS_NO_CHILDREN) continue;
+        for (uint32_t c = node->children; c < node->children + node->child_count; c++)
+            mcts->live[c / 64] |= (uint64_t)1 << (c % 64);
+    }
+
+    uint32_t total = 0;
+    for (uint32_t w = 0; w < words; w++) {
+        mcts->live_rank[w] = total;
+        total += (uint32_t)countOnes(mcts->live[w]);
+    }
+
+    // A node never moves up, so it doesn't overwrite nodes that haven't moved yet.
+    for (uint32_t i = root; i < mcts->count; i++) {
+        if (!isLive(mcts, i)) continue;
+        MctsNode node = mcts->nodes[i];
+        if (node.children != MCTS_NO_CHILDREN && node.child_count > 0)
+            node.children = getLiveRank(mcts, node.children);
+        mcts->nodes[getLiveRank(mcts, i)] = node;
+    }
+    mcts->count = total;
+}
+
+static void setRoot(RevMcts *mcts, RevBitboard p_board, RevBitboard o_board,
+                    RevDiskType player) {
+    initNode(&mcts->nodes[0], p_board, o_board, MCTS_PASS);
+    mcts->count = 1;
+    mcts->root_player = player;
+}
+
+static int isSameNode(const MctsNode *node, RevBitboard p_board, RevBitboard o_board) {
+    return node->p_board == p_board && node->o_board == o_board;
+}
+
+// Keeps the subtree of the board if the tree has it within two plies.
+static void prepareRoot(RevMcts *mcts, RevBoard *board) {
+    const RevDiskType player = board->current_player;
+    const RevBitboard p_board = board->bitboards[player];
+    const RevBitboard o_board = board->bitboards[!player];
+    if (mcts->count > 0) {
+        const MctsNode *nodes = mcts->nodes;
+        if (mcts->root_player == player && isSameNode(&nodes[0], p_board, o_board))
+            return;
+        if (nodes[0].children != MCTS_NO_CHILDREN) {
+            for (uint32_t c = nodes[0].children; c < nodes[0].children + nodes[0].child_count;
+                 c++) {
+                if (mcts->root_player != player && isSameNode(&nodes[c], p_board, o_board)) {
+                    compactTree(mcts, c);
+                    mcts->root_player = player;
+                    return;
+                }
+                if (mcts->root_player != player || nodes[c].children == MCTS_NO_CHILDREN)
+                    continue;
+                for (uint32_t g = nodes[c].children; g < nodes[c].children + nodes[c].child_count;
+                     g++) {
+                    if (isSameNode(&nodes[g], p_board, o_board)) {
+                        compactTree(mcts, g);
+                        return;
+                    }
+                }
+            }
+        }
+    }
+    setRoot(mcts, p_board, o_board, player);
+}
+
+int revMctsAdvance(RevMcts *mcts, int move) {
+    if (mcts->count == 0) return 0;
+    const MctsNode *root = &mcts->nodes[0];
+    const int node_move = (move < 0) ? MCTS_PASS : move;
+    if (root->children != MCTS_NO_CHILDREN) {
+        for (uint32_t c = root->children; c < root->children + root->child_count; c++) {
+            if (mcts->nodes[c].move == node_move) {
+                compactTree(mcts, c);
+                mcts->root_player = !mcts->root_player;
+                return 1;
+            }
+        }
+    }
+    mcts->count = 0;
+    return 0;
+}
+
+int revMctsGetRootVisits(RevMcts *mcts) {
+    return (mcts->count > 0) ? (int)mcts->nodes[0].visits : 0;
+}
+
+// Adds children to a node. Returns FALSE when the tree is full.
+static int expandNode(RevMcts *mcts, uint32_t index) {
+    MctsNode *node = &mcts->nodes[index];
+    const RevBitboard p_board = node->p_board;
+    const RevBitboard o_board = node->o_board;
+    const RevBitboard moves = calcMobility(p_board, o_board);
+    int count = countOnes(moves);
+    if (count == 0 && calcMobility(o_board, p_board) != 0)
+        count = 1;  // Pass
+    if (mcts->count + (uint32_t)count > mcts->capacity) return 0;
+
+    MctsNode *child = &mcts->nodes[mcts->count];
+    node->children = mcts->count;
+    node->child_count = (uint8_t)count;
+    mcts->count += (uint32_t)count;
+    if (moves == 0) {
+        if (count > 0)
+            initNode(child, o_board, p_board, MCTS_PASS);
+        return 1;
+    }
+    for (RevBitboard m = moves; m; m &= m - 1, child++) {
+        const int pos = firstOnePos(m);
+        const RevBitboard flipped = calcFlipped(p_board, o_board, pos);
+        initNode(child, o_board ^ flipped, p_board ^ flipped ^ ((RevBitboard)1 << pos), pos);
+    }
+    return 1;
+}
+
+static inline uint32_t getVirtualVisits(const MctsNode *node) {
+    return node->visits + MCTS_VIRTUAL_LOSS * (uint32_t)node->pending;
+}
+
+// Returns the child with the highest UCT value. Unvisited children come first.
+// Pending evaluations count as losses.
+// With RAVE, the win rate is blended with the AMAF win rate by beta = sqrt(k / (3n + k)),
+// where n is the visits of the child and k is the equivalence. The AMAF value dominates
+// while n is small, and both have the same weight at n = k.
+static uint32_t selectChild(const RevMcts *mcts, const MctsNode *node) {
+    const float log_visits = logf((float)getVirtualVisits(node));
+    const float k = mcts->rave_equivalence;
+    uint32_t best = node->children;
+    float best_value = -1.0f;
+    for (uint32_t c = node->children; c < node->children + node->child_count; c++) {
+        const MctsNode *child = &mcts->nodes[c];
+        const uint32_t visits = getVirtualVisits(child);
+        if (visits == 0) return c;
+        float win_rate = child->wins / (float)visits;
+        if (k > 0 && child->amaf_visits > 0) {
+            const float beta = sqrtf(k / (3.0f * (float)visits + k));
+            win_rate += beta * (child->amaf_wins / (float)child->amaf_visits - win_rate);
+        }
+        const float value = win_rate + MCTS_EXPLORATION * sqrtf(log_visits / (float)visits);
+        if (value > best_value) {
+            best_value = value;
+            best = c;
+        }
+    }
+    return best;
+}
+
+// Selects a leaf from the root, and expands nodes on the way. Returns the path length.
+static int selectLeaf(RevMcts *mcts, uint32_t *path) {
+    int length = 0;
+    uint32_t index = 0;
+    path[length++] = index;
+    for (;;) {
+        const MctsNode *node = &mcts->nodes[index];
+        if (node->children == MCTS_NO_CHILDREN) {
+            // Leaves get children on the second visit, so most leaves never need them.
+            if (node->visits == 0 && index != 0) break;
+            if (!expandNode(mcts, index)) break;
+        }
+        if (node->child_count == 0) break;
+        index = selectChild(mcts, node);
+        path[length++] = index;
+    }
+    return length;
+}
+
+// Updates nodes on the path. reward is for the player who moved to the leaf.
+static void backUp(RevMcts *mcts, const uint32_t *path, int length, float reward) {
+    for (int i = length - 1; i >= 0; i--) {
+        MctsNode *node = &mcts->nodes[path[i]];
+        node->visits++;
+        node->wins += reward;
+        reward = 1.0f - reward;
+    }
+}
+
+// Same as playout() but it also returns squares that each player played.
+// p_moves are the moves of the player to move at the start.
+static int playoutWithMoves(Rng *rng, RevBitboard p_board, RevBitboard o_board,
+                            RevBitboard *p_moves, RevBitboard *o_moves) {
+    RevBitboard moves_by[2] = { 0, 0 };
+    int side = 0;
+    int passed = 0;
+    for (;;) {
+        RevBitboard moves = calcMobility(p_board, o_board);
+        if (moves == 0) {
+            if (passed) break;
+            passed = 1;
+        } else {
+            passed = 0;
+            for (int n = rngBounded(rng, countOnes(moves)); n > 0; n--)
+                moves &= moves - 1;
+            const int pos = firstOnePos(moves);
+            const RevBitboard flipped = calcFlipped(p_board, o_board, pos);
+            p_board ^= flipped | ((RevBitboard)1 << pos);
+            o_board ^= flipped;
+            moves_by[side] |= (RevBitboard)1 << pos;
+        }
+        const RevBitboard tmp = p_board;
+        p_board = o_board;
+        o_board = tmp;
+        side ^= 1;
+    }
+    *p_moves = moves_by[0];
+    *o_moves = moves_by[1];
+    const int diff = countOnes(p_board) - countOnes(o_board);
+    return side ? -diff : diff;
+}
+
+// Updates AMAF statistics of children of nodes on the path.
+// reward is for the player who moved to the leaf. leaf_moves are squares played after the
+// leaf by its player to move, and other_moves are the ones by the other player.
+// A square is played only once in a game, and squares played before a node are not its
+// moves. So the moves of the whole simulation can be checked against any node.
+static void updateAmaf(RevMcts *mcts, const uint32_t *path, int length, float reward,
+                       RevBitboard leaf_moves, RevBitboard other_moves) {
+    // played[i & 1] are the squares played by the player to move at path[i].
+    RevBitboard played[2];
+    played[(length - 1) & 1] = leaf_moves;
+    played[length & 1] = other_moves;
+    for (int i = 1; i < length; i++) {
+        const int move = mcts->nodes[path[i]].move;
+        if (move != MCTS_PASS)
+            played[(i - 1) & 1] |= (RevBitboard)1 << move;
+    }
+    for (int i = length - 1; i >= 0; i--) {
+        // Children of path[i] are moved to by the other player of the one who moved to it.
+        reward = 1.0f - reward;
+        const MctsNode *node = &mcts->nodes[path[i]];
+        if (node->children == MCTS_NO_CHILDREN) continue;
+        for (uint32_t c = node->children; c < node->children + node->child_count; c++) {
+            MctsNode *child = &mcts->nodes[c];
+            if (child->move != MCTS_PASS && ((played[i & 1] >> child->move) & 1)) {
+                child->amaf_visits++;
+                child->amaf_wins += reward;
+            }
+        }
+    }
+}
+
+// Selects a leaf, expands it, plays a game from it, and updates nodes on the path.
+static void runPlayout(RevMcts *mcts, Rng *rng) {
+    uint32_t path[MCTS_MAX_PATH];
+    const int length = selectLeaf(mcts, path);
+    const MctsNode *leaf = &mcts->nodes[path[length - 1]];
+    if (mcts->rave_equivalence > 0) {
+        RevBitboard leaf_moves, other_moves;
+        const int diff = playoutWithMoves(rng, leaf->p_board, leaf->o_board,
+                                          &leaf_moves, &other_moves);
+        const float reward = (diff < 0) ? 1.0f : (diff > 0) ? 0.0f : 0.5f;
+        backUp(mcts, path, length, reward);
+        updateAmaf(mcts, path, length, reward, leaf_moves, other_moves);
+        return;
+    }
+    const int diff = playout(rng, leaf->p_board, leaf->o_board);
+    // The reward for the player who moved to the leaf.
+    backUp(mcts, path, length, (diff < 0) ? 1.0f : (diff > 0) ? 0.0f : 0.5f);
+}
+
+static void addPending(RevMcts *mcts, const uint32_t *path, int length, int delta) {
+    for (int i = 0; i < length; i++)
+        mcts->nodes[path[i]].pending = (uint16_t)(mcts->nodes[path[i]].pending + delta);
+}
+
+// Collects up to max_leaves leaves, evaluates them with one call of the evaluator,
+// and updates the tree. Returns the number of leaves.
+static int runBatch(RevMcts *mcts, int max_leaves) {
+    int count = 0;
+    int slots = 0;
+    // A leaf that is already in the batch is a collision. Its path is dropped.
+    // Virtual losses make them rare, but they can't be avoided in small trees.
+    // The first leaf never collides, so at least one leaf is evaluated.
+    for (int collisions = 0; count < max_leaves && collisions < max_leaves;) {
+        MctsBatchItem *item = &mcts->batch[count];
+        item->length = selectLeaf(mcts, item->path);
+        const MctsNode *leaf = &mcts->nodes[item->path[item->length - 1]];
+        const RevBitboard p_board = leaf->p_board;
+        const RevBitboard o_board = leaf->o_board;
+        const int game_over = (leaf->children != MCTS_NO_CHILDREN && leaf->child_count == 0) ||
+                              (calcMobility(p_board, o_board) == 0 &&
+                               calcMobility(o_board, p_board) == 0);
+        if (game_over) {
+            // Finished games don't need the evaluator.
+            const int diff = countOnes(p_board) - countOnes(o_board);
+            item->slot = -1;
+            item->value = (diff > 0) ? 1.0f : (diff < 0) ? 0.0f : 0.5f;
+        } else if (leaf->pending > 0) {
+            collisions++;
+            continue;
+        } else {
+            item->slot = slots;
+            mcts->positions[slots].player = p_board;
+            mcts->positions[slots].opponent = o_board;
+            slots++;
+        }
+        addPending(mcts, item->path, item->length, 1);
+        count++;
+    }
+
+    if (slots > 0)
+        mcts->evaluate(mcts->positions, slots, mcts->values, mcts->evaluate_data);
+    for (int i = 0; i < count; i++) {
+        MctsBatchItem *item = &mcts->batch[i];
+        float value = (item->slot >= 0) ? mcts->values[item->slot] : item->value;
+        if (!(value >= 0.0f)) value = 0.0f;  // Also catches NaN.
+        if (value > 1.0f) value = 1.0f;
+        addPending(mcts, item->path, item->length, -1);
+        backUp(mcts, item->path, item->length, 1.0f - value);
+        // Only moves in the tree are known without playouts.
+        if (mcts->rave_equivalence > 0)
+            updateAmaf(mcts, item->path, item->length, 1.0f - value, 0, 0);
+    }
+    return count;
+}
+
+// Returns TRUE if a is a better move than b. The most visited move is the most reliable.
+static int isMoreVisited(const MctsNode *a, const MctsNode *b) {
+    return a->visits > b->visits || (a->visits == b->visits && a->wins > b->wins);
+}
+
+// Follows the most visited children from a node.
+static void extractPv(const RevMcts *mcts, const MctsNode *node, RevPvLine *line) {
+    line->length = 0;
+    for (;;) {
+        line->pv[line->length++] = (node->move == MCTS_PASS) ? -1 : node->move;
+        if (line->length == REV_MAX_PV_LENGTH || node->children == MCTS_NO_CHILDREN ||
+            node->child_count == 0)
+            break;
+        const MctsNode *best = &mcts->nodes[node->children];
+        for (uint32_t c = node->children + 1; c < node->children + node->child_count; c++) {
+            if (isMoreVisited(&mcts->nodes[c], best)) best = &mcts->nodes[c];
+        }
+        if (best->visits == 0) break;
+        node = best;
+    }
+}
+
+// Calls info_callback with the most visited moves of the root.
+static void reportProgress(const RevMcts *mcts, const RevSearchParams *params,
+                           uint64_t playouts, uint64_t start_time, uint64_t now) {
+    const MctsNode *root = &mcts->nodes[0];
+    if (root->children == MCTS_NO_CHILDREN || root->child_count == 0) return;
+
+    // Insertion sort of the top children.
+    int max_lines = (params->multi_pv > 1) ? params->multi_pv : 1;
+    if (max_lines > REV_MAX_MULTI_PV) max_lines = REV_MAX_MULTI_PV;
+    const MctsNode *top[REV_MAX_MULTI_PV];
+    int count = 0;
+    for (uint32_t c = root->children; c < root->children + root->child_count; c++) {
+        const MctsNode *child = &mcts->nodes[c];
+        if (count == max_lines && !isMoreVisited(child, top[count - 1])) continue;
+        int i = (count < max_lines) ? count++ : count - 1;
+        for (; i > 0 && isMoreVisited(child, top[i - 1]); i--) top[i] = top[i - 1];
+        top[i] = child;
+    }
+
+    RevSearchInfo info;
+    info.nodes = mcts->count;
+    info.playouts = playouts;
+    info.elapsed_ms = (int)(now - start_time);
+    info.speed = playouts * 1000 / (uint64_t)(info.elapsed_ms > 0 ? info.elapsed_ms : 1);
+    info.line_count = count;
+    for (int i = 0; i < count; i++) {
+        info.lines[i].score = (top[i]->visits > 0) ?
+                              (int)(top[i]->wins * 100 / top[i]->visits) : 0;
+        extractPv(mcts, top[i], &info.lines[i]);
+    }
+    info.depth = info.lines[0].length;
+    params->info_callback(&info, params->info_data);
+}
+
+void searchMcts(RevMcts *mcts, RevBoard *board, const RevSearchParams *params,
+                SearchControl *control, uint64_t seed, RevSearchResult *result) {
+    const uint64_t start_time = getTimeMs();
+    result->move = -1;
+    result->score = 0;
+    result->depth = 0;
+    result->playouts = 0;
+    result->timed_out = 0;
+
+    if (board->mobility_count > 0) {
+        prepareRoot(mcts, board);
+        Rng rng;
+        rngSeed(&rng, seed);
+        const uint64_t trials = (params->trials > 0) ? (uint64_t)params->trials : 0;
+        const uint64_t info_interval = (uint64_t)(params->info_interval_ms > 0 ?
+                                                  params->info_interval_ms : 0);
+        uint64_t last_info_time = start_time;
+        if (mcts->evaluate != NULL) {
+            // The clock is checked once per batch.
+            while (trials == 0 || result->playouts < trials) {
+                if (isSearchStopped(control)) {
+                    result->timed_out = 1;
+                    break;
+                }
+                if (params->info_callback != NULL && result->playouts > 0) {
+                    const uint64_t now = getTimeMs();
+                    if (now - last_info_time >= info_interval) {
+                        reportProgress(mcts, params, result->playouts, start_time, now);
+                        last_info_time = now;
+                    }
+                }
+                uint64_t leaves = (uint64_t)mcts->batch_size;
+                if (trials > 0 && trials - result->playouts < leaves)
+                    leaves = trials - result->playouts;
+                result->playouts += (uint64_t)runBatch(mcts, (int)leaves);
+            }
+        }
+        while (mcts->evaluate == NULL && (trials == 0 || result->playouts < trials)) {
+            if ((result->playouts & (MCTS_CHECK_INTERVAL - 1)) == 0) {
+                if (isSearchStopped(control)) {
+                    result->timed_out = 1;
+                    break;
+                }
+                if (params->info_callback != NULL && result->playouts > 0) {
+                    const uint64_t now = getTimeMs();
+                    if (now - last_info_time >= info_interval) {
+                        reportProgress(mcts, params, result->playouts, start_time, now);
+                        last_info_time = now;
+                    }
+                }
+            }
+            runPlayout(mcts, &rng);
+            result->playouts++;
+        }
+
+        const MctsNode *root = &mcts->nodes[0];
+        if (root->children != MCTS_NO_CHILDREN && root->child_count > 0) {
+            const MctsNode *best = &mcts->nodes[root->children];
+            for (uint32_t c = root->children + 1; c < root->children + root->child_count; c++) {
+                if (isMoreVisited(&mcts->nodes[c], best)) best = &mcts->nodes[c];
+            }
+            result->move = best->move;
+            result->score = (best->visits > 0) ? (int)(best->wins * 100 / best->visits) : 0;
+        }
+        if (params->info_callback != NULL)
+            reportProgress(mcts, params, result->playouts, start_time, getTimeMs());
+    }
+    result->nodes = mcts->count;
+    result->elapsed_ms = (int)(getTimeMs() - start_time);
+}
+
+void searchMctsOnce(RevBoard *board, const RevSearchParams *params, SearchControl *control,
+                    uint64_t seed, RevSearchResult *result) {
+    RevMcts *mcts = revNewMcts(DEFAULT_MCTS_MB);
+    if (mcts == NULL) {
+        memset(result, 0, sizeof(RevSearchResult));
+        result->move = -1;
+        return;
+    }
+    searchMcts(mcts, board, params, control, seed, result);
+    revFreeMcts(mcts);
+}
+
+int revSearchMcts(RevMcts *mcts, RevBoard *board, const RevSearchParams *params,
+                  RevSearchResult *result) {
+    const uint64_t latency_start = latencyStart();
+    RevSearchResult tmp_result;
+    if (result == NULL) result = &tmp_result;
+    SearchControl control;
+    initSearchControl(&control, params->time_ms);
+    searchMcts(mcts, board, params, &control, getSearchSeed(params), result);
+    latencyEnd(REV_LATENCY_SEARCH_MCTS, latency_start);
+    return result->move;
+}
@@ -0,0 +1,67 @@
+#ifndef __REVERSI_SRC_MCTS_H__
+#define __REVERSI_SRC_MCTS_H__
+#include "reversi.h"
+#include "internal.h"
+#include "search.h"
+
+// Monte Carlo tree search with UCT, and optionally RAVE.
+// Nodes live in one array. Children of a node are allocated next to each other,
+// and always after their parent, so the tree can be compacted by sliding nodes down.
+
+#define MCTS_NO_CHILDREN 0xffffffff
+#define MCTS_PASS 64
+
+// A game has 60 moves and passes between them at most.
+#define MCTS_MAX_PATH 128
+
+typedef struct MctsNode {
+    RevBitboard p_board;  // Disks of the player to move
+    RevBitboard o_board;
+    uint32_t children;  // Index of the first child. MCTS_NO_CHILDREN until expanded.
+    uint32_t visits;
+    float wins;  // Sum of rewards for the player who moved to this node. A draw is 0.5.
+    uint8_t child_count;  // Zero for expanded nodes at the end of the game.
+    uint8_t move;  // Move from the parent. MCTS_PASS for a pass.
+    uint16_t pending;  // Paths through this node waiting for evaluation. Counted as losses.
+    // All-moves-as-first statistics. Simulations through the parent where the move was
+    // played later by the same player. Siblings are next to each other, so the values of
+    // a node's moves form one array.
+    uint32_t amaf_visits;
+    float amaf_wins;
+} MctsNode;
+
+// A leaf of a batch and the path to it.
+typedef struct MctsBatchItem {
+    uint32_t path[MCTS_MAX_PATH];
+    int length;
+    int slot;  // Index in positions and values. -1 for the end of the game.
+    float value;  // Value for the player to move at the leaf
+} MctsBatchItem;
+
+struct RevMcts {
+    MctsNode *nodes;  // nodes[0] is the root when count > 0.
+    uint32_t capacity;
+    uint32_t count;
+    RevDiskType root_player;
+    uint64_t *live;  // Bits of nodes that are kept by compaction
+    uint32_t *live_rank;  // Number of live bits before each word of live
+    float rave_equivalence;  // Zero disables RAVE.
+
+    // Leaves are evaluated by the callback instead of playouts when it's not NULL.
+    RevMctsEvaluator evaluate;
+    void *evaluate_data;
+    int batch_size;
+    MctsBatchItem *batch;
+    RevPosition *positions;
+    float *values;
+};
+
+// Same as revSearchMcts() but it can be stopped by control.
+void searchMcts(RevMcts *mcts, RevBoard *board, const RevSearchParams *params,
+                SearchControl *control, uint64_t seed, RevSearchResult *result);
+
+// Searches with a temporary tree for revSearch().
+void searchMctsOnce(RevBoard *board, const RevSearchParams *params, SearchControl *control,
+                    uint64_t seed, RevSearchResult *result);
+
+#endif  // __REVERSI_SRC_MCTS_H__
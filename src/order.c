@@ -0,0 +1,103 @@
+#include <string.h>
+#include "order.h"
+#include "hash.h"
+
+#define SCORE_HASH_MOVE (1 << 26)
+#define SCORE_KILLER1 (1 << 25)
+#define SCORE_KILLER2 (1 << 24)
+#define SCORE_CORNER 2048
+#define SCORE_X_SQUARE (-2048)
+#define SCORE_C_SQUARE (-512)
+#define SCORE_MOBILITY 256  // Per move of the opponent
+#define SCORE_FASTEST_FIRST (1 << 14)  // Per move of the opponent
+
+static const RevBitboard corner_mask = 0x8100000000000081;
+static const RevBitboard x_square_mask = 0x0042000000004200;
+static const RevBitboard c_square_mask = 0x4281000000008142;
+
+void initOrderTables(OrderTables *tables) {
+    for (int i = 0; i < MAX_PLY; i++) {
+        tables->killers[i][0] = HASH_NO_MOVE;
+        tables->killers[i][1] = HASH_NO_MOVE;
+    }
+    memset(tables->history, 0, sizeof(tables->history));
+}
+
+void ageOrderTables(OrderTables *tables) {
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 64; j++)
+            tables->history[i][j] /= 2;
+    }
+}
+
+// Returns squares next to populated bits of b.
+static inline RevBitboard getNeighbours(RevBitboard b) {
+    const RevBitboard h = b | ((b << 1) & 0xfefefefefefefefe) | ((b >> 1) & 0x7f7f7f7f7f7f7f7f);
+    return (h | (h << 8) | (h >> 8)) & ~b;
+}
+
+void genMoveList(MoveList *list, RevBitboard p_board, RevBitboard o_board, RevBitboard moves,
+                 int hash_move, const OrderTables *tables, int ply, int mode) {
+    // X-squares and C-squares are bad only when their corners are empty.
+    const RevBitboard empty_corners = ~(p_board | o_board) & corner_mask;
+    const RevBitboard danger = getNeighbours(empty_corners);
+    const RevBitboard danger_x = danger & x_square_mask;
+    const RevBitboard danger_c = danger & c_square_mask;
+    const int *killers = (tables != NULL) ? tables->killers[ply] : NULL;
+    const int *history = (tables != NULL) ? tables->history[ply & 1] : NULL;
+
+    MoveItem *item = list->moves;
+    for (; moves; moves &= moves - 1, item++) {
+        const int pos = firstOnePos(moves);
+        const RevBitboard bit = (RevBitboard)1 << pos;
+        item->pos = pos;
+        item->flipped = calcFlipped(p_board, o_board, pos);
+
+        int score = 0;
+        if (pos == hash_move) {
+            score = SCORE_HASH_MOVE;
+        } else if (killers != NULL && pos == killers[0]) {
+            score = SCORE_KILLER1;
+        } else if (killers != NULL && pos == killers[1]) {
+            score = SCORE_KILLER2;
+        }
+        score += SCORE_CORNER * ((bit & corner_mask) != 0) +
+                 SCORE_X_SQUARE * ((bit & danger_x) != 0) +
+                 SCORE_C_SQUARE * ((bit & danger_c) != 0);
+        if (history != NULL)
+            score += history[pos];
+        if (mode != ORDER_CHEAP) {
+            const RevBitboard next_o = o_board ^ item->flipped;
+            const RevBitboard next_p = p_board ^ item->flipped ^ bit;
+            const int o_mobility = countOnes(calcMobility(next_o, next_p));
+            score -= o_mobility *
+                     ((mode == ORDER_FASTEST_FIRST) ? SCORE_FASTEST_FIRST : SCORE_MOBILITY);
+        }
+        item->score = score;
+    }
+    list->count = (int)(item - list->moves);
+}
+
+void updateOrderTables(OrderTables *tables, int pos, int ply, int depth) {
+    int *killers = tables->killers[ply];
+    if (killers[0] != pos) {
+        killers[1] = killers[0];
+        killers[0] = pos;
+    }
+    int *history = tables->history[ply & 1];
+    history[pos] += depth * depth;
+    if (history[pos] > HISTORY_MAX) {
+        for (int i = 0; i < 64; i++)
+            history[i] /= 2;
+    }
+}
+
+int revGetSortedMoves(RevBoard *board, int *moves) {
+    MoveList list;
+    genMoveList(&list, board->bitboards[board->current_player],
+                board->bitboards[!board->current_player], board->mobility,
+                HASH_NO_MOVE, NULL, 0, ORDER_MOBILITY);
+    for (int i = 0; i < list.count; i++)
+        moves[i] = pickMove(&list, i)->pos;
+    return list.count;
+}
@@ -0,0 +1,62 @@
+#ifndef __REVERSI_SRC_ORDER_H__
+#define __REVERSI_SRC_ORDER_H__
+#include "reversi.h"
+#include "internal.h"
+
+// Move ordering for the alpha-beta search.
+// Moves are scored with bitboard operations into a fixed-size list. It never uses the heap.
+
+#define MOVE_LIST_SIZE 64
+#define MAX_PLY 128
+#define HISTORY_MAX (1 << 12)
+
+typedef struct MoveItem {
+    RevBitboard flipped;
+    int pos;
+    int score;
+} MoveItem;
+
+typedef struct MoveList {
+    MoveItem moves[MOVE_LIST_SIZE];
+    int count;
+} MoveList;
+
+// Killer moves and history scores. Each search thread owns one.
+typedef struct OrderTables {
+    int killers[MAX_PLY][2];
+    int history[2][64];  // Indexed by ply & 1, so each side has its own scores.
+} OrderTables;
+
+// Ordering modes
+#define ORDER_CHEAP 0  // Priors, killers, and history. For nodes near leaves.
+#define ORDER_MOBILITY 1  // Also minimizes the opponent's mobility after the move.
+#define ORDER_FASTEST_FIRST 2  // For endgame solving. The opponent's mobility comes first.
+
+void initOrderTables(OrderTables *tables);
+
+// Decays history scores. Call it at the start of each iteration.
+void ageOrderTables(OrderTables *tables);
+
+// Makes a list of scored moves. tables can be NULL to use static heuristics only.
+void genMoveList(MoveList *list, RevBitboard p_board, RevBitboard o_board, RevBitboard moves,
+                 int hash_move, const OrderTables *tables, int ply, int mode);
+
+// Records a move that caused a beta cutoff.
+void updateOrderTables(OrderTables *tables, int pos, int ply, int depth);
+
+// Moves the best remaining move to list->moves[i] and returns it.
+static inline MoveItem *pickMove(MoveList *list, int i) {
+    MoveItem *moves = list->moves;
+    int best = i;
+    for (int j = i + 1; j < list->count; j++) {
+        if (moves[j].score > moves[best].score) best = j;
+    }
+    if (best != i) {
+        const MoveItem tmp = moves[i];
+        moves[i] = moves[best];
+        moves[best] = tmp;
+    }
+    return &moves[i];
+}
+
+#endif  // __REVERSI_SRC_ORDER_H__
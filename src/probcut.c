@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <string.h>
+#include "reversi.h"
+#include "internal.h"
+#include "probcut.h"
+
+#define PROBCUT_FILE_HEADER "# reversi-core ProbCut parameters"
+
+// Multipliers of sigma for selectivity levels 1 to 5.
+// They are one-sided normal quantiles for 99%, 95%, 90%, 80%, and 70%.
+static const double probcut_confidences[5] = { 2.33, 1.64, 1.28, 0.84, 0.52 };
+
+// Fitted by tools/probcut.c with 300 positions per stage and depths up to 12.
+static const RevProbCutParams default_params = {
+    .entries = {
+        [0] = {
+            [3] = { 1, 0.810, 1.593, 2.910 },
+            [4] = { 2, 0.850, 0.093, 2.503 },
+            [5] = { 3, 0.903, -0.056, 2.069 },
+            [6] = { 2, 0.807, 0.369, 2.597 },
+            [7] = { 3, 0.881, -0.154, 2.202 },
+            [8] = { 4, 0.883, 0.229, 1.939 },
+            [9] = { 5, 0.922, -0.020, 1.809 },
+            [10] = { 4, 0.863, 0.265, 1.990 },
+            [11] = { 5, 0.889, -0.229, 1.956 },
+            [12] = { 6, 0.881, 0.294, 1.812 },
+        },
+        [1] = {
+            [3] = { 1, 0.957, 0.435, 3.569 },
+            [4] = { 2, 0.976, 0.169, 3.139 },
+            [5] = { 3, 1.001, -0.039, 2.547 },
+            [6] = { 2, 0.993, 0.619, 4.228 },
+            [7] = { 3, 1.012, 0.045, 3.566 },
+            [8] = { 4, 1.038, 0.868, 3.319 },
+            [9] = { 5, 1.048, -0.115, 2.579 },
+            [10] = { 4, 1.067, 1.232, 3.875 },
+            [11] = { 5, 1.077, -0.249, 3.266 },
+            [12] = { 6, 1.080, 1.103, 2.815 },
+        },
+        [2] = {
+            [3] = { 1, 0.996, 0.268, 4.077 },
+            [4] = { 2, 0.995, 0.628, 3.769 },
+            [5] = { 3, 1.011, -0.143, 3.142 },
+            [6] = { 2, 1.012, 0.856, 4.954 },
+            [7] = { 3, 1.034, -0.238, 4.648 },
+            [8] = { 4, 1.046, 0.563, 4.580 },
+            [9] = { 5, 1.049, -0.299, 4.459 },
+            [10] = { 4, 1.089, 0.810, 6.036 },
+            [11] = { 5, 1.093, -0.336, 6.006 },
+            [12] = { 6, 1.120, 0.565, 5.930 },
+        },
+        [3] = {
+            [3] = { 1, 0.992, 0.410, 5.198 },
+            [4] = { 2, 1.013, 0.487, 5.941 },
+            [5] = { 3, 1.031, -0.179, 4.990 },
+            [6] = { 2, 1.030, 0.783, 7.716 },
+            [7] = { 3, 1.052, -0.159, 6.963 },
+            [8] = { 4, 1.056, 0.858, 6.063 },
+            [9] = { 5, 1.071, -0.013, 6.060 },
+            [10] = { 4, 1.097, 0.978, 8.241 },
+            [11] = { 5, 1.117, -0.277, 8.545 },
+            [12] = { 6, 1.121, 0.648, 8.707 },
+        },
+        [4] = {
+            [3] = { 1, 1.006, 0.714, 7.521 },
+            [4] = { 2, 1.012, 0.863, 7.517 },
+            [5] = { 3, 1.021, -0.296, 7.164 },
+            [6] = { 2, 1.024, 1.522, 11.256 },
+            [7] = { 3, 1.041, -0.206, 10.915 },
+            [8] = { 4, 1.042, 1.050, 10.225 },
+            [9] = { 5, 1.056, -0.039, 10.078 },
+            [10] = { 4, 1.070, 1.614, 14.000 },
+            [11] = { 5, 1.081, 0.163, 13.290 },
+            [12] = { 6, 1.084, 2.357, 13.120 },
+        },
+        [5] = {
+            [3] = { 1, 0.984, -0.477, 11.744 },
+            [4] = { 2, 1.031, 1.096, 12.145 },
+            [5] = { 3, 1.010, -0.688, 11.660 },
+            [6] = { 2, 1.042, 0.963, 15.059 },
+            [7] = { 3, 1.052, 0.138, 13.358 },
+            [8] = { 4, 1.037, 3.939, 12.319 },
+            [9] = { 5, 1.051, 0.534, 12.670 },
+        },
+    },
+};
+
+const RevProbCutParams *getDefaultProbCutParams(void) {
+    return &default_params;
+}
+
+double getProbCutConfidence(int selectivity) {
+    if (selectivity < 1) selectivity = 1;
+    if (selectivity > 5) selectivity = 5;
+    return probcut_confidences[selectivity - 1];
+}
+
+RevProbCutParams *revNewProbCutParams() {
+    RevProbCutParams *params = (RevProbCutParams *)malloc(sizeof(RevProbCutParams));
+    if (params == NULL) return NULL;
+    *params = default_params;
+    return params;
+}
+
+void revFreeProbCutParams(RevProbCutParams *params) {
+    free(params);
+}
+
+int revSetProbCutEntry(RevProbCutParams *params, int stage, int depth, int shallow_depth,
+                       double a, double b, double sigma) {
+    if (stage < 0 || stage >= REV_PROBCUT_STAGES || depth < PROBCUT_MIN_DEPTH ||
+        depth > REV_PROBCUT_MAX_DEPTH || shallow_depth < 1 || shallow_depth >= depth ||
+        a <= 0 || sigma < 0)
+        return 0;
+    ProbCutEntry *entry = &params->entries[stage][depth];
+    entry->shallow_depth = shallow_depth;
+    entry->a = a;
+    entry->b = b;
+    entry->sigma = sigma;
+    return 1;
+}
+
+RevProbCutParams *revLoadProbCutParams(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) return NULL;
+    RevProbCutParams *params = (RevProbCutParams *)calloc(1, sizeof(RevProbCutParams));
+    if (params == NULL) {
+        fclose(file);
+        return NULL;
+    }
+
+    char line[256];
+    int ok = fgets(line, sizeof(line), file) != NULL &&
+             strncmp(line, PROBCUT_FILE_HEADER, strlen(PROBCUT_FILE_HEADER)) == 0;
+    while (ok && fgets(line, sizeof(line), file) != NULL) {
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+        int stage, depth, shallow_depth;
+        double a, b, sigma;
+        ok = sscanf(line, "%d %d %d %lf %lf %lf",
+                    &stage, &depth, &shallow_depth, &a, &b, &sigma) == 6 &&
+             revSetProbCutEntry(params, stage, depth, shallow_depth, a, b, sigma);
+    }
+    fclose(file);
+    if (!ok) {
+        free(params);
+        return NULL;
+    }
+    return params;
+}
+
+int revSaveProbCutParams(const RevProbCutParams *params, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (file == NULL) return 0;
+    fprintf(file, PROBCUT_FILE_HEADER "\n");
+    fprintf(file, "# stage depth shallow_depth a b sigma\n");
+    for (int stage = 0; stage < REV_PROBCUT_STAGES; stage++) {
+        for (int depth = PROBCUT_MIN_DEPTH; depth <= REV_PROBCUT_MAX_DEPTH; depth++) {
+            const ProbCutEntry *entry = &params->entries[stage][depth];
+            if (entry->sigma <= 0) continue;
+            fprintf(file, "%d %d %d %.4f %.4f %.4f\n", stage, depth, entry->shallow_depth,
+                    entry->a, entry->b, entry->sigma);
+        }
+    }
+    return fclose(file) == 0;
+}
+
+int revGetProbCutStage(RevBoard *board) {
+    return getProbCutStageFromEmpties(64 - countOnes(board->bitboards[0] | board->bitboards[1]));
+}
@@ -0,0 +1,35 @@
+#ifndef __REVERSI_SRC_PROBCUT_H__
+#define __REVERSI_SRC_PROBCUT_H__
+#include "reversi.h"
+
+// Multi-ProbCut predicts the score of a deep search with a shallow one.
+// deep_score = a * shallow_score + b + error, where error has a standard deviation of sigma.
+
+// ProbCut is not tried below this depth.
+#define PROBCUT_MIN_DEPTH 3
+
+typedef struct ProbCutEntry {
+    int shallow_depth;
+    double a;
+    double b;
+    double sigma;  // Zero when the entry is not calibrated.
+} ProbCutEntry;
+
+struct RevProbCutParams {
+    ProbCutEntry entries[REV_PROBCUT_STAGES][REV_PROBCUT_MAX_DEPTH + 1];
+};
+
+// Returns the built-in parameters.
+const RevProbCutParams *getDefaultProbCutParams(void);
+
+// Returns a multiplier of sigma for a selectivity level. Levels out of range use the closest one.
+double getProbCutConfidence(int selectivity);
+
+static inline int getProbCutStageFromEmpties(int empties) {
+    const int stage = (60 - empties) / 10;
+    if (stage < 0) return 0;
+    if (stage >= REV_PROBCUT_STAGES) return REV_PROBCUT_STAGES - 1;
+    return stage;
+}
+
+#endif  // __REVERSI_SRC_PROBCUT_H__
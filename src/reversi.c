@@ -1,5 +1,7 @@
 #include <stdio.h>
 #include "reversi.h"
+#include "internal.h"
+#include "latency.h"
 #include "mt.h"
 
 const char* revGetVersion() {
@@ -11,20 +13,11 @@ int revGetVersionAsInt() {
 }
 
 int revCountFirstZeros(RevBitboard b) {
-#ifdef _MSC_VER
-    return (int)_lzcnt_u64(b);
-#else
-    // __builtin_clzll(b) is undefined when b == 0
-    return (int)(__builtin_clzll(b) * (b != 0) + 64 * (b == 0));
-#endif
+    return countFirstZeros(b);
 }
 
 int revCountOnes(RevBitboard b) {
-#ifdef _MSC_VER
-    return (int)__popcnt64(b);
-#else
-    return (int)__builtin_popcountll(b);
-#endif
+    return countOnes(b);
 }
 
 int revXYToPos(int x, int y) {
@@ -71,16 +64,6 @@ RevBitboard revArrayToBitboard(int *array, int size) {
     return b;
 }
 
-struct RevBoard {
-    // bitboards for disks on a 8 x 8 board
-    // bitboards[0] : black disks
-    // bitboards[1] : white disks
-    RevBitboard bitboards[2];
-    RevBitboard mobility;
-    RevDiskType current_player;  // 0 means black's turn. 1 means white's turn.
-    int mobility_count;  // The number of legal moves.
-};
-
 RevBoard *revNewBoard() {
     RevBoard *board = (RevBoard *)malloc(sizeof(RevBoard));
     if (board != NULL)
@@ -230,76 +213,22 @@ void revPrintBoardWithMobility(RevBoard *board) {
     }
 }
 
-static RevBitboard getMobilityOneDirection(RevBitboard p_board, RevBitboard masked_o, int shift) {
-    RevBitboard mobility;
-    RevBitboard flip, pre;
-    const int shift_double = shift * 2;
-
-    flip = masked_o & (p_board << shift);
-    flip |= masked_o & (flip << shift);
-    pre = masked_o & (masked_o << shift);
-    flip |= pre & (flip << shift_double);
-    flip |= pre & (flip << shift_double);
-    mobility = flip << shift;
-    flip = masked_o & (p_board >> shift);
-    flip |= masked_o & (flip >> shift);
-    pre = masked_o & (masked_o >> shift);
-    flip |= pre & (flip >> shift_double);
-    flip |= pre & (flip >> shift_double);
-    mobility |= flip >> shift;
-    return mobility;
-}
-
 void revUpdateMobility(RevBoard *board) {
     const RevDiskType p_disk_type = board->current_player;
     const RevDiskType o_disk_type = !p_disk_type;
-    const RevBitboard p_board = board->bitboards[p_disk_type];
-    const RevBitboard o_board = board->bitboards[o_disk_type];
-
-    RevBitboard mobility;
-    const RevBitboard masked_o = o_board & 0x7e7e7e7e7e7e7e7e;
-
-    mobility = getMobilityOneDirection(p_board, masked_o, 1);  // horizontal
-    mobility |= getMobilityOneDirection(p_board, o_board, 8);  // vertical
-    mobility |= getMobilityOneDirection(p_board, masked_o, 7);  // diagonal
-    mobility |= getMobilityOneDirection(p_board, masked_o, 9);
-    mobility &= ~(p_board | o_board);
+    const RevBitboard mobility = calcMobility(board->bitboards[p_disk_type],
+                                              board->bitboards[o_disk_type]);
     board->mobility = mobility;
     board->mobility_count = revCountOnes(mobility);
 }
 
-static RevBitboard flipDisksOneDirection(int pos,
-                                         RevBitboard p_board, RevBitboard o_board,
-                                         RevBitboard masked_o,
-                                         RevBitboard mask_r, RevBitboard mask_l) {
-    RevBitboard outflank, flipped;
-    RevBitboard mask = mask_r >> (63 - pos);
-    outflank = (0x8000000000000000 >> revCountFirstZeros(~masked_o & mask)) & p_board;
-    flipped  = (-outflank * 2) & mask;
-
-    mask = mask_l << pos;
-    outflank = mask & ((masked_o | ~mask) + 1) & p_board;
-    flipped |= (outflank - (RevBitboard)(outflank != 0)) & mask;
-    return flipped;
-}
-
 static RevBitboard flipDisks(RevBoard *board, int pos) {
     RevDiskType p_disk_type = board->current_player;
     RevDiskType o_disk_type = !p_disk_type;
     RevBitboard p_board = board->bitboards[p_disk_type];
     RevBitboard o_board = board->bitboards[o_disk_type];
 
-    RevBitboard flipped;
-    RevBitboard masked_o = o_board & 0x7e7e7e7e7e7e7e7e;
-    flipped = flipDisksOneDirection(pos, p_board, o_board, o_board,
-                                    0x0080808080808080, 0x0101010101010100);  // horizontal
-    flipped |= flipDisksOneDirection(pos, p_board, o_board, masked_o,
-                                     0x7f00000000000000, 0x00000000000000fe);  // vertical
-    flipped |= flipDisksOneDirection(pos, p_board, o_board, masked_o,
-                                     0x0102040810204000, 0x0002040810204080);  // diagonal
-    flipped |= flipDisksOneDirection(pos, p_board, o_board, masked_o,
-                                     0x0040201008040201, 0x8040201008040200);
-
+    RevBitboard flipped = calcFlipped(p_board, o_board, pos);
     board->bitboards[p_disk_type] = p_board ^ flipped;
     board->bitboards[o_disk_type] = o_board ^ flipped;
     return flipped;
@@ -320,6 +249,11 @@ void revInitGenRandom(uint32_t seed) {
     init_genrand(seed);
 }
 
+uint64_t genSeed64(void) {
+    const uint64_t high = genrand_int32();
+    return (high << 32) | genrand_int32();
+}
+
 int revGenIntRandom(int min, int max) {
     return genrand_int32() % (max - min + 1) + min;
 }
@@ -350,6 +284,7 @@ void revMoveRandomToEnd(RevBoard *board) {
 }
 
 int revGenMoveMonteCarlo(RevBoard *board, int trials) {
+    const uint64_t latency_start = latencyStart();
     const int mobility_count = revGetMobilityCount(board);
     int *ma = revGetMobilityAsArray(board);
     const RevDiskType p_disk_type = revGetCurrentPlayer(board);
@@ -379,5 +314,6 @@ int revGenMoveMonteCarlo(RevBoard *board, int trials) {
     revFreeBoard(tmp_board);
     revFreeBoard(tmp_board2);
     free(ma);
+    latencyEnd(REV_LATENCY_GEN_MOVE_MONTE_CARLO, latency_start);
     return best_move;
 }
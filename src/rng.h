@@ -0,0 +1,47 @@
+#ifndef __REVERSI_SRC_RNG_H__
+#define __REVERSI_SRC_RNG_H__
+#include <stdint.h>
+
+// xoshiro256** generator for searches.
+// Unlike mt.h, it has no global state, so each search or thread can own a generator.
+// See https://prng.di.unimi.it/ for the algorithm.
+
+typedef struct Rng {
+    uint64_t s[4];
+} Rng;
+
+static inline uint64_t splitMix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+static inline void rngSeed(Rng *rng, uint64_t seed) {
+    for (int i = 0; i < 4; i++)
+        rng->s[i] = splitMix64(&seed);
+}
+
+static inline uint64_t rngRotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t rngNext(Rng *rng) {
+    uint64_t *s = rng->s;
+    const uint64_t result = rngRotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rngRotl(s[3], 45);
+    return result;
+}
+
+// Returns a random integer in [0, n).
+static inline int rngBounded(Rng *rng, int n) {
+    return (int)(((rngNext(rng) >> 32) * (uint64_t)n) >> 32);
+}
+
+#endif  // __REVERSI_SRC_RNG_H__
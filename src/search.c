@@ -0,0 +1,821 @@
+#include <limits.h>
+#include "reversi.h"
+#include "internal.h"
+#include "search.h"
+#include "eval.h"
+#include "hash.h"
+#include "latency.h"
+#include "mcts.h"
+#include "order.h"
+#include "probcut.h"
+#include "rng.h"
+#include "thread.h"
+#include "timer.h"
+
+// The clock is checked once per this many nodes or playouts.
+// Both of them should be powers of 2.
+#define NODE_CHECK_INTERVAL 1024
+#define PLAYOUT_CHECK_INTERVAL 64
+
+#define SCORE_INF 127
+#define SCORE_MAX 64
+#define MAX_DEPTH 60
+
+// The transposition table is not used near leaves.
+#define HASH_MIN_DEPTH 2
+
+// Moves are ordered by the opponent's mobility from this depth.
+#define ORDER_MOBILITY_DEPTH 4
+
+// Children's table entries are probed before searching them from this depth.
+#define ETC_MIN_DEPTH 6
+
+typedef struct SearchContext {
+    SearchControl *control;
+    RevHashTable *hash;  // Can be NULL.
+    const RevEvalWeights *eval;  // NULL uses evaluateSquares().
+    const RevProbCutParams *probcut;
+    double probcut_confidence;  // Multiplier of sigma
+    int selectivity;  // 0 disables ProbCut.
+    OrderTables order;
+    Rng rng;
+    uint64_t nodes;
+    uint64_t playouts;
+    uint64_t start_time;
+    uint64_t last_info_time;  // When info_callback was called last time. 0 if never.
+    int stopped;
+} SearchContext;
+
+void initSearchControl(SearchControl *control, int time_ms) {
+    control->stop = 0;
+    control->deadline = (time_ms > 0) ? getTimeMs() + (uint64_t)time_ms : 0;
+}
+
+static void initSearchContext(SearchContext *ctx, SearchControl *control,
+                              RevHashTable *hash, const RevSearchParams *params, uint64_t seed) {
+    ctx->control = control;
+    ctx->hash = hash;
+    ctx->eval = params->eval;
+    ctx->probcut = (params->probcut != NULL) ? params->probcut : getDefaultProbCutParams();
+    ctx->selectivity = (params->selectivity > 0) ? params->selectivity : 0;
+    ctx->probcut_confidence = getProbCutConfidence(ctx->selectivity);
+    initOrderTables(&ctx->order);
+    rngSeed(&ctx->rng, seed);
+    ctx->nodes = 0;
+    ctx->playouts = 0;
+    ctx->start_time = getTimeMs();
+    ctx->last_info_time = 0;
+    ctx->stopped = 0;
+}
+
+int isSearchStopped(SearchControl *control) {
+    const uint64_t deadline = atomicLoadU64(&control->deadline);
+    return atomicLoadInt(&control->stop) || (deadline != 0 && getTimeMs() >= deadline);
+}
+
+static void checkTime(SearchContext *ctx) {
+    if (isSearchStopped(ctx->control))
+        ctx->stopped = 1;
+}
+
+void revInitSearchParams(RevSearchParams *params) {
+    params->type = SEARCH_ALPHA_BETA;
+    params->depth = 6;
+    params->trials = 20000;
+    params->time_ms = 0;
+    params->threads = 1;
+    params->hash = NULL;
+    params->selectivity = 0;
+    params->probcut = NULL;
+    params->eval = NULL;
+    params->seed = 0;
+    params->info_callback = NULL;
+    params->info_data = NULL;
+    params->info_interval_ms = 100;
+    params->multi_pv = 1;
+}
+
+uint64_t getSearchSeed(const RevSearchParams *params) {
+    return (params->seed != 0) ? params->seed : genSeed64();
+}
+
+// Weights of squares grouped by masks.
+// Corners, C-squares, X-squares, A-squares, B-squares, the inner ring, and the center.
+static const RevBitboard square_masks[7] = {
+    0x8100000000000081, 0x4281000000008142, 0x0042000000004200, 0x2400810000810024,
+    0x1800008181000018, 0x003c424242423c00, 0x00003c3c3c3c0000,
+};
+static const int square_weights[7] = { 100, -20, -50, 10, 5, -2, -1 };
+
+// Returns the final score for p_board. Empty squares are counted for the winner.
+static int finalScore(RevBitboard p_board, RevBitboard o_board) {
+    const int p_count = countOnes(p_board);
+    const int o_count = countOnes(o_board);
+    const int empties = 64 - p_count - o_count;
+    int diff = p_count - o_count;
+    if (diff > 0)
+        diff += empties;
+    else if (diff < 0)
+        diff -= empties;
+    return diff;
+}
+
+// Built-in evaluation for p_board with square weights and mobility.
+static int evaluateSquares(RevBitboard p_board, RevBitboard o_board) {
+    int score = 0;
+    for (int i = 0; i < 7; i++) {
+        score += square_weights[i] * (countOnes(p_board & square_masks[i]) -
+                                      countOnes(o_board & square_masks[i]));
+    }
+    score += 8 * (countOnes(calcMobility(p_board, o_board)) -
+                  countOnes(calcMobility(o_board, p_board)));
+    return score / 4;
+}
+
+// Static evaluation for p_board. It roughly estimates the final disk difference.
+static int evaluate(const SearchContext *ctx, RevBitboard p_board, RevBitboard o_board) {
+    const int score = (ctx->eval != NULL) ?
+        evaluatePatterns(ctx->eval, p_board, o_board) / EVAL_SCALE :
+        evaluateSquares(p_board, o_board);
+    if (score >= SCORE_MAX) return SCORE_MAX - 1;
+    if (score <= -SCORE_MAX) return -SCORE_MAX + 1;
+    return score;
+}
+
+static int negamax(SearchContext *ctx, RevBitboard p_board, RevBitboard o_board,
+                   int depth, int ply, int alpha, int beta, int passed);
+
+static inline int ceilToInt(double x) {
+    const int i = (int)x;
+    return i + (i < x);
+}
+
+static inline int floorToInt(double x) {
+    const int i = (int)x;
+    return i - (i > x);
+}
+
+// Multi-ProbCut. Returns TRUE and sets score when a shallow search predicts that
+// the deep search will fail high or low.
+static int probCut(SearchContext *ctx, RevBitboard p_board, RevBitboard o_board,
+                   int depth, int ply, int alpha, int beta, int empties, int *score) {
+    const ProbCutEntry *entry = &ctx->probcut->entries[getProbCutStageFromEmpties(empties)][depth];
+    if (entry->sigma <= 0) return 0;
+    const double margin = ctx->probcut_confidence * entry->sigma;
+
+    // deep_score >= beta is likely when a * shallow_score + b - margin >= beta.
+    const int upper = ceilToInt((beta + margin - entry->b) / entry->a);
+    if (upper < SCORE_MAX &&
+        negamax(ctx, p_board, o_board, entry->shallow_depth, ply, upper - 1, upper, 0) >= upper) {
+        *score = beta;
+        return 1;
+    }
+    // deep_score <= alpha is likely when a * shallow_score + b + margin <= alpha.
+    const int lower = floorToInt((alpha - margin - entry->b) / entry->a);
+    if (lower > -SCORE_MAX &&
+        negamax(ctx, p_board, o_board, entry->shallow_depth, ply, lower, lower + 1, 0) <= lower) {
+        *score = alpha;
+        return 1;
+    }
+    return 0;
+}
+
+// Enhanced transposition cutoff. Returns TRUE and sets score when the table says that
+// a child fails low, so this node fails high without searching any child.
+static int transpositionCutoff(SearchContext *ctx, RevBitboard p_board, RevBitboard o_board,
+                               const MoveList *list, int depth, int selectivity, int beta,
+                               int *score) {
+    for (int i = 0; i < list->count; i++) {
+        const MoveItem *move = &list->moves[i];
+        const uint64_t key = hashPosition(o_board ^ move->flipped,
+                                          p_board ^ move->flipped ^ ((RevBitboard)1 << move->pos));
+        HashData data;
+        // Scores of children are from the opponent's side. Their upper bounds are our lower bounds.
+        if (!hashProbe(ctx->hash, key, &data)) continue;
+        if (data.depth >= depth - 1 && data.selectivity <= selectivity &&
+            data.bound != BOUND_LOWER && -data.score >= beta) {
+            *score = -data.score;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int negamax(SearchContext *ctx, RevBitboard p_board, RevBitboard o_board,
+                   int depth, int ply, int alpha, int beta, int passed) {
+    if ((++ctx->nodes & (NODE_CHECK_INTERVAL - 1)) == 0)
+        checkTime(ctx);
+    if (ctx->stopped) return 0;
+
+    if (depth == 0) {
+        if (~(p_board | o_board) == 0)
+            return finalScore(p_board, o_board);
+        return evaluate(ctx, p_board, o_board);
+    }
+
+    const RevBitboard moves = calcMobility(p_board, o_board);
+    if (moves == 0) {
+        if (passed)
+            return finalScore(p_board, o_board);
+        return -negamax(ctx, o_board, p_board, depth, ply + 1, -beta, -alpha, 1);
+    }
+
+    // Stability cutoff. Stable disks bound the final score when solving.
+    const int empties = 64 - countOnes(p_board | o_board);
+    if (depth >= empties) {
+        if (alpha >= SCORE_MAX - 2 * countOnes(o_board)) {
+            const int max_score = SCORE_MAX - 2 * countOnes(calcStableDisks(o_board, p_board));
+            if (max_score <= alpha)
+                return max_score;
+        }
+        if (beta <= 2 * countOnes(p_board) - SCORE_MAX) {
+            const int min_score = 2 * countOnes(calcStableDisks(p_board, o_board)) - SCORE_MAX;
+            if (min_score >= beta)
+                return min_score;
+        }
+    }
+
+    // Nodes that are searched to the end are never pruned by ProbCut.
+    const int selectivity = (depth >= empties) ? 0 : ctx->selectivity;
+    const int use_hash = ctx->hash != NULL && depth >= HASH_MIN_DEPTH;
+    const int alpha_orig = alpha;
+    uint64_t key = 0;
+    int hash_move = HASH_NO_MOVE;
+    if (use_hash) {
+        HashData data;
+        key = hashPosition(p_board, o_board);
+        if (hashProbe(ctx->hash, key, &data)) {
+            if (data.depth >= depth && data.selectivity <= selectivity) {
+                if (data.bound == BOUND_EXACT ||
+                    (data.bound == BOUND_LOWER && data.score >= beta) ||
+                    (data.bound == BOUND_UPPER && data.score <= alpha))
+                    return data.score;
+            }
+            hash_move = data.move;
+        }
+    }
+
+    if (selectivity > 0 && depth >= PROBCUT_MIN_DEPTH && depth <= REV_PROBCUT_MAX_DEPTH) {
+        int score;
+        if (probCut(ctx, p_board, o_board, depth, ply, alpha, beta, empties, &score))
+            return score;
+    }
+
+    if (depth == 1) {
+        // Children are leaves. Ordering costs more than it saves.
+        int best_score = -SCORE_INF;
+        for (RevBitboard m = moves; m; m &= m - 1) {
+            const int pos = firstOnePos(m);
+            const RevBitboard flipped = calcFlipped(p_board, o_board, pos);
+            const int score = -negamax(ctx, o_board ^ flipped,
+                                       p_board ^ flipped ^ ((RevBitboard)1 << pos),
+                                       0, ply + 1, -beta, -alpha, 0);
+            if (score > best_score) {
+                best_score = score;
+                if (score > alpha) {
+                    alpha = score;
+                    if (alpha >= beta) break;
+                }
+            }
+        }
+        return best_score;
+    }
+
+    const int mode = (depth < ORDER_MOBILITY_DEPTH) ? ORDER_CHEAP :
+                     (depth >= empties) ? ORDER_FASTEST_FIRST : ORDER_MOBILITY;
+    MoveList list;
+    genMoveList(&list, p_board, o_board, moves, hash_move, &ctx->order, ply, mode);
+
+    // Children probe the table first thing. Loading their buckets now overlaps the cache
+    // misses with each other and with the work before the probes.
+    if (use_hash && depth > HASH_MIN_DEPTH) {
+        for (int i = 0; i < list.count; i++) {
+            const MoveItem *move = &list.moves[i];
+            hashPrefetch(ctx->hash, hashPosition(o_board ^ move->flipped,
+                                                 p_board ^ move->flipped ^
+                                                 ((RevBitboard)1 << move->pos)));
+        }
+    }
+
+    if (use_hash && depth >= ETC_MIN_DEPTH) {
+        int score;
+        if (transpositionCutoff(ctx, p_board, o_board, &list, depth, selectivity, beta, &score))
+            return score;
+    }
+
+    int best_move = HASH_NO_MOVE;
+    int best_score = -SCORE_INF;
+    for (int i = 0; i < list.count; i++) {
+        const MoveItem *move = pickMove(&list, i);
+        const int score = -negamax(ctx, o_board ^ move->flipped,
+                                   p_board ^ move->flipped ^ ((RevBitboard)1 << move->pos),
+                                   depth - 1, ply + 1, -beta, -alpha, 0);
+        if (score > best_score) {
+            best_score = score;
+            best_move = move->pos;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    updateOrderTables(&ctx->order, move->pos, ply, depth);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (use_hash && !ctx->stopped) {
+        const int bound = (best_score >= beta) ? BOUND_LOWER :
+                          (best_score > alpha_orig) ? BOUND_EXACT : BOUND_UPPER;
+        hashStore(ctx->hash, key, depth, best_score, bound, selectivity,
+                  (bound == BOUND_UPPER) ? HASH_NO_MOVE : best_move);
+    }
+    return best_score;
+}
+
+// Searches root moves and returns the number of moves that have been searched.
+// The top multi_pv moves get exact scores. Scores of other moves are upper bounds.
+static int searchRoot(SearchContext *ctx, RevBitboard p_board, RevBitboard o_board,
+                      const int *moves, int *scores, int move_count, int depth, int multi_pv) {
+    // top[] keeps the best scores in descending order. alpha is the last of them.
+    int top[REV_MAX_MULTI_PV];
+    int alpha = -SCORE_INF;
+    int searched = 0;
+    for (; searched < move_count; searched++) {
+        const int pos = moves[searched];
+        const RevBitboard flipped = calcFlipped(p_board, o_board, pos);
+        const int score = -negamax(ctx, o_board ^ flipped,
+                                   p_board ^ flipped ^ ((RevBitboard)1 << pos),
+                                   depth - 1, 1, -SCORE_INF, -alpha, 0);
+        if (ctx->stopped) break;
+        scores[searched] = score;
+        if (searched < multi_pv || score > alpha) {
+            int i = (searched < multi_pv) ? searched : multi_pv - 1;
+            for (; i > 0 && top[i - 1] < score; i--) top[i] = top[i - 1];
+            top[i] = score;
+            if (searched >= multi_pv - 1)
+                alpha = top[multi_pv - 1];
+        }
+    }
+    return searched;
+}
+
+// Moves the best count moves to the front in order of scores.
+// Other moves keep their order, and ties keep the earlier move first.
+static void sortRootMoves(int *moves, int *scores, int move_count, int count) {
+    for (int rank = 0; rank < count && rank < move_count; rank++) {
+        int best = rank;
+        for (int i = rank + 1; i < move_count; i++) {
+            if (scores[i] > scores[best]) best = i;
+        }
+        const int move = moves[best];
+        const int score = scores[best];
+        for (int i = best; i > rank; i--) {
+            moves[i] = moves[i - 1];
+            scores[i] = scores[i - 1];
+        }
+        moves[rank] = move;
+        scores[rank] = score;
+    }
+}
+
+// Follows best moves in the transposition table from a root move.
+static void extractPv(SearchContext *ctx, RevBitboard p_board, RevBitboard o_board,
+                      int move, int depth, RevPvLine *line) {
+    line->length = 0;
+    for (;;) {
+        line->pv[line->length++] = move;
+        if (move >= 0) {
+            const RevBitboard flipped = calcFlipped(p_board, o_board, move);
+            p_board ^= flipped | ((RevBitboard)1 << move);
+            o_board ^= flipped;
+            depth--;
+        }
+        const RevBitboard tmp = p_board;
+        p_board = o_board;
+        o_board = tmp;
+        if (depth <= 0 || ctx->hash == NULL || line->length == REV_MAX_PV_LENGTH) break;
+
+        const RevBitboard moves = calcMobility(p_board, o_board);
+        if (moves == 0) {
+            if (calcMobility(o_board, p_board) == 0 || move < 0) break;
+            move = -1;
+            continue;
+        }
+        HashData data;
+        if (!hashProbe(ctx->hash, hashPosition(p_board, o_board), &data) ||
+            data.move == HASH_NO_MOVE || ((moves >> data.move) & 1) == 0)
+            break;
+        move = data.move;
+    }
+}
+
+// Calls info_callback with the top moves of an iteration. It skips calls within the interval
+// unless force is TRUE. Returns TRUE if it was called.
+static int reportIteration(SearchContext *ctx, const RevSearchParams *params,
+                           RevBitboard p_board, RevBitboard o_board, const int *moves,
+                           const int *scores, int line_count, int depth, int force) {
+    const uint64_t now = getTimeMs();
+    if (!force && ctx->last_info_time != 0 &&
+        now - ctx->last_info_time < (uint64_t)params->info_interval_ms)
+        return 0;
+    ctx->last_info_time = now;
+
+    RevSearchInfo info;
+    info.depth = depth;
+    info.nodes = ctx->nodes;
+    info.playouts = 0;
+    info.elapsed_ms = (int)(now - ctx->start_time);
+    info.speed = ctx->nodes * 1000 / (uint64_t)(info.elapsed_ms > 0 ? info.elapsed_ms : 1);
+    info.line_count = line_count;
+    for (int i = 0; i < line_count; i++) {
+        info.lines[i].score = scores[i];
+        extractPv(ctx, p_board, o_board, moves[i], depth, &info.lines[i]);
+    }
+    params->info_callback(&info, params->info_data);
+    return 1;
+}
+
+// Iterative deepening. Helper threads of Lazy SMP have positive thread_id.
+// Odd helpers search one ply deeper than the main thread to fill the table ahead of it.
+// The main thread reports progress to info_callback.
+static void searchAlphaBeta(SearchContext *ctx, RevBoard *board,
+                            const RevSearchParams *params, RevSearchResult *result,
+                            int thread_id) {
+    const RevBitboard p_board = board->bitboards[board->current_player];
+    const RevBitboard o_board = board->bitboards[!board->current_player];
+    const int empties = 64 - countOnes(p_board | o_board);
+    int max_depth = (params->depth > 0) ? params->depth : MAX_DEPTH;
+    if (max_depth > empties) max_depth = empties;
+
+    // Static ordering for the first iteration.
+    MoveList list;
+    genMoveList(&list, p_board, o_board, board->mobility, HASH_NO_MOVE, NULL, 0, ORDER_MOBILITY);
+    int moves[MOVE_LIST_SIZE];
+    int scores[MOVE_LIST_SIZE];
+    const int move_count = list.count;
+    for (int i = 0; i < move_count; i++)
+        moves[i] = pickMove(&list, i)->pos;
+    if (move_count == 0) return;
+    result->move = moves[0];
+
+    // Helpers start from different root moves.
+    for (int i = 0; i < thread_id % move_count; i++) {
+        const int tmp = moves[0];
+        for (int j = 1; j < move_count; j++) moves[j - 1] = moves[j];
+        moves[move_count - 1] = tmp;
+    }
+
+    int multi_pv = (params->multi_pv > 1) ? params->multi_pv : 1;
+    if (multi_pv > REV_MAX_MULTI_PV) multi_pv = REV_MAX_MULTI_PV;
+    if (multi_pv > move_count) multi_pv = move_count;
+    const int report = thread_id == 0 && params->info_callback != NULL;
+    int reported_depth = 0;
+    for (int depth = 1 + (thread_id & 1); depth <= max_depth; depth++) {
+        ageOrderTables(&ctx->order);
+        int iteration_scores[MOVE_LIST_SIZE];
+        const int searched = searchRoot(ctx, p_board, o_board, moves, iteration_scores,
+                                        move_count, depth, multi_pv);
+        if (searched > 0) {
+            // A partial iteration is still usable because the previous best move comes first.
+            int best = 0;
+            for (int i = 1; i < searched; i++) {
+                if (iteration_scores[i] > iteration_scores[best]) best = i;
+            }
+            result->move = moves[best];
+            result->score = iteration_scores[best];
+        }
+        if (ctx->stopped) break;
+        result->depth = depth;
+
+        // Search the best moves first in the next iteration.
+        for (int i = 0; i < move_count; i++) scores[i] = iteration_scores[i];
+        sortRootMoves(moves, scores, move_count, multi_pv);
+        if (report && reportIteration(ctx, params, p_board, o_board, moves, scores, multi_pv,
+                                      depth, depth == max_depth))
+            reported_depth = depth;
+    }
+
+    // The last finished iteration might have been skipped by the interval.
+    if (report && result->depth > reported_depth)
+        reportIteration(ctx, params, p_board, o_board, moves, scores, multi_pv, result->depth, 1);
+}
+
+// Win/loss/draw solver. Null windows around zero prove the sign of the final score,
+// which cuts far more than searching the exact score.
+static void searchWinLossDraw(SearchContext *ctx, RevBoard *board, RevSearchResult *result) {
+    const RevBitboard p_board = board->bitboards[board->current_player];
+    const RevBitboard o_board = board->bitboards[!board->current_player];
+    const int empties = 64 - countOnes(p_board | o_board);
+    int score;
+    if (board->mobility_count == 0) {
+        // negamax() passes the turn or counts disks.
+        score = negamax(ctx, p_board, o_board, empties, 0, -1, 1, 0);
+    } else {
+        MoveList list;
+        genMoveList(&list, p_board, o_board, board->mobility, HASH_NO_MOVE, &ctx->order, 0,
+                    ORDER_FASTEST_FIRST);
+        result->move = pickMove(&list, 0)->pos;
+        // The first move gets the window (-1, 1), which tells all three results apart.
+        // After that, each move only has to prove that it's better than the best one.
+        int alpha = -1;
+        score = -SCORE_INF;
+        for (int i = 0; i < list.count; i++) {
+            const MoveItem *move = pickMove(&list, i);
+            const int move_score = -negamax(ctx, o_board ^ move->flipped,
+                                            p_board ^ move->flipped ^ ((RevBitboard)1 << move->pos),
+                                            empties - 1, 1, -1, -alpha, 0);
+            if (ctx->stopped) break;
+            if (move_score > score) {
+                score = move_score;
+                result->move = move->pos;
+                if (score > alpha) {
+                    alpha = score;
+                    if (alpha >= 1) break;
+                }
+            }
+        }
+    }
+    if (ctx->stopped) return;
+    result->score = (score > 0) ? REV_WLD_WIN : (score < 0) ? REV_WLD_LOSS : REV_WLD_DRAW;
+    result->depth = empties;
+}
+
+typedef struct SmpHelper {
+    Thread thread;
+    SearchContext ctx;
+    RevBoard *board;
+    const RevSearchParams *params;
+    RevSearchResult result;
+    int thread_id;
+} SmpHelper;
+
+static void smpHelperThread(void *arg) {
+    SmpHelper *helper = (SmpHelper *)arg;
+    searchAlphaBeta(&helper->ctx, helper->board, helper->params, &helper->result,
+                    helper->thread_id);
+}
+
+// Lazy SMP. All threads search the same root and share results via the transposition table.
+// The main thread decides the result, and stops helpers when it finishes.
+static void searchLazySmp(SearchContext *ctx, RevBoard *board,
+                          const RevSearchParams *params, RevSearchResult *result,
+                          int threads) {
+    SearchControl helper_control;
+    initSearchControl(&helper_control, 0);
+    SmpHelper *helpers = (SmpHelper *)malloc(sizeof(SmpHelper) * (threads - 1));
+    int started = 0;
+    if (helpers != NULL) {
+        for (; started < threads - 1; started++) {
+            SmpHelper *helper = &helpers[started];
+            initSearchContext(&helper->ctx, &helper_control, ctx->hash, params,
+                              rngNext(&ctx->rng));
+            helper->board = board;
+            helper->params = params;
+            helper->thread_id = started + 1;
+            if (threadCreate(&helper->thread, smpHelperThread, helper) != 0) break;
+        }
+    }
+
+    searchAlphaBeta(ctx, board, params, result, 0);
+
+    atomicStoreInt(&helper_control.stop, 1);
+    for (int i = 0; i < started; i++) {
+        threadJoin(helpers[i].thread);
+        ctx->nodes += helpers[i].ctx.nodes;
+    }
+    free(helpers);
+}
+
+int playout(Rng *rng, RevBitboard p_board, RevBitboard o_board) {
+    int sign = 1;
+    int passed = 0;
+    for (;;) {
+        RevBitboard moves = calcMobility(p_board, o_board);
+        if (moves == 0) {
+            if (passed) break;
+            passed = 1;
+        } else {
+            passed = 0;
+            // Pick the Nth legal move.
+            for (int n = rngBounded(rng, countOnes(moves)); n > 0; n--)
+                moves &= moves - 1;
+            const int pos = firstOnePos(moves);
+            const RevBitboard flipped = calcFlipped(p_board, o_board, pos);
+            p_board ^= flipped | ((RevBitboard)1 << pos);
+            o_board ^= flipped;
+        }
+        const RevBitboard tmp = p_board;
+        p_board = o_board;
+        o_board = tmp;
+        sign = -sign;
+    }
+    return sign * (countOnes(p_board) - countOnes(o_board));
+}
+
+// Playouts of the Monte Carlo Search are split into blocks of this many games.
+// Each block has its own random stream, so results don't depend on which thread plays it.
+#define PLAYOUT_BLOCK_SIZE PLAYOUT_CHECK_INTERVAL
+
+typedef struct MonteCarloShared {
+    SearchControl *control;
+    RevBitboard (*children)[2];  // Stored from the opponent's view.
+    int move_count;
+    uint64_t seed;
+    uint64_t trials;  // 0 means no limit.
+    int block_count;  // Number of blocks to play.
+    int next;  // Index of the next block to play. Accessed with atomics.
+} MonteCarloShared;
+
+typedef struct MonteCarloWorker {
+    Thread thread;
+    MonteCarloShared *shared;
+    int wins[64];
+    int tries[64];
+    uint64_t playouts;
+    int stopped;
+} MonteCarloWorker;
+
+// Playout k of the search plays the (k % move_count)th move, so that stopping at any time
+// keeps the stats fair. The random stream of a block depends only on the seed and the index.
+static void playBlocks(MonteCarloWorker *worker) {
+    MonteCarloShared *shared = worker->shared;
+    for (;;) {
+        if (isSearchStopped(shared->control)) {
+            worker->stopped = 1;
+            break;
+        }
+        const int block = atomicFetchAddInt(&shared->next, 1);
+        if (block >= shared->block_count) break;
+
+        uint64_t state = shared->seed + (uint64_t)block;
+        Rng rng;
+        rngSeed(&rng, splitMix64(&state));
+        const uint64_t first = (uint64_t)block * PLAYOUT_BLOCK_SIZE;
+        uint64_t last = first + PLAYOUT_BLOCK_SIZE;
+        if (shared->trials != 0 && last > shared->trials)
+            last = shared->trials;
+        int i = (int)(first % (uint64_t)shared->move_count);
+        for (uint64_t k = first; k < last; k++) {
+            worker->wins[i] += playout(&rng, shared->children[i][0], shared->children[i][1]) < 0;
+            worker->tries[i]++;
+            i = (i + 1 == shared->move_count) ? 0 : i + 1;
+        }
+        worker->playouts += last - first;
+    }
+}
+
+static void monteCarloThread(void *arg) {
+    playBlocks((MonteCarloWorker *)arg);
+}
+
+// Root-parallel Monte Carlo Search. Workers take blocks of playouts and count results
+// on their own. With a trial limit, the result is the same for any number of threads.
+static void searchMonteCarlo(SearchContext *ctx, RevBoard *board, const RevSearchParams *params,
+                             uint64_t seed, int threads, RevSearchResult *result) {
+    const RevBitboard p_board = board->bitboards[board->current_player];
+    const RevBitboard o_board = board->bitboards[!board->current_player];
+
+    RevBitboard children[64][2];
+    int moves[64];
+    int move_count = 0;
+    for (RevBitboard m = board->mobility; m; m &= m - 1) {
+        const int pos = firstOnePos(m);
+        const RevBitboard flipped = calcFlipped(p_board, o_board, pos);
+        children[move_count][0] = o_board ^ flipped;
+        children[move_count][1] = p_board ^ flipped ^ ((RevBitboard)1 << pos);
+        moves[move_count++] = pos;
+    }
+
+    MonteCarloShared shared;
+    shared.control = ctx->control;
+    shared.children = children;
+    shared.move_count = move_count;
+    shared.seed = seed;
+    shared.trials = (params->trials > 0) ? (uint64_t)params->trials : 0;
+    // Without a trial limit, leave room for each thread to take one block past the end.
+    shared.block_count = (shared.trials != 0) ?
+        (int)((shared.trials + PLAYOUT_BLOCK_SIZE - 1) / PLAYOUT_BLOCK_SIZE) : INT_MAX - threads;
+    shared.next = 0;
+    if (threads > shared.block_count) threads = shared.block_count;
+    if (threads < 1) threads = 1;
+
+    MonteCarloWorker *workers = (MonteCarloWorker *)calloc(threads, sizeof(MonteCarloWorker));
+    if (workers == NULL) return;
+    for (int w = 0; w < threads; w++)
+        workers[w].shared = &shared;
+
+    // The caller's thread works as the first worker.
+    int started = 1;
+    for (; started < threads; started++) {
+        if (threadCreate(&workers[started].thread, monteCarloThread, &workers[started]) != 0)
+            break;
+    }
+    playBlocks(&workers[0]);
+
+    // Sum the counts. Integer sums don't depend on the order blocks were played in.
+    int wins[64] = { 0 };
+    int tries[64] = { 0 };
+    for (int w = 0; w < started; w++) {
+        if (w > 0) threadJoin(workers[w].thread);
+        for (int i = 0; i < move_count; i++) {
+            wins[i] += workers[w].wins[i];
+            tries[i] += workers[w].tries[i];
+        }
+        ctx->playouts += workers[w].playouts;
+        ctx->stopped |= workers[w].stopped;
+    }
+    free(workers);
+
+    // Compare win rates. wins[i] / tries[i] > wins[best] / tries[best]
+    int best = 0;
+    for (int i = 1; i < move_count; i++) {
+        if ((int64_t)wins[i] * tries[best] > (int64_t)wins[best] * tries[i])
+            best = i;
+    }
+    result->move = moves[best];
+    result->score = (tries[best] > 0) ? wins[best] * 100 / tries[best] : 0;
+}
+
+void searchWithHash(RevBoard *board, const RevSearchParams *params, RevHashTable *hash,
+                    SearchControl *control, uint64_t seed, RevSearchResult *result) {
+    if (params->type == SEARCH_MCTS) {
+        searchMctsOnce(board, params, control, seed, result);
+        return;
+    }
+    result->move = -1;
+    result->score = 0;
+    result->depth = 0;
+
+    const int threads = (params->threads > 0) ? params->threads : getCpuCount();
+    SearchContext ctx;
+    initSearchContext(&ctx, control, hash, params, seed);
+    if (params->type == SEARCH_WLD) {
+        searchWinLossDraw(&ctx, board, result);
+    } else if (board->mobility_count > 0) {
+        if (params->type == SEARCH_MONTE_CARLO)
+            searchMonteCarlo(&ctx, board, params, seed, threads, result);
+        else if (threads > 1 && hash != NULL)
+            searchLazySmp(&ctx, board, params, result, threads);
+        else
+            searchAlphaBeta(&ctx, board, params, result, 0);
+    }
+
+    result->nodes = ctx.nodes;
+    result->playouts = ctx.playouts;
+    result->elapsed_ms = (int)(getTimeMs() - ctx.start_time);
+    result->timed_out = ctx.stopped;
+}
+
+void searchBoard(RevBoard *board, const RevSearchParams *params, SearchControl *control,
+                 uint64_t seed, RevSearchResult *result) {
+    const int threads = (params->threads > 0) ? params->threads : getCpuCount();
+    RevHashTable *hash = params->hash;
+    if (hash == NULL &&
+        ((params->type == SEARCH_ALPHA_BETA && (threads > 1 || params->info_callback != NULL)) ||
+         params->type == SEARCH_WLD))
+        hash = revNewHashTable(DEFAULT_HASH_MB);
+    if (hash != NULL)
+        hashNewSearch(hash);
+
+    searchWithHash(board, params, hash, control, seed, result);
+
+    if (hash != params->hash)
+        revFreeHashTable(hash);
+}
+
+int revSearch(RevBoard *board, const RevSearchParams *params, RevSearchResult *result) {
+    RevSearchResult tmp_result;
+    if (result == NULL) result = &tmp_result;
+    const uint64_t latency_start = latencyStart();
+    SearchControl control;
+    initSearchControl(&control, params->time_ms);
+    searchBoard(board, params, &control, getSearchSeed(params), result);
+    latencyEnd(REV_LATENCY_SEARCH, latency_start);
+    return result->move;
+}
+
+int revGenMoveAlphaBeta(RevBoard *board, int depth) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.type = SEARCH_ALPHA_BETA;
+    params.depth = depth;
+    return revSearch(board, &params, NULL);
+}
+
+int revSolveWLD(RevBoard *board) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.type = SEARCH_WLD;
+    RevSearchResult result;
+    revSearch(board, &params, &result);
+    return result.score;
+}
+
+int revGenMoveTimed(RevBoard *board, int budget_ms) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.type = SEARCH_MONTE_CARLO;
+    params.trials = 0;
+    params.time_ms = (budget_ms > 0) ? budget_ms : 1;
+    return revSearch(board, &params, NULL);
+}
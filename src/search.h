@@ -0,0 +1,38 @@
+#ifndef __REVERSI_SRC_SEARCH_H__
+#define __REVERSI_SRC_SEARCH_H__
+#include "reversi.h"
+#include "internal.h"
+#include "rng.h"
+
+// Size of the temporary table for multi-threaded searches without params->hash.
+#define DEFAULT_HASH_MB 16
+
+// Shared state to stop a search from other threads.
+typedef struct SearchControl {
+    int stop;  // TRUE to stop the search. Accessed with atomics.
+    uint64_t deadline;  // Time on getTimeMs(). 0 means no time limit. Accessed with atomics.
+} SearchControl;
+
+void initSearchControl(SearchControl *control, int time_ms);
+
+// Returns TRUE when the search should stop by the flag or the deadline.
+int isSearchStopped(SearchControl *control);
+
+// Plays random moves to the end and returns the final disk difference for p_board.
+int playout(Rng *rng, RevBitboard p_board, RevBitboard o_board);
+
+// Returns params->seed, or a seed from genSeed64() when it's zero.
+// It should be called on the caller's thread.
+uint64_t getSearchSeed(const RevSearchParams *params);
+
+// Same as revSearch() but it can be stopped by control.
+// seed is used for playouts. It should come from getSearchSeed() on the caller's thread.
+void searchBoard(RevBoard *board, const RevSearchParams *params, SearchControl *control,
+                 uint64_t seed, RevSearchResult *result);
+
+// Same as searchBoard() but it uses hash instead of params->hash, and doesn't start
+// a new generation of the table. hash can be NULL.
+void searchWithHash(RevBoard *board, const RevSearchParams *params, RevHashTable *hash,
+                    SearchControl *control, uint64_t seed, RevSearchResult *result);
+
+#endif  // __REVERSI_SRC_SEARCH_H__
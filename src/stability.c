@@ -0,0 +1,81 @@
+#include "reversi.h"
+#include "internal.h"
+
+// Diagonals that go from the top left to the bottom right.
+static const RevBitboard diag9_masks[15] = {
+    0x0100000000000000, 0x0201000000000000, 0x0402010000000000, 0x0804020100000000,
+    0x1008040201000000, 0x2010080402010000, 0x4020100804020100, 0x8040201008040201,
+    0x0080402010080402, 0x0000804020100804, 0x0000008040201008, 0x0000000080402010,
+    0x0000000000804020, 0x0000000000008040, 0x0000000000000080,
+};
+
+// Diagonals that go from the top right to the bottom left.
+static const RevBitboard diag7_masks[15] = {
+    0x0000000000000001, 0x0000000000000102, 0x0000000000010204, 0x0000000001020408,
+    0x0000000102040810, 0x0000010204081020, 0x0001020408102040, 0x0102040810204080,
+    0x0204081020408000, 0x0408102040800000, 0x0810204080000000, 0x1020408000000000,
+    0x2040800000000000, 0x4080000000000000, 0x8000000000000000,
+};
+
+// Squares next to the edge in each direction. A disk can't be outflanked from the outside.
+#define EDGE_LEFT 0x0101010101010101
+#define EDGE_RIGHT 0x8080808080808080
+#define EDGE_TOP 0x00000000000000ff
+#define EDGE_BOTTOM 0xff00000000000000
+
+static inline RevBitboard getFullRows(RevBitboard filled) {
+    RevBitboard f = filled;
+    f &= f >> 1;
+    f &= f >> 2;
+    f &= f >> 4;
+    return (f & EDGE_LEFT) * 0xff;
+}
+
+static inline RevBitboard getFullColumns(RevBitboard filled) {
+    RevBitboard f = filled;
+    f &= f >> 8;
+    f &= f >> 16;
+    f &= f >> 32;
+    return (f & EDGE_TOP) * EDGE_LEFT;
+}
+
+static inline RevBitboard getFullDiagonals(RevBitboard filled, const RevBitboard *masks) {
+    RevBitboard full = 0;
+    for (int i = 0; i < 15; i++)
+        full |= masks[i] & -(RevBitboard)((filled & masks[i]) == masks[i]);
+    return full;
+}
+
+RevBitboard calcStableDisks(RevBitboard p_board, RevBitboard o_board) {
+    const RevBitboard filled = p_board | o_board;
+    const RevBitboard full_h = getFullRows(filled);
+    const RevBitboard full_v = getFullColumns(filled);
+    const RevBitboard full_d9 = getFullDiagonals(filled, diag9_masks);
+    const RevBitboard full_d7 = getFullDiagonals(filled, diag7_masks);
+
+    // A disk is stable when every line through it is full or is blocked by the edge or
+    // by a stable disk of the same color on one side. Grow the set from the edges until
+    // it stops changing. Each disk only relies on disks that were added before it.
+    RevBitboard stable = 0;
+    RevBitboard prev;
+    do {
+        prev = stable;
+        const RevBitboard h = full_h | EDGE_LEFT | EDGE_RIGHT |
+                              ((stable << 1) & 0xfefefefefefefefe) |
+                              ((stable >> 1) & 0x7f7f7f7f7f7f7f7f);
+        const RevBitboard v = full_v | EDGE_TOP | EDGE_BOTTOM | (stable << 8) | (stable >> 8);
+        const RevBitboard d9 = full_d9 | EDGE_LEFT | EDGE_TOP | EDGE_RIGHT | EDGE_BOTTOM |
+                               ((stable << 9) & 0xfefefefefefefefe) |
+                               ((stable >> 9) & 0x7f7f7f7f7f7f7f7f);
+        const RevBitboard d7 = full_d7 | EDGE_LEFT | EDGE_TOP | EDGE_RIGHT | EDGE_BOTTOM |
+                               ((stable << 7) & 0x7f7f7f7f7f7f7f7f) |
+                               ((stable >> 7) & 0xfefefefefefefefe);
+        stable |= p_board & h & v & d9 & d7;
+    } while (stable != prev);
+    return stable;
+}
+
+RevBitboard revGetStableDisks(RevBoard *board, RevDiskType disk_type) {
+    if (disk_type > DISK_WHITE) return 0;
+    return calcStableDisks(board->bitboards[disk_type], board->bitboards[!disk_type]);
+}
@@ -0,0 +1,108 @@
+#include <stdlib.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include "thread.h"
+
+// Arguments for threadEntry(). The new thread frees it.
+typedef struct ThreadStart {
+    ThreadFunc func;
+    void *arg;
+} ThreadStart;
+
+#ifdef _WIN32
+
+static DWORD WINAPI threadEntry(LPVOID param) {
+    ThreadStart start = *(ThreadStart *)param;
+    free(param);
+    start.func(start.arg);
+    return 0;
+}
+
+int threadCreate(Thread *thread, ThreadFunc func, void *arg) {
+    ThreadStart *start = (ThreadStart *)malloc(sizeof(ThreadStart));
+    if (start == NULL) return 1;
+    start->func = func;
+    start->arg = arg;
+    *thread = CreateThread(NULL, 0, threadEntry, start, 0, NULL);
+    if (*thread == NULL) {
+        free(start);
+        return 1;
+    }
+    return 0;
+}
+
+void threadJoin(Thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+void mutexInit(Mutex *mutex) { InitializeCriticalSection(mutex); }
+void mutexDestroy(Mutex *mutex) { DeleteCriticalSection(mutex); }
+void mutexLock(Mutex *mutex) { EnterCriticalSection(mutex); }
+void mutexUnlock(Mutex *mutex) { LeaveCriticalSection(mutex); }
+
+void condInit(Cond *cond) { InitializeConditionVariable(cond); }
+void condDestroy(Cond *cond) { (void)cond; }
+void condWait(Cond *cond, Mutex *mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); }
+void condBroadcast(Cond *cond) { WakeAllConditionVariable(cond); }
+
+// Fiber local storage calls its callback when a thread exits, like pthread keys.
+int threadKeyCreate(ThreadKey *key, ThreadKeyDestructor destructor) {
+    *key = FlsAlloc(destructor);
+    return *key == FLS_OUT_OF_INDEXES;
+}
+
+void threadKeySet(ThreadKey key, void *value) { FlsSetValue(key, value); }
+
+int getCpuCount(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+}
+
+#else
+
+static void *threadEntry(void *param) {
+    ThreadStart start = *(ThreadStart *)param;
+    free(param);
+    start.func(start.arg);
+    return NULL;
+}
+
+int threadCreate(Thread *thread, ThreadFunc func, void *arg) {
+    ThreadStart *start = (ThreadStart *)malloc(sizeof(ThreadStart));
+    if (start == NULL) return 1;
+    start->func = func;
+    start->arg = arg;
+    if (pthread_create(thread, NULL, threadEntry, start) != 0) {
+        free(start);
+        return 1;
+    }
+    return 0;
+}
+
+void threadJoin(Thread thread) { pthread_join(thread, NULL); }
+
+void mutexInit(Mutex *mutex) { pthread_mutex_init(mutex, NULL); }
+void mutexDestroy(Mutex *mutex) { pthread_mutex_destroy(mutex); }
+void mutexLock(Mutex *mutex) { pthread_mutex_lock(mutex); }
+void mutexUnlock(Mutex *mutex) { pthread_mutex_unlock(mutex); }
+
+void condInit(Cond *cond) { pthread_cond_init(cond, NULL); }
+void condDestroy(Cond *cond) { pthread_cond_destroy(cond); }
+void condWait(Cond *cond, Mutex *mutex) { pthread_cond_wait(cond, mutex); }
+void condBroadcast(Cond *cond) { pthread_cond_broadcast(cond); }
+
+int threadKeyCreate(ThreadKey *key, ThreadKeyDestructor destructor) {
+    return pthread_key_create(key, destructor);
+}
+
+void threadKeySet(ThreadKey key, void *value) { pthread_setspecific(key, value); }
+
+int getCpuCount(void) {
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0) ? (int)count : 1;
+}
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef __REVERSI_SRC_THREAD_H__
+#define __REVERSI_SRC_THREAD_H__
+#include <stdint.h>
+
+// Thin wrappers for threads on Windows and POSIX.
+
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE Thread;
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Cond;
+typedef DWORD ThreadKey;
+#define THREAD_KEY_CALL WINAPI
+#else
+#include <pthread.h>
+typedef pthread_t Thread;
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Cond;
+typedef pthread_key_t ThreadKey;
+#define THREAD_KEY_CALL
+#endif
+
+typedef void (*ThreadFunc)(void *arg);
+
+// Returns the number of logical processors.
+int getCpuCount(void);
+
+// Returns zero on success.
+int threadCreate(Thread *thread, ThreadFunc func, void *arg);
+void threadJoin(Thread thread);
+
+void mutexInit(Mutex *mutex);
+void mutexDestroy(Mutex *mutex);
+void mutexLock(Mutex *mutex);
+void mutexUnlock(Mutex *mutex);
+
+void condInit(Cond *cond);
+void condDestroy(Cond *cond);
+void condWait(Cond *cond, Mutex *mutex);
+void condBroadcast(Cond *cond);
+
+// Thread-local slots with a destructor. When a thread exits with a non-NULL value in the slot,
+// the destructor is called with it on that thread. It works for threads that the library
+// didn't create, and it doesn't run for the main thread.
+typedef void (THREAD_KEY_CALL *ThreadKeyDestructor)(void *value);
+
+// Returns zero on success. Keys are never deleted.
+int threadKeyCreate(ThreadKey *key, ThreadKeyDestructor destructor);
+void threadKeySet(ThreadKey key, void *value);
+
+// Storage class for variables that each thread has its own copy of.
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+// Relaxed loads and stores for values that other threads write without locks.
+#ifdef _MSC_VER
+static inline int atomicLoadInt(const int *ptr) { return *(const volatile int *)ptr; }
+static inline void atomicStoreInt(int *ptr, int val) { *(volatile int *)ptr = val; }
+static inline uint64_t atomicLoadU64(const uint64_t *ptr) {
+    return *(const volatile uint64_t *)ptr;
+}
+static inline void atomicStoreU64(uint64_t *ptr, uint64_t val) {
+    *(volatile uint64_t *)ptr = val;
+}
+// Adds val and returns the previous value.
+static inline int atomicFetchAddInt(int *ptr, int val) {
+    return (int)InterlockedExchangeAdd((volatile LONG *)ptr, (LONG)val);
+}
+// Replaces *ptr with desired if it equals expected. Returns TRUE if it did.
+// It's a full barrier, so it also publishes and acquires other memory.
+static inline int atomicCompareExchangeInt(int *ptr, int expected, int desired) {
+    return InterlockedCompareExchange((volatile LONG *)ptr, (LONG)desired, (LONG)expected) ==
+           (LONG)expected;
+}
+static inline int atomicCompareExchangePtr(void **ptr, void *expected, void *desired) {
+    return InterlockedCompareExchangePointer((PVOID volatile *)ptr, desired, expected) ==
+           expected;
+}
+// Loads a pointer that was published with atomicStorePtr() or atomicCompareExchangePtr().
+static inline void *atomicLoadPtr(void **ptr) {
+    return InterlockedCompareExchangePointer((PVOID volatile *)ptr, NULL, NULL);
+}
+// Publishes a pointer with the memory that it points to.
+static inline void atomicStorePtr(void **ptr, void *val) {
+    InterlockedExchangePointer((PVOID volatile *)ptr, val);
+}
+#else
+static inline int atomicLoadInt(const int *ptr) { return __atomic_load_n(ptr, __ATOMIC_RELAXED); }
+static inline void atomicStoreInt(int *ptr, int val) {
+    __atomic_store_n(ptr, val, __ATOMIC_RELAXED);
+}
+static inline uint64_t atomicLoadU64(const uint64_t *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_RELAXED);
+}
+static inline void atomicStoreU64(uint64_t *ptr, uint64_t val) {
+    __atomic_store_n(ptr, val, __ATOMIC_RELAXED);
+}
+// Adds val and returns the previous value.
+static inline int atomicFetchAddInt(int *ptr, int val) {
+    return __atomic_fetch_add(ptr, val, __ATOMIC_RELAXED);
+}
+// Replaces *ptr with desired if it equals expected. Returns TRUE if it did.
+// It's a full barrier, so it also publishes and acquires other memory.
+static inline int atomicCompareExchangeInt(int *ptr, int expected, int desired) {
+    return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_SEQ_CST,
+                                       __ATOMIC_SEQ_CST);
+}
+static inline int atomicCompareExchangePtr(void **ptr, void *expected, void *desired) {
+    return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_SEQ_CST,
+                                       __ATOMIC_SEQ_CST);
+}
+// Loads a pointer that was published with atomicStorePtr() or atomicCompareExchangePtr().
+static inline void *atomicLoadPtr(void **ptr) { return __atomic_load_n(ptr, __ATOMIC_ACQUIRE); }
+// Publishes a pointer with the memory that it points to.
+static inline void atomicStorePtr(void **ptr, void *val) {
+    __atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+}
+#endif
+
+#endif  // __REVERSI_SRC_THREAD_H__
@@ -0,0 +1,41 @@
+#ifndef _WIN32
+// clock_gettime() is hidden in strict C99 mode.
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include "timer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+uint64_t getTimeMs(void) {
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (uint64_t)(count.QuadPart / (freq.QuadPart / 1000));
+}
+
+uint64_t getTimeNs(void) {
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    // Split the conversion so that count * 10^9 doesn't overflow.
+    const uint64_t f = (uint64_t)freq.QuadPart;
+    const uint64_t c = (uint64_t)count.QuadPart;
+    return (c / f) * 1000000000 + (c % f) * 1000000000 / f + 1;
+}
+#else
+#include <time.h>
+
+uint64_t getTimeMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+uint64_t getTimeNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    // Zero is reserved for "not measured".
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec + 1;
+}
+#endif
@@ -0,0 +1,12 @@
+#ifndef __REVERSI_SRC_TIMER_H__
+#define __REVERSI_SRC_TIMER_H__
+#include <stdint.h>
+
+// Returns elapsed milliseconds on a monotonic clock.
+// Only differences between two calls are meaningful.
+uint64_t getTimeMs(void);
+
+// Returns elapsed nanoseconds on the same clock. It's never zero.
+uint64_t getTimeNs(void);
+
+#endif  // __REVERSI_SRC_TIMER_H__
@@ -0,0 +1,169 @@
+#include "reversi.h"
+#include "internal.h"
+#include "eval.h"
+#include "thread.h"
+
+// Full-batch gradient descent for the pattern evaluation.
+// Each epoch has two phases. Workers add up the errors of their blocks of records
+// into their own gradients, and then each worker updates its range of weights with
+// the sum of all gradients. So, no locks or atomics are needed.
+
+#define WEIGHT_COUNT ((size_t)REV_EVAL_STAGES * REV_EVAL_WEIGHTS)
+
+typedef struct TrainWorker TrainWorker;
+
+typedef struct Trainer {
+    const RevEvalRecord *records;
+    size_t count;
+    int threads;
+    double learning_rate;
+    double *weights;  // WEIGHT_COUNT weights in disks
+    double *steps;  // Step size of each weight. Zero for weights that no records have.
+    TrainWorker *workers;
+    int counting;  // TRUE while workers count boards of each weight instead of errors.
+} Trainer;
+
+struct TrainWorker {
+    Trainer *trainer;
+    Thread thread;
+    int index;
+    double *gradient;  // WEIGHT_COUNT sums of errors. Cleared by updateWeights().
+    double loss;  // Sum of squared errors of the block
+};
+
+static void addGradients(TrainWorker *worker) {
+    const Trainer *t = worker->trainer;
+    const size_t begin = t->count * (size_t)worker->index / (size_t)t->threads;
+    const size_t end = t->count * (size_t)(worker->index + 1) / (size_t)t->threads;
+    double *gradient = worker->gradient;
+    double loss = 0;
+    int features[REV_EVAL_FEATURES];
+    for (size_t i = begin; i < end; i++) {
+        const RevEvalRecord *record = &t->records[i];
+        const int stage = getEvalFeatures(record->p_board, record->o_board, features);
+        const double *weights = t->weights + (size_t)stage * REV_EVAL_WEIGHTS;
+        double *stage_gradient = gradient + (size_t)stage * REV_EVAL_WEIGHTS;
+        double error = 1;  // Counts the board while counting.
+        if (!t->counting) {
+            double score = 0;
+            for (int j = 0; j < REV_EVAL_FEATURES; j++)
+                score += weights[features[j]];
+            error = record->score - score;
+            loss += error * error;
+        }
+        for (int j = 0; j < REV_EVAL_FEATURES; j++)
+            stage_gradient[features[j]] += error;
+    }
+    worker->loss = loss;
+}
+
+static void updateWeights(TrainWorker *worker) {
+    Trainer *t = worker->trainer;
+    const size_t begin = WEIGHT_COUNT * (size_t)worker->index / (size_t)t->threads;
+    const size_t end = WEIGHT_COUNT * (size_t)(worker->index + 1) / (size_t)t->threads;
+    for (size_t k = begin; k < end; k++) {
+        double sum = 0;
+        for (int i = 0; i < t->threads; i++) {
+            sum += t->workers[i].gradient[k];
+            t->workers[i].gradient[k] = 0;
+        }
+        if (t->counting)
+            t->steps[k] = (sum > 0) ? t->learning_rate / REV_EVAL_FEATURES / sum : 0;
+        else
+            t->weights[k] += t->steps[k] * sum;
+    }
+}
+
+static void gradientThread(void *arg) {
+    addGradients((TrainWorker *)arg);
+}
+
+static void updateThread(void *arg) {
+    updateWeights((TrainWorker *)arg);
+}
+
+// Runs func for every worker, and waits for all of them.
+static void runWorkers(Trainer *t, ThreadFunc func) {
+    // The caller's thread works as one of the workers.
+    int started = 1;
+    for (; started < t->threads; started++) {
+        if (threadCreate(&t->workers[started].thread, func, &t->workers[started]) != 0)
+            break;
+    }
+    func(&t->workers[0]);
+    // Blocks of workers that failed to start are done by the caller's thread.
+    for (int i = started; i < t->threads; i++)
+        func(&t->workers[i]);
+    for (int i = 1; i < started; i++)
+        threadJoin(t->workers[i].thread);
+}
+
+void revInitTrainParams(RevTrainParams *params) {
+    params->threads = 0;
+    params->epochs = 20;
+    params->learning_rate = 1.0;
+    params->callback = NULL;
+    params->user_data = NULL;
+}
+
+static void freeTrainer(Trainer *t) {
+    if (t->workers != NULL) {
+        for (int i = 0; i < t->threads; i++)
+            free(t->workers[i].gradient);
+    }
+    free(t->workers);
+    free(t->weights);
+    free(t->steps);
+}
+
+int revTrainEvalWeights(RevEvalWeights *weights, const RevEvalRecord *records,
+                        size_t count, const RevTrainParams *params) {
+    if (count == 0) return 1;
+    Trainer t;
+    t.records = records;
+    t.count = count;
+    t.threads = (params->threads > 0) ? params->threads : getCpuCount();
+    t.learning_rate = params->learning_rate;
+    t.weights = (double *)malloc(sizeof(double) * WEIGHT_COUNT);
+    t.steps = (double *)malloc(sizeof(double) * WEIGHT_COUNT);
+    t.workers = (TrainWorker *)calloc((size_t)t.threads, sizeof(TrainWorker));
+    int ok = t.weights != NULL && t.steps != NULL && t.workers != NULL;
+    for (int i = 0; ok && i < t.threads; i++) {
+        t.workers[i].trainer = &t;
+        t.workers[i].index = i;
+        t.workers[i].gradient = (double *)calloc(WEIGHT_COUNT, sizeof(double));
+        ok = t.workers[i].gradient != NULL;
+    }
+    if (!ok) {
+        freeTrainer(&t);
+        return 0;
+    }
+
+    const int16_t *initial = &weights->weights[0][0];
+    for (size_t k = 0; k < WEIGHT_COUNT; k++)
+        t.weights[k] = (double)initial[k] / EVAL_SCALE;
+
+    // Steps are normalized by the number of boards that have each weight,
+    // so rare patterns learn as fast as common ones.
+    t.counting = 1;
+    runWorkers(&t, gradientThread);
+    runWorkers(&t, updateThread);
+    t.counting = 0;
+    for (int epoch = 1; epoch <= params->epochs; epoch++) {
+        runWorkers(&t, gradientThread);
+        runWorkers(&t, updateThread);
+        if (params->callback != NULL) {
+            double loss = 0;
+            for (int i = 0; i < t.threads; i++)
+                loss += t.workers[i].loss;
+            params->callback(epoch, loss / (double)count, params->user_data);
+        }
+    }
+
+    for (size_t k = 0; k < WEIGHT_COUNT; k++) {
+        revSetEvalWeight(weights, (int)(k / REV_EVAL_WEIGHTS), (int)(k % REV_EVAL_WEIGHTS),
+                         t.weights[k]);
+    }
+    freeTrainer(&t);
+    return 1;
+}
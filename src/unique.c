@@ -0,0 +1,578 @@
+#include <stdio.h>
+#include <string.h>
+#include "reversi.h"
+#include "internal.h"
+#include "thread.h"
+
+// Positions are expanded level by level. Each level is a sorted array of unique keys,
+// kept in memory while it fits in half of the budget, or in a temporary file.
+// Workers expand blocks of the previous level into their own buffers.
+// A full buffer is sorted, deduplicated, and written as a run.
+// Runs are merged into the next level, which removes duplicates between runs.
+
+// Number of keys that a worker takes from the previous level at once.
+#define INPUT_BLOCK 4096
+
+// Number of keys that each run reads from its file at once while merging.
+#define MERGE_BLOCK 4096
+
+// A position from the side to move. Colors are not stored, so a position and its
+// color-swapped copy are the same position.
+typedef struct UniqueKey {
+    RevBitboard p_board;
+    RevBitboard o_board;
+} UniqueKey;
+
+static inline int keyLess(const UniqueKey *a, const UniqueKey *b) {
+    return a->p_board < b->p_board || (a->p_board == b->p_board && a->o_board < b->o_board);
+}
+
+static inline int keyEqual(const UniqueKey *a, const UniqueKey *b) {
+    return a->p_board == b->p_board && a->o_board == b->o_board;
+}
+
+// Returns the smallest key of the 8 symmetric copies of a position.
+static UniqueKey canonicalKey(RevBitboard p_board, RevBitboard o_board) {
+    UniqueKey best = { p_board, o_board };
+    UniqueKey key = best;
+    for (int i = 1; i < 8; i++) {
+        // Transforms are applied to the previous copy. The sequence visits all 8 copies.
+        if (i == 4) {
+            key.p_board = flipDiagonal(key.p_board);
+            key.o_board = flipDiagonal(key.o_board);
+        } else if (i & 1) {
+            key.p_board = flipVertical(key.p_board);
+            key.o_board = flipVertical(key.o_board);
+        } else {
+            key.p_board = mirrorHorizontal(key.p_board);
+            key.o_board = mirrorHorizontal(key.o_board);
+        }
+        if (keyLess(&key, &best)) best = key;
+    }
+    return best;
+}
+
+static void insertionSort(UniqueKey *keys, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        const UniqueKey key = keys[i];
+        size_t j = i;
+        for (; j > 0 && keyLess(&key, &keys[j - 1]); j--)
+            keys[j] = keys[j - 1];
+        keys[j] = key;
+    }
+}
+
+// Quicksort with the comparison inlined. qsort() is several times slower on 16-byte keys.
+static void sortKeys(UniqueKey *keys, size_t count) {
+    while (count > 16) {
+        // Median of three
+        UniqueKey *a = &keys[0];
+        UniqueKey *b = &keys[count / 2];
+        UniqueKey *c = &keys[count - 1];
+        const UniqueKey *m = keyLess(a, b) ? (keyLess(b, c) ? b : keyLess(a, c) ? c : a)
+                                           : (keyLess(a, c) ? a : keyLess(b, c) ? c : b);
+        const UniqueKey pivot = *m;
+        size_t i = 0;
+        size_t j = count - 1;
+        for (;;) {
+            while (keyLess(&keys[i], &pivot)) i++;
+            while (keyLess(&pivot, &keys[j])) j--;
+            if (i >= j) break;
+            const UniqueKey tmp = keys[i];
+            keys[i] = keys[j];
+            keys[j] = tmp;
+            i++;
+            j--;
+        }
+        // Recurse into the smaller part so the stack depth stays logarithmic.
+        const size_t left = j + 1;
+        if (left < count - left) {
+            sortKeys(keys, left);
+            keys += left;
+            count -= left;
+        } else {
+            sortKeys(keys + left, count - left);
+            count = left;
+        }
+    }
+    insertionSort(keys, count);
+}
+
+// Sorts keys and removes duplicates. Returns the new count.
+static size_t sortUnique(UniqueKey *keys, size_t count) {
+    if (count == 0) return 0;
+    sortKeys(keys, count);
+    size_t unique = 1;
+    for (size_t i = 1; i < count; i++) {
+        if (!keyEqual(&keys[i], &keys[unique - 1]))
+            keys[unique++] = keys[i];
+    }
+    return unique;
+}
+
+// A temporary file. path is NULL when it's from tmpfile().
+typedef struct KeyFile {
+    FILE *file;
+    char *path;
+} KeyFile;
+
+static int openKeyFile(KeyFile *file, const char *dir) {
+    file->path = NULL;
+    if (dir == NULL) {
+        file->file = tmpfile();
+        return file->file != NULL;
+    }
+    const size_t size = strlen(dir) + 64;
+    file->path = (char *)malloc(size);
+    if (file->path == NULL) return 0;
+    // A random name, so processes that share the directory don't collide.
+    snprintf(file->path, size, "%s/reversi_unique_%016llx.tmp", dir,
+             (unsigned long long)genSeed64());
+    file->file = fopen(file->path, "w+b");
+    if (file->file == NULL) {
+        free(file->path);
+        file->path = NULL;
+        return 0;
+    }
+    return 1;
+}
+
+static void closeKeyFile(KeyFile *file) {
+    if (file->file != NULL) fclose(file->file);
+    if (file->path != NULL) {
+        remove(file->path);
+        free(file->path);
+    }
+    file->file = NULL;
+    file->path = NULL;
+}
+
+// Sorted unique keys in memory or in a file.
+typedef struct Run {
+    UniqueKey *keys;  // NULL when keys are in file.
+    KeyFile file;
+    uint64_t count;
+} Run;
+
+static void freeRun(Run *run) {
+    free(run->keys);
+    run->keys = NULL;
+    closeKeyFile(&run->file);
+    run->count = 0;
+}
+
+typedef struct Enumerator {
+    const RevEnumParams *params;
+    int threads;
+    size_t buffer_keys;  // Size of each worker's buffer.
+    size_t memory_keys;  // A level is kept in memory up to this size.
+    Run input;  // The previous level
+    uint64_t next_input;  // Index of the next key to expand. Protected by lock.
+    Run *runs;  // Runs that were written to files. Protected by lock.
+    int run_count;
+    int run_capacity;
+    int failed;  // TRUE when an allocation or a file operation failed.
+    Mutex lock;
+} Enumerator;
+
+typedef struct Worker {
+    Thread thread;
+    Enumerator *e;
+    UniqueKey *buffer;
+    size_t count;
+    UniqueKey input[INPUT_BLOCK];
+} Worker;
+
+static void setFailed(Enumerator *e) {
+    mutexLock(&e->lock);
+    e->failed = 1;
+    mutexUnlock(&e->lock);
+}
+
+// Sorts the worker's buffer and writes it as a run.
+static void spillBuffer(Worker *worker) {
+    Enumerator *e = worker->e;
+    const size_t count = sortUnique(worker->buffer, worker->count);
+    worker->count = 0;
+    Run run;
+    run.keys = NULL;
+    run.count = count;
+    if (!openKeyFile(&run.file, e->params->temp_dir)) {
+        setFailed(e);
+        return;
+    }
+    if (fwrite(worker->buffer, sizeof(UniqueKey), count, run.file.file) != count) {
+        closeKeyFile(&run.file);
+        setFailed(e);
+        return;
+    }
+
+    mutexLock(&e->lock);
+    if (e->run_count == e->run_capacity) {
+        const int capacity = (e->run_capacity > 0) ? e->run_capacity * 2 : 16;
+        Run *runs = (Run *)realloc(e->runs, sizeof(Run) * capacity);
+        if (runs == NULL) {
+            e->failed = 1;
+            mutexUnlock(&e->lock);
+            closeKeyFile(&run.file);
+            return;
+        }
+        e->runs = runs;
+        e->run_capacity = capacity;
+    }
+    e->runs[e->run_count++] = run;
+    mutexUnlock(&e->lock);
+}
+
+// Takes the next block of the previous level. Returns the number of keys.
+static size_t takeInput(Worker *worker, const UniqueKey **keys) {
+    Enumerator *e = worker->e;
+    mutexLock(&e->lock);
+    size_t count = 0;
+    if (!e->failed && e->next_input < e->input.count) {
+        const uint64_t rest = e->input.count - e->next_input;
+        count = (rest < INPUT_BLOCK) ? (size_t)rest : INPUT_BLOCK;
+        if (e->input.keys != NULL) {
+            *keys = e->input.keys + e->next_input;
+        } else {
+            // Blocks are taken in order, so the file is read sequentially.
+            if (fread(worker->input, sizeof(UniqueKey), count, e->input.file.file) != count) {
+                e->failed = 1;
+                count = 0;
+            }
+            *keys = worker->input;
+        }
+        e->next_input += count;
+    }
+    mutexUnlock(&e->lock);
+    return count;
+}
+
+static void expandPositions(Worker *worker) {
+    Enumerator *e = worker->e;
+    const UniqueKey *keys;
+    size_t count;
+    while ((count = takeInput(worker, &keys)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            const RevBitboard p_board = keys[i].p_board;
+            const RevBitboard o_board = keys[i].o_board;
+            // A position has 33 legal moves at most.
+            if (worker->count + 64 > e->buffer_keys) {
+                spillBuffer(worker);
+                if (atomicLoadInt(&e->failed)) return;
+            }
+            for (RevBitboard m = calcMobility(p_board, o_board); m; m &= m - 1) {
+                const int pos = firstOnePos(m);
+                const RevBitboard flipped = calcFlipped(p_board, o_board, pos);
+                const RevBitboard next_p = o_board ^ flipped;
+                const RevBitboard next_o = p_board ^ flipped ^ ((RevBitboard)1 << pos);
+                // Positions are stored from the side that moves next.
+                // When the opponent has to pass, it's the same player.
+                UniqueKey *key = &worker->buffer[worker->count++];
+                if (calcMobility(next_p, next_o) == 0 && calcMobility(next_o, next_p) != 0)
+                    *key = canonicalKey(next_o, next_p);
+                else
+                    *key = canonicalKey(next_p, next_o);
+            }
+        }
+    }
+}
+
+static void workerThread(void *arg) {
+    expandPositions((Worker *)arg);
+}
+
+// Cursor of a run while merging.
+typedef struct MergeCursor {
+    Run *run;
+    const UniqueKey *keys;
+    size_t pos;
+    size_t count;
+    uint64_t rest;  // Keys that are not loaded yet
+    UniqueKey *block;  // Read buffer for runs in files
+} MergeCursor;
+
+// Loads the next keys of a run. Returns FALSE when the run is finished or broken.
+static int fillCursor(MergeCursor *cursor) {
+    if (cursor->rest == 0) return 0;
+    if (cursor->run->keys != NULL) {
+        cursor->keys = cursor->run->keys;
+        cursor->count = (size_t)cursor->rest;
+    } else {
+        cursor->count = (cursor->rest < MERGE_BLOCK) ? (size_t)cursor->rest : MERGE_BLOCK;
+        if (fread(cursor->block, sizeof(UniqueKey), cursor->count, cursor->run->file.file) !=
+            cursor->count)
+            return 0;
+        cursor->keys = cursor->block;
+    }
+    cursor->rest -= cursor->count;
+    cursor->pos = 0;
+    return 1;
+}
+
+static inline const UniqueKey *cursorKey(const MergeCursor *cursor) {
+    return &cursor->keys[cursor->pos];
+}
+
+// Restores the heap order from heap[i] downwards.
+static void siftDown(MergeCursor **heap, int size, int i) {
+    for (;;) {
+        int min = i;
+        const int l = 2 * i + 1;
+        const int r = l + 1;
+        if (l < size && keyLess(cursorKey(heap[l]), cursorKey(heap[min]))) min = l;
+        if (r < size && keyLess(cursorKey(heap[r]), cursorKey(heap[min]))) min = r;
+        if (min == i) return;
+        MergeCursor *tmp = heap[i];
+        heap[i] = heap[min];
+        heap[min] = tmp;
+        i = min;
+    }
+}
+
+// Output of a merge. Keys go to memory, a file, or nowhere.
+typedef struct MergeOutput {
+    UniqueKey *keys;  // Can be NULL.
+    FILE *file;  // Can be NULL.
+    UniqueKey block[MERGE_BLOCK];
+    size_t block_count;
+    uint64_t count;
+    int failed;
+} MergeOutput;
+
+static void flushOutput(MergeOutput *out) {
+    if (out->file != NULL && out->block_count > 0 &&
+        fwrite(out->block, sizeof(UniqueKey), out->block_count, out->file) != out->block_count)
+        out->failed = 1;
+    out->block_count = 0;
+}
+
+static inline void pushOutput(MergeOutput *out, const UniqueKey *key) {
+    if (out->keys != NULL) {
+        out->keys[out->count] = *key;
+    } else if (out->file != NULL) {
+        out->block[out->block_count++] = *key;
+        if (out->block_count == MERGE_BLOCK) flushOutput(out);
+    }
+    out->count++;
+}
+
+// Merges runs into out and removes duplicates. Returns FALSE when it failed.
+static int mergeRuns(Run *runs, int run_count, MergeOutput *out) {
+    MergeCursor *cursors = (MergeCursor *)calloc((size_t)run_count, sizeof(MergeCursor));
+    MergeCursor **heap = (MergeCursor **)malloc(sizeof(MergeCursor *) * (size_t)run_count);
+    int ok = cursors != NULL && heap != NULL;
+    int size = 0;
+    for (int i = 0; ok && i < run_count; i++) {
+        MergeCursor *cursor = &cursors[i];
+        cursor->run = &runs[i];
+        cursor->rest = runs[i].count;
+        if (runs[i].keys == NULL) {
+            cursor->block = (UniqueKey *)malloc(sizeof(UniqueKey) * MERGE_BLOCK);
+            if (cursor->block == NULL || fseek(runs[i].file.file, 0, SEEK_SET) != 0) {
+                ok = 0;
+                break;
+            }
+        }
+        if (fillCursor(cursor))
+            heap[size++] = cursor;
+        else if (runs[i].count > 0)
+            ok = 0;
+    }
+    for (int i = size / 2 - 1; i >= 0; i--)
+        siftDown(heap, size, i);
+
+    UniqueKey last;
+    int has_last = 0;
+    while (ok && size > 0) {
+        MergeCursor *cursor = heap[0];
+        const UniqueKey *key = cursorKey(cursor);
+        if (!has_last || !keyEqual(key, &last)) {
+            last = *key;
+            has_last = 1;
+            pushOutput(out, key);
+        }
+        if (++cursor->pos == cursor->count) {
+            if (!fillCursor(cursor)) {
+                if (cursor->rest > 0) ok = 0;
+                heap[0] = heap[--size];
+            }
+        }
+        siftDown(heap, size, 0);
+    }
+    flushOutput(out);
+
+    if (cursors != NULL) {
+        for (int i = 0; i < run_count; i++)
+            free(cursors[i].block);
+    }
+    free(cursors);
+    free(heap);
+    return ok && !out->failed;
+}
+
+// Writes the last level to path.
+static int writeLevel(Run *level, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) return 0;
+    MergeOutput *out = (MergeOutput *)malloc(sizeof(MergeOutput));
+    int ok = out != NULL;
+    if (ok) {
+        out->keys = NULL;
+        out->file = file;
+        out->block_count = 0;
+        out->count = 0;
+        out->failed = 0;
+        ok = mergeRuns(level, 1, out);
+    }
+    free(out);
+    return fclose(file) == 0 && ok;
+}
+
+void revInitEnumParams(RevEnumParams *params) {
+    params->threads = 0;
+    params->memory_mb = 1024;
+    params->temp_dir = NULL;
+    params->output_path = NULL;
+    params->callback = NULL;
+    params->user_data = NULL;
+}
+
+// Expands e->input into the next level. Returns FALSE when it failed.
+static int expandLevel(Enumerator *e, Run *next) {
+    // next is freed on every failure, so it has to be empty before the first one.
+    next->keys = NULL;
+    next->file.file = NULL;
+    next->file.path = NULL;
+    next->count = 0;
+    Worker *workers = (Worker *)calloc((size_t)e->threads, sizeof(Worker));
+    if (workers == NULL) return 0;
+    int ok = 1;
+    for (int i = 0; i < e->threads; i++) {
+        workers[i].e = e;
+        workers[i].buffer = (UniqueKey *)malloc(sizeof(UniqueKey) * e->buffer_keys);
+        if (workers[i].buffer == NULL) ok = 0;
+    }
+
+    if (ok) {
+        e->next_input = 0;
+        e->run_count = 0;
+        e->failed = 0;
+        if (e->input.keys == NULL && fseek(e->input.file.file, 0, SEEK_SET) != 0)
+            e->failed = 1;
+        // The caller's thread works as one of the workers.
+        int started = 1;
+        for (; started < e->threads; started++) {
+            if (threadCreate(&workers[started].thread, workerThread, &workers[started]) != 0)
+                break;
+        }
+        expandPositions(&workers[0]);
+        for (int i = 1; i < started; i++)
+            threadJoin(workers[i].thread);
+        ok = !e->failed;
+    }
+    freeRun(&e->input);
+
+    // The rest of each buffer is merged from memory.
+    Run *runs = NULL;
+    int run_count = 0;
+    uint64_t total = 0;
+    if (ok) {
+        runs = (Run *)malloc(sizeof(Run) * (size_t)(e->run_count + e->threads));
+        ok = runs != NULL;
+    }
+    if (ok) {
+        for (int i = 0; i < e->run_count; i++)
+            runs[run_count++] = e->runs[i];
+        for (int i = 0; i < e->threads; i++) {
+            Run *run = &runs[run_count++];
+            run->keys = workers[i].buffer;
+            run->file.file = NULL;
+            run->file.path = NULL;
+            run->count = sortUnique(workers[i].buffer, workers[i].count);
+        }
+        for (int i = 0; i < run_count; i++)
+            total += runs[i].count;
+    }
+
+    // The next level stays in memory when it surely fits.
+    MergeOutput *out = NULL;
+    if (ok) {
+        out = (MergeOutput *)malloc(sizeof(MergeOutput));
+        ok = out != NULL;
+    }
+    if (ok) {
+        out->keys = NULL;
+        out->file = NULL;
+        out->block_count = 0;
+        out->count = 0;
+        out->failed = 0;
+        if (total <= e->memory_keys) {
+            next->keys = (UniqueKey *)malloc(sizeof(UniqueKey) * (size_t)(total > 0 ? total : 1));
+            out->keys = next->keys;
+        }
+        if (next->keys == NULL) {
+            ok = openKeyFile(&next->file, e->params->temp_dir);
+            out->file = next->file.file;
+        }
+    }
+    if (ok) ok = mergeRuns(runs, run_count, out);
+    if (ok) next->count = out->count;
+    free(out);
+
+    for (int i = 0; i < e->run_count; i++)
+        closeKeyFile(&e->runs[i].file);
+    e->run_count = 0;
+    for (int i = 0; i < e->threads; i++)
+        free(workers[i].buffer);
+    free(workers);
+    free(runs);
+    if (!ok) freeRun(next);
+    return ok;
+}
+
+int revCountUniquePositions(int depth, const RevEnumParams *params, uint64_t *counts) {
+    if (depth < 0) return 0;
+    Enumerator e;
+    e.params = params;
+    e.threads = (params->threads > 0) ? params->threads : getCpuCount();
+    // Half of the memory is for buffers of workers, and the other half is for a level.
+    const size_t memory = (size_t)((params->memory_mb > 0) ? params->memory_mb : 1) << 20;
+    e.memory_keys = memory / 2 / sizeof(UniqueKey);
+    e.buffer_keys = e.memory_keys / (size_t)e.threads;
+    if (e.buffer_keys < 1024) e.buffer_keys = 1024;
+    e.runs = NULL;
+    e.run_count = 0;
+    e.run_capacity = 0;
+    e.failed = 0;
+    mutexInit(&e.lock);
+
+    RevBoard board;
+    revInitBoard(&board);
+    e.input.keys = (UniqueKey *)malloc(sizeof(UniqueKey));
+    e.input.file.file = NULL;
+    e.input.file.path = NULL;
+    e.input.count = 1;
+    int ok = e.input.keys != NULL;
+    if (ok) {
+        e.input.keys[0] = canonicalKey(board.bitboards[board.current_player],
+                                       board.bitboards[!board.current_player]);
+        counts[0] = 1;
+        if (params->callback != NULL) params->callback(0, 1, params->user_data);
+    }
+    for (int ply = 1; ok && ply <= depth; ply++) {
+        Run next;
+        ok = expandLevel(&e, &next);
+        if (!ok) break;
+        counts[ply] = next.count;
+        if (params->callback != NULL) params->callback(ply, next.count, params->user_data);
+        e.input = next;
+    }
+    if (ok && params->output_path != NULL)
+        ok = writeLevel(&e.input, params->output_path);
+
+    freeRun(&e.input);
+    free(e.runs);
+    mutexDestroy(&e.lock);
+    return ok;
+}
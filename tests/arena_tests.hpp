@@ -0,0 +1,134 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <vector>
+#include "reversi.h"
+
+class ArenaTest : public ::testing::Test {
+ protected:
+    RevGameArena* arena;
+
+    virtual void SetUp() {
+        arena = revNewGameArena();
+        ASSERT_TRUE(arena != NULL);
+    }
+
+    virtual void TearDown() {
+        revFreeGameArena(arena);
+    }
+};
+
+TEST_F(ArenaTest, revArenaNewGame) {
+    RevGameHandle a = revArenaNewGame(arena);
+    RevGameHandle b = revArenaNewGame(arena);
+    ASSERT_NE(REV_NO_GAME, a);
+    ASSERT_NE(a, b);
+    EXPECT_EQ(2, revArenaGetGameCount(arena));
+    RevBoard *board = revArenaGetBoard(arena, a);
+    ASSERT_TRUE(board != NULL);
+    EXPECT_EQ(4, revGetMobilityCount(board));
+
+    // The slot is reused, but the old handle doesn't reach the new game.
+    revArenaFreeGame(arena, a);
+    EXPECT_EQ(1, revArenaGetGameCount(arena));
+    EXPECT_TRUE(revArenaGetBoard(arena, a) == NULL);
+    EXPECT_FALSE(revArenaMove(arena, a, 19));
+    RevGameHandle c = revArenaNewGame(arena);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(board, revArenaGetBoard(arena, c));
+    EXPECT_TRUE(revArenaGetBoard(arena, a) == NULL);
+    revArenaFreeGame(arena, a);  // Stale handles are ignored.
+    EXPECT_EQ(2, revArenaGetGameCount(arena));
+    EXPECT_TRUE(revArenaGetBoard(arena, REV_NO_GAME) == NULL);
+}
+
+TEST_F(ArenaTest, revArenaManyGames) {
+    // Boards don't move when slabs are added.
+    std::vector<RevGameHandle> handles;
+    std::vector<RevBoard *> boards;
+    handles.reserve(5000);
+    for (int i = 0; i < 5000; i++) {
+        handles.push_back(revArenaNewGame(arena));
+        boards.push_back(revArenaGetBoard(arena, handles.back()));
+        revArenaSetUserData(arena, handles.back(), &handles[0] + i);
+    }
+    for (int i = 0; i < 5000; i++) {
+        ASSERT_EQ(boards[i], revArenaGetBoard(arena, handles[i]));
+        ASSERT_EQ(&handles[0] + i, revArenaGetUserData(arena, handles[i]));
+        EXPECT_EQ(0u, (uintptr_t)boards[i] % 64);
+    }
+    for (int i = 0; i < 5000; i += 2)
+        revArenaFreeGame(arena, handles[i]);
+    EXPECT_EQ(2500, revArenaGetGameCount(arena));
+}
+
+TEST_F(ArenaTest, revArenaGetHistory) {
+    RevGameHandle handle = revArenaNewGame(arena);
+    RevBoard *board = revArenaGetBoard(arena, handle);
+    while (revHasLegalMoves(board))
+        ASSERT_TRUE(revArenaMove(arena, handle, revGenMoveRandom(board)));
+    EXPECT_FALSE(revArenaMove(arena, handle, 0));
+
+    // Replaying the history gives the same board.
+    int moves[128];
+    const int count = revArenaGetHistory(arena, handle, moves, 128);
+    ASSERT_GT(count, 0);
+    ASSERT_LE(count, 128);
+    RevBoard *replay = revNewBoard();
+    for (int i = 0; i < count; i++) {
+        if (moves[i] < 0) {
+            EXPECT_FALSE(revHasLegalMoves(replay));
+            revChangePlayer(replay);
+        } else {
+            ASSERT_TRUE(revIsLegalMove(replay, moves[i]));
+            revMove(replay, moves[i]);
+        }
+    }
+    EXPECT_EQ(revGetBitboard(board, DISK_BLACK), revGetBitboard(replay, DISK_BLACK));
+    EXPECT_EQ(revGetBitboard(board, DISK_WHITE), revGetBitboard(replay, DISK_WHITE));
+    revFreeBoard(replay);
+    EXPECT_EQ(count, revArenaGetHistory(arena, handle, moves, 3));
+}
+
+TEST_F(ArenaTest, revArenaNextWaitingGames) {
+    const int count = 3000;
+    std::vector<RevGameHandle> handles;
+    for (int i = 0; i < count; i++) {
+        handles.push_back(revArenaNewGame(arena));
+        if (i % 3 == 0)
+            revArenaSetAIPlayers(arena, handles.back(), REV_ARENA_AI_BLACK);
+        else if (i % 3 == 1)
+            revArenaSetAIPlayers(arena, handles.back(), REV_ARENA_AI_WHITE);
+    }
+
+    // Play all games to the end. Games of the third group have no AI.
+    int sweeps = 0;
+    for (;;) {
+        std::vector<RevGameHandle> waiting(256);
+        std::vector<RevBoard *> boards(256);
+        int cursor = 0;
+        int total = 0;
+        int n;
+        while ((n = revArenaNextWaitingGames(arena, &cursor, &waiting[0], &boards[0], 256)) > 0) {
+            for (int i = 0; i < n; i++) {
+                ASSERT_EQ(boards[i], revArenaGetBoard(arena, waiting[i]));
+                ASSERT_TRUE(revHasLegalMoves(boards[i]));
+                ASSERT_TRUE(revArenaMove(arena, waiting[i], revGenMoveRandom(boards[i])));
+            }
+            total += n;
+        }
+        for (int i = 0; i < count; i++) {
+            RevBoard *board = revArenaGetBoard(arena, handles[i]);
+            const bool ai_turn = (i % 3 == 0 && revGetCurrentPlayer(board) == DISK_BLACK) ||
+                                 (i % 3 == 1 && revGetCurrentPlayer(board) == DISK_WHITE);
+            if (revHasLegalMoves(board) && !ai_turn) {
+                ASSERT_TRUE(revArenaMove(arena, handles[i], revGenMoveRandom(board)));
+                total++;
+            }
+        }
+        if (total == 0) break;
+        sweeps++;
+        ASSERT_LT(sweeps, 130);
+    }
+    for (int i = 0; i < count; i++)
+        EXPECT_FALSE(revHasLegalMoves(revArenaGetBoard(arena, handles[i])));
+}
@@ -0,0 +1,197 @@
+"""Test harness for tools/engine.c.
+
+Usage: python3 engine_server_test.py <path to engine>
+"""
+import os
+import subprocess
+import sys
+import tempfile
+
+
+class EngineServer:
+    def __init__(self, path, *args):
+        self.proc = subprocess.Popen(
+            [path, "16"] + list(args), stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+            universal_newlines=True, bufsize=1)
+
+    def send(self, line):
+        self.proc.stdin.write(line + "\n")
+        self.proc.stdin.flush()
+
+    def read_response(self):
+        """Returns (ok, id, text) of the next response."""
+        lines = []
+        while True:
+            line = self.proc.stdout.readline()
+            if line == "":
+                raise RuntimeError("The engine exited unexpectedly.")
+            line = line.rstrip("\n")
+            if line == "" and lines:
+                break
+            if line != "" or lines:
+                lines.append(line)
+        head, _, first = lines[0].partition(" ")
+        text = "\n".join([first] + lines[1:]).strip("\n")
+        return head[0] == "=", head[1:], text
+
+    def request(self, line):
+        self.send(line)
+        return self.read_response()
+
+    def close(self):
+        self.send("quit")
+        self.read_response()
+        self.proc.stdin.close()
+        assert self.proc.wait(timeout=30) == 0
+
+
+def check(cond, message):
+    if not cond:
+        raise AssertionError(message)
+
+
+def test_basic(server):
+    check(server.request("name") == (True, "", "reversi-core"), "name")
+    check(server.request("7 protocol_version") == (True, "7", "2"), "protocol_version")
+    ok, _, text = server.request("list_commands")
+    check(ok and "genmove" in text.split("\n"), "list_commands")
+    check(not server.request("bogus")[0], "unknown command should fail")
+    check(not server.request("play b a1")[0], "illegal move should fail")
+    check(not server.request("play w d3")[0], "wrong color should fail")
+    check(not server.request("set depth")[0], "missing value should fail")
+
+
+def test_pipelined_batch(server):
+    # Send a batch without waiting, then match responses by ids.
+    batch = [
+        "clear_board",
+        "play b d3",
+        "play w c3",
+        "set depth 4",
+        "search",
+        "showboard",
+    ]
+    for i, line in enumerate(batch):
+        server.send("%d %s" % (100 + i, line))
+    responses = [server.read_response() for _ in batch]
+    for i, (ok, rid, text) in enumerate(responses):
+        check(ok, "%s failed: %s" % (batch[i], text))
+        check(rid == str(100 + i), "response ids should be in order")
+    move, _, stats = responses[4][2].partition(" ")
+    check(len(move) == 2 and "depth 4" in stats, "search result: " + responses[4][2])
+    board = responses[5][2].split("\n")
+    check(board[2][3] == "X" and board[2][2] == "O", "showboard:\n" + responses[5][2])
+    check(board[8] == "b to move", "showboard turn")
+
+
+def test_warm_hash(server):
+    server.request("clear_board")
+    server.request("set depth 8")
+    server.request("clear_hash")
+    nodes = []
+    for _ in range(2):
+        ok, _, text = server.request("search")
+        check(ok, text)
+        nodes.append(int(text.split("nodes ")[1].split()[0]))
+    check(nodes[1] < nodes[0], "the second search should reuse the table: %s" % nodes)
+
+
+def test_latency(server):
+    check(server.request("latency reset")[0], "latency reset")
+    server.request("clear_board")
+    server.request("set depth 4")
+    for _ in range(3):
+        server.request("search")
+    ok, _, text = server.request("latency")
+    lines = text.split("\n")
+    check(ok and lines[0].startswith("api") and lines[1].split()[:2] == ["search", "3"],
+          "latency:\n" + text)
+    ok, _, text = server.request("latency json")
+    check(ok and text.startswith('{"search":{"count":3,'), "latency json: " + text)
+
+
+def search_nodes(server):
+    ok, _, text = server.request("search")
+    check(ok, text)
+    return int(text.split("nodes ")[1].split()[0])
+
+
+def test_hash_file(path):
+    # A server that starts with the file of a previous one should start warm.
+    # Two servers can use the file at the same time.
+    hash_file = os.path.join(tempfile.mkdtemp(), "hash.bin")
+    if os.name == "nt":
+        # revOpenHashTable() is not available on Windows.
+        server = EngineServer(path)
+        check(not server.request("set hashfile " + hash_file)[0],
+              "hashfile should fail on Windows")
+        server.close()
+        os.rmdir(os.path.dirname(hash_file))
+        return
+    nodes = []
+    first = EngineServer(path, hash_file)
+    first.request("set depth 8")
+    nodes.append(search_nodes(first))
+    second = EngineServer(path, hash_file)
+    second.request("set depth 8")
+    nodes.append(search_nodes(second))
+    first.close()
+    second.close()
+    third = EngineServer(path)
+    check(third.request("set hashfile " + hash_file)[0], "set hashfile")
+    third.request("set depth 8")
+    nodes.append(search_nodes(third))
+    check(not third.request("set hashfile " + os.path.dirname(hash_file))[0],
+          "a directory should fail")
+    third.close()
+    os.remove(hash_file)
+    os.rmdir(os.path.dirname(hash_file))
+    check(nodes[1] < nodes[0] and nodes[2] < nodes[0],
+          "later servers should reuse the file: %s" % nodes)
+
+
+def test_self_play(server, ponder):
+    server.request("clear_board")
+    server.request("set depth 3")
+    server.request("set ponder %s" % ("on" if ponder else "off"))
+    color = "b"
+    passes = 0
+    moves = 0
+    while passes < 2:
+        ok, _, move = server.request("genmove " + color)
+        check(ok, "genmove failed: " + move)
+        passes = passes + 1 if move == "pass" else 0
+        moves += 1
+        check(moves <= 130, "the game should end")
+        color = "w" if color == "b" else "b"
+    board = server.request("showboard")[2].split("\n")
+    disks = sum(row.count("X") + row.count("O") for row in board[:8])
+    check(disks > 4, "disks should be placed")
+    server.request("set ponder off")
+
+
+def test_setboard(server):
+    board = "." * 27 + "XO" + "." * 6 + "OX" + "." * 27
+    check(server.request("setboard %s w" % board)[0], "setboard")
+    ok, _, text = server.request("showboard")
+    check(ok and text.endswith("w to move"), "setboard turn")
+    check(server.request("play w c4")[0], "white should be able to play c4")
+    check(not server.request("setboard xyz b")[0], "broken board should fail")
+
+
+def main():
+    server = EngineServer(sys.argv[1])
+    test_basic(server)
+    test_pipelined_batch(server)
+    test_warm_hash(server)
+    test_self_play(server, ponder=False)
+    test_self_play(server, ponder=True)
+    test_setboard(server)
+    test_latency(server)
+    server.close()
+    test_hash_file(sys.argv[1])
+    print("All engine server tests passed.")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,149 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "reversi.h"
+
+class EngineTest : public ::testing::Test {
+ protected:
+    RevBoard* board;
+    RevEngine* engine;
+    RevSearchParams params;
+
+    virtual void SetUp() {
+        board = revNewBoard();
+        ASSERT_TRUE(board != NULL);
+        engine = revNewEngine();
+        ASSERT_TRUE(engine != NULL);
+        revInitSearchParams(&params);
+    }
+
+    virtual void TearDown() {
+        revFreeEngine(engine);
+        revFreeBoard(board);
+    }
+};
+
+static void countCallback(const RevSearchResult *result, void *user_data) {
+    std::atomic<int> *count = (std::atomic<int> *)user_data;
+    if (result->move >= 0)
+        (*count)++;
+}
+
+TEST_F(EngineTest, revSearchStartAndWait) {
+    std::atomic<int> count(0);
+    params.depth = 4;
+    revSearchStart(engine, board, &params, countCallback, &count);
+    RevSearchResult result;
+    int move = revSearchWait(engine, &result);
+    EXPECT_TRUE(revIsLegalMove(board, move));
+    EXPECT_EQ(4, result.depth);
+    EXPECT_EQ(1, count.load());
+    EXPECT_FALSE(revIsSearching(engine));
+}
+
+TEST_F(EngineTest, revSearchWaitBeforeSearch) {
+    RevSearchResult result;
+    memset(&result, 0xff, sizeof(result));
+    EXPECT_EQ(-1, revSearchWait(engine, &result));
+    EXPECT_EQ(0, result.score);
+    EXPECT_EQ(0, result.depth);
+    EXPECT_EQ(0u, result.nodes);
+    EXPECT_EQ(0u, result.playouts);
+    EXPECT_EQ(0, result.elapsed_ms);
+    EXPECT_EQ(0, result.timed_out);
+}
+
+TEST_F(EngineTest, revSearchStop) {
+    std::atomic<int> count(0);
+    params.depth = 0;
+    params.time_ms = 0;
+    auto start = std::chrono::steady_clock::now();
+    revSearchStart(engine, board, &params, countCallback, &count);
+    // revSearchStart() should not block the caller.
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    EXPECT_TRUE(revIsSearching(engine));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    revSearchStop(engine);
+    RevSearchResult result;
+    int move = revSearchWait(engine, &result);
+    EXPECT_TRUE(revIsLegalMove(board, move));
+    EXPECT_TRUE(result.timed_out);
+    EXPECT_EQ(1, count.load());
+}
+
+TEST_F(EngineTest, revFreeEngineDuringSearch) {
+    std::atomic<int> count(0);
+    params.depth = 0;
+    revSearchStart(engine, board, &params, countCallback, &count);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_TRUE(revIsSearching(engine));
+    revFreeEngine(engine);
+    EXPECT_EQ(0, count.load());
+    engine = revNewEngine();  // For TearDown()
+}
+
+TEST_F(EngineTest, revSearchRestart) {
+    std::atomic<int> count(0);
+    params.depth = 0;
+    params.time_ms = 0;
+    revSearchStart(engine, board, &params, countCallback, &count);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    // The second search stops the first one.
+    params.depth = 3;
+    revSearchStart(engine, board, &params, countCallback, &count);
+    RevSearchResult result;
+    revSearchWait(engine, &result);
+    EXPECT_EQ(3, result.depth);
+    EXPECT_EQ(2, count.load());
+}
+
+TEST_F(EngineTest, revPonderHit) {
+    // Black played (3, 2). Ponder on white's reply (2, 2).
+    revMoveXY(board, 3, 2);
+    params.depth = 0;
+    revPonderStart(engine, board, revXYToPos(2, 2), &params);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(revIsSearching(engine));
+
+    std::atomic<int> count(0);
+    revMoveXY(board, 2, 2);
+    params.time_ms = 50;
+    revSearchStart(engine, board, &params, countCallback, &count);
+    RevSearchResult result;
+    int move = revSearchWait(engine, &result);
+    EXPECT_TRUE(revIsLegalMove(board, move));
+    // The result includes the work while pondering.
+    EXPECT_GE(result.elapsed_ms, 150);
+    EXPECT_EQ(1, count.load());
+}
+
+TEST_F(EngineTest, revPonderMiss) {
+    revMoveXY(board, 3, 2);
+    params.depth = 0;
+    revPonderStart(engine, board, revXYToPos(2, 2), &params);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    std::atomic<int> count(0);
+    revMoveXY(board, 4, 2);
+    params.time_ms = 50;
+    revSearchStart(engine, board, &params, countCallback, &count);
+    RevSearchResult result;
+    int move = revSearchWait(engine, &result);
+    EXPECT_TRUE(revIsLegalMove(board, move));
+    EXPECT_LT(result.elapsed_ms, 500);
+    EXPECT_EQ(1, count.load());
+}
+
+TEST_F(EngineTest, revPonderPredict) {
+    // The engine predicts the reply by itself with an illegal move.
+    revMoveXY(board, 3, 2);
+    params.type = SEARCH_MONTE_CARLO;
+    params.trials = 0;
+    revPonderStart(engine, board, -1, &params);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    revSearchStop(engine);
+    EXPECT_FALSE(revIsSearching(engine));
+}
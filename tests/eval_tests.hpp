@@ -0,0 +1,178 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+#include "reversi.h"
+#include "helpers.hpp"
+
+class EvalTest : public ::testing::Test {
+ protected:
+    RevBoard* board;
+    RevEvalWeights* weights;
+
+    virtual void SetUp() {
+        board = revNewBoard();
+        weights = revNewEvalWeights();
+        ASSERT_TRUE(board != NULL);
+        ASSERT_TRUE(weights != NULL);
+    }
+
+    virtual void TearDown() {
+        revFreeBoard(board);
+        revFreeEvalWeights(weights);
+    }
+
+    void playRandomly(int empties) {
+        ::playRandomly(board, empties);
+    }
+
+    void setRandomWeights(RevEvalWeights *w) {
+        for (int stage = 0; stage < REV_EVAL_STAGES; stage++) {
+            for (int i = 0; i < REV_EVAL_WEIGHTS; i++)
+                revSetEvalWeight(w, stage, i, revGenIntRandom(-64, 64) / 16.0);
+        }
+    }
+};
+
+TEST_F(EvalTest, revGetEvalFeatures) {
+    RevBoard *copy = revNewBoard();
+    for (int i = 0; i < 50; i++) {
+        revInitBoard(board);
+        playRandomly(revGenIntRandom(1, 60));
+        const int empties =
+            64 - revCountDisks(board, DISK_BLACK) - revCountDisks(board, DISK_WHITE);
+        int features[REV_EVAL_FEATURES];
+        const int stage = revGetEvalFeatures(board, features);
+        EXPECT_EQ(std::min((60 - empties) / 6, REV_EVAL_STAGES - 1), stage);
+        for (int j = 0; j < REV_EVAL_FEATURES; j++) {
+            EXPECT_GE(features[j], 0);
+            EXPECT_LT(features[j], REV_EVAL_WEIGHTS);
+        }
+        EXPECT_EQ(REV_EVAL_WEIGHTS - 1, features[REV_EVAL_FEATURES - 1]);
+
+        // Symmetric boards have the same features in another order.
+        std::vector<int> sorted(features, features + REV_EVAL_FEATURES);
+        std::sort(sorted.begin(), sorted.end());
+        for (int symmetry = 1; symmetry < 8; symmetry++) {
+            copySymmetric(board, copy, symmetry);
+            int copy_features[REV_EVAL_FEATURES];
+            EXPECT_EQ(stage, revGetEvalFeatures(copy, copy_features));
+            std::vector<int> copy_sorted(copy_features, copy_features + REV_EVAL_FEATURES);
+            std::sort(copy_sorted.begin(), copy_sorted.end());
+            EXPECT_EQ(sorted, copy_sorted);
+        }
+    }
+    revFreeBoard(copy);
+}
+
+TEST_F(EvalTest, revEvaluate) {
+    setRandomWeights(weights);
+    for (int i = 0; i < 50; i++) {
+        revInitBoard(board);
+        playRandomly(revGenIntRandom(1, 60));
+        int features[REV_EVAL_FEATURES];
+        const int stage = revGetEvalFeatures(board, features);
+        double sum = 0;
+        for (int j = 0; j < REV_EVAL_FEATURES; j++)
+            sum += revGetEvalWeight(weights, stage, features[j]);
+        EXPECT_DOUBLE_EQ(sum, revEvaluate(weights, board));
+    }
+}
+
+TEST_F(EvalTest, revEvalWeightsFile) {
+    const char *path = "eval_test.bin";
+    EXPECT_FALSE(revSetEvalWeight(weights, REV_EVAL_STAGES, 0, 1.0));
+    EXPECT_FALSE(revSetEvalWeight(weights, 0, REV_EVAL_WEIGHTS, 1.0));
+    EXPECT_FALSE(revSetEvalWeight(weights, 0, -1, 1.0));
+    // Weights are rounded to 1/64 disks and clamped.
+    EXPECT_TRUE(revSetEvalWeight(weights, 1, 2, 1.25));
+    EXPECT_DOUBLE_EQ(1.25, revGetEvalWeight(weights, 1, 2));
+    EXPECT_TRUE(revSetEvalWeight(weights, 1, 3, -0.01));
+    EXPECT_DOUBLE_EQ(-1.0 / 64, revGetEvalWeight(weights, 1, 3));
+    EXPECT_TRUE(revSetEvalWeight(weights, 1, 4, 10000.0));
+    EXPECT_DOUBLE_EQ(32767.0 / 64, revGetEvalWeight(weights, 1, 4));
+    EXPECT_DOUBLE_EQ(0.0, revGetEvalWeight(weights, REV_EVAL_STAGES, 0));
+
+    setRandomWeights(weights);
+    ASSERT_TRUE(revSaveEvalWeights(weights, path));
+    RevEvalWeights *loaded = revLoadEvalWeights(path);
+    ASSERT_TRUE(loaded != NULL);
+    for (int i = 0; i < 20; i++) {
+        revInitBoard(board);
+        playRandomly(revGenIntRandom(1, 60));
+        EXPECT_EQ(revEvaluate(weights, board), revEvaluate(loaded, board));
+    }
+    revFreeEvalWeights(loaded);
+
+    FILE *file = fopen(path, "wb");
+    ASSERT_TRUE(file != NULL);
+    fprintf(file, "REVEVAL broken");
+    fclose(file);
+    EXPECT_TRUE(revLoadEvalWeights(path) == NULL);
+    remove(path);
+    EXPECT_TRUE(revLoadEvalWeights(path) == NULL);
+}
+
+static void countEpochs(int epoch, double mse, void *user_data) {
+    std::vector<double> *losses = (std::vector<double> *)user_data;
+    EXPECT_EQ((int)losses->size() + 1, epoch);
+    losses->push_back(mse);
+}
+
+TEST_F(EvalTest, revTrainEvalWeights) {
+    // Targets are evaluations of random weights, so they can be fitted.
+    RevEvalWeights *teacher = revNewEvalWeights();
+    ASSERT_TRUE(teacher != NULL);
+    setRandomWeights(teacher);
+    std::vector<RevEvalRecord> records;
+    for (int i = 0; i < 2000; i++) {
+        revInitBoard(board);
+        playRandomly(revGenIntRandom(1, 59));
+        const RevDiskType player = revGetCurrentPlayer(board);
+        RevEvalRecord record;
+        record.p_board = revGetBitboard(board, player);
+        record.o_board = revGetBitboard(board, (RevDiskType)!player);
+        record.score = revEvaluate(teacher, board);
+        records.push_back(record);
+    }
+    revFreeEvalWeights(teacher);
+
+    RevTrainParams params;
+    revInitTrainParams(&params);
+    params.threads = 3;
+    params.epochs = 30;
+    std::vector<double> losses;
+    params.callback = countEpochs;
+    params.user_data = &losses;
+    ASSERT_TRUE(revTrainEvalWeights(weights, records.data(), records.size(), &params));
+    ASSERT_EQ(30, (int)losses.size());
+    EXPECT_LT(losses.back(), losses.front() / 10);
+
+    double sse = 0;
+    for (const RevEvalRecord &record : records) {
+        revSetBitboard(board, revGetCurrentPlayer(board), record.p_board);
+        revSetBitboard(board, (RevDiskType)!revGetCurrentPlayer(board), record.o_board);
+        const double error = record.score - revEvaluate(weights, board);
+        sse += error * error;
+    }
+    EXPECT_LT(sse / records.size(), losses.front() / 10);
+    EXPECT_TRUE(revTrainEvalWeights(weights, NULL, 0, &params));
+}
+
+TEST_F(EvalTest, revSearchWithEvalWeights) {
+    // Only the bias is set, so every leaf is worth 5 disks for the player to move.
+    for (int stage = 0; stage < REV_EVAL_STAGES; stage++)
+        revSetEvalWeight(weights, stage, REV_EVAL_WEIGHTS - 1, 5.0);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.eval = weights;
+    // Nobody passes in the first moves.
+    RevSearchResult result;
+    params.depth = 1;
+    revSearch(board, &params, &result);
+    EXPECT_EQ(-5, result.score);
+    params.depth = 2;
+    revSearch(board, &params, &result);
+    EXPECT_EQ(5, result.score);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <vector>
+#include "reversi.h"
+#include "helpers.hpp"
+
+#define TENSOR_SIZE (REV_FEATURE_PLANES * 64)
+
+class FeaturesTest : public ::testing::Test {
+ protected:
+    std::vector<RevBoard*> boards;
+
+    virtual void SetUp() {
+        for (int i = 0; i < 30; i++) {
+            RevBoard *board = revNewBoard();
+            ASSERT_TRUE(board != NULL);
+            playRandomly(board, revGenIntRandom(0, 60));
+            boards.push_back(board);
+        }
+    }
+
+    virtual void TearDown() {
+        for (RevBoard *board : boards)
+            revFreeBoard(board);
+    }
+
+    // Planes made square by square.
+    static void expectPlanes(RevBoard *board, const float *planes) {
+        const RevDiskType player = revGetCurrentPlayer(board);
+        for (int pos = 0; pos < 64; pos++) {
+            const RevDiskType disk = revGetDisk(board, pos);
+            EXPECT_EQ(disk == player, planes[pos]);
+            EXPECT_EQ(disk != player && disk != DISK_NONE, planes[64 + pos]);
+            EXPECT_EQ(disk == DISK_NONE, planes[128 + pos]);
+            EXPECT_EQ(revIsLegalMove(board, pos), planes[192 + pos]);
+        }
+    }
+};
+
+TEST_F(FeaturesTest, revExtractFeatures) {
+    const int count = (int)boards.size();
+    std::vector<float> floats(count * TENSOR_SIZE, -1.0f);
+    EXPECT_EQ(count, revExtractFeatures(boards.data(), count, floats.data(), 0));
+    for (int i = 0; i < count; i++)
+        expectPlanes(boards[i], &floats[i * TENSOR_SIZE]);
+
+    std::vector<uint8_t> bytes(count * TENSOR_SIZE, 0xff);
+    EXPECT_EQ(count, revExtractFeatures(boards.data(), count, bytes.data(), REV_FEATURES_UINT8));
+    for (int i = 0; i < count * TENSOR_SIZE; i++)
+        EXPECT_EQ(floats[i], (float)bytes[i]);
+
+    EXPECT_EQ(0, revExtractFeatures(boards.data(), 0, floats.data(), 0));
+}
+
+TEST_F(FeaturesTest, revExtractFeaturesSymmetries) {
+    const int count = (int)boards.size();
+    std::vector<float> floats(count * 8 * TENSOR_SIZE, -1.0f);
+    EXPECT_EQ(count * 8, revExtractFeatures(boards.data(), count, floats.data(),
+                                            REV_FEATURES_SYMMETRIES));
+    std::vector<uint8_t> bytes(count * 8 * TENSOR_SIZE, 0xff);
+    EXPECT_EQ(count * 8, revExtractFeatures(boards.data(), count, bytes.data(),
+                                            REV_FEATURES_SYMMETRIES | REV_FEATURES_UINT8));
+    RevBoard *copy = revNewBoard();
+    for (int i = 0; i < count; i++) {
+        for (int symmetry = 0; symmetry < 8; symmetry++) {
+            copySymmetric(boards[i], copy, symmetry);
+            expectPlanes(copy, &floats[(i * 8 + symmetry) * TENSOR_SIZE]);
+        }
+    }
+    revFreeBoard(copy);
+    for (int i = 0; i < count * 8 * TENSOR_SIZE; i++)
+        EXPECT_EQ(floats[i], (float)bytes[i]);
+}
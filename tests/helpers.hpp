@@ -0,0 +1,80 @@
+#pragma once
+#include <gtest/gtest.h>
+#include "reversi.h"
+
+// Helpers shared by the tests.
+
+// Plays random moves until the number of empty squares becomes empties.
+static void playRandomly(RevBoard *board, int empties) {
+    while (revHasLegalMoves(board) &&
+           64 - revCountDisks(board, DISK_BLACK) - revCountDisks(board, DISK_WHITE) > empties) {
+        revMove(board, revGenMoveRandom(board));
+        if (!revHasLegalMoves(board)) {
+            revChangePlayer(board);
+        }
+    }
+}
+
+// Moves squares with coordinates instead of bit operations.
+// Bit 2 of symmetry swaps x and y, then bit 0 mirrors x and bit 1 mirrors y.
+static RevBitboard transformBySquares(RevBitboard b, int symmetry) {
+    RevBitboard out = 0;
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            if (!revIsTrueAtXY(b, x, y)) continue;
+            int tx = (symmetry & 4) ? y : x;
+            int ty = (symmetry & 4) ? x : y;
+            if (symmetry & 1) tx = 7 - tx;
+            if (symmetry & 2) ty = 7 - ty;
+            out |= (RevBitboard)1 << revXYToPos(tx, ty);
+        }
+    }
+    return out;
+}
+
+// Copies board to trg with one of the 8 symmetries of transformBySquares().
+static void copySymmetric(RevBoard *board, RevBoard *trg, int symmetry) {
+    const RevBitboard black = transformBySquares(revGetBitboard(board, DISK_BLACK), symmetry);
+    const RevBitboard white = transformBySquares(revGetBitboard(board, DISK_WHITE), symmetry);
+    revCopyBoard(board, trg);
+    revSetBitboard(trg, DISK_BLACK, black);
+    revSetBitboard(trg, DISK_WHITE, white);
+    revUpdateMobility(trg);
+}
+
+// Plays games from the initial position between mcts for mcts_color and random moves.
+// The tree follows the games with revMctsAdvance().
+// Returns the number of games that mcts won minus the number that random moves won.
+static int playMctsAgainstRandom(RevBoard *board, RevMcts *mcts, const RevSearchParams *params,
+                                 RevDiskType mcts_color, int games) {
+    int balance = 0;
+    for (int i = 0; i < games; i++) {
+        revInitBoard(board);
+        revClearMcts(mcts);
+        while (revHasLegalMoves(board)) {
+            int move;
+            if (revGetCurrentPlayer(board) == mcts_color) {
+                move = revSearchMcts(mcts, board, params, NULL);
+                if (!revIsLegalMove(board, move)) {
+                    ADD_FAILURE() << "revSearchMcts() returned an illegal move " << move;
+                    return balance;
+                }
+            } else {
+                move = revGenMoveRandom(board);
+            }
+            revMove(board, move);
+            revMctsAdvance(mcts, move);
+            if (!revHasLegalMoves(board)) {
+                revChangePlayer(board);
+                revMctsAdvance(mcts, -1);
+            }
+        }
+        const RevDiskType winner = revGetWinner(board);
+        if (winner == mcts_color) {
+            balance++;
+        } else if (winner != DISK_NONE) {
+            balance--;
+        }
+    }
+    return balance;
+}
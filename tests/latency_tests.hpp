@@ -0,0 +1,193 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "reversi.h"
+
+class LatencyTest : public ::testing::Test {
+ protected:
+    RevBoard* board;
+
+    virtual void SetUp() {
+        board = revNewBoard();
+        ASSERT_TRUE(board != NULL);
+        revResetLatencyStats();
+    }
+
+    virtual void TearDown() {
+        revSetLatencyRecording(0);
+        revResetLatencyStats();
+        revFreeBoard(board);
+    }
+
+    static void expectOrdered(const RevLatencyStats &s) {
+        EXPECT_LE(s.min_ns, s.p50_ns);
+        EXPECT_LE(s.p50_ns, s.p90_ns);
+        EXPECT_LE(s.p90_ns, s.p99_ns);
+        EXPECT_LE(s.p99_ns, s.p999_ns);
+        EXPECT_LE(s.p999_ns, s.max_ns);
+        EXPECT_LE(s.min_ns, s.mean_ns);
+        EXPECT_LE(s.mean_ns, s.max_ns);
+    }
+};
+
+TEST_F(LatencyTest, revGetLatencyStats) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.type = SEARCH_ALPHA_BETA;
+    params.depth = 4;
+
+    // Nothing is recorded by default.
+    revSearch(board, &params, NULL);
+    RevLatencyStats stats;
+    revGetLatencyStats(REV_LATENCY_SEARCH, &stats);
+    EXPECT_EQ(0u, stats.count);
+    EXPECT_EQ(0u, stats.max_ns);
+
+    revSetLatencyRecording(1);
+    for (int i = 0; i < 20; i++)
+        revSearch(board, &params, NULL);
+    revGenMoveMonteCarlo(board, 100);
+    revGetLatencyStats(REV_LATENCY_SEARCH, &stats);
+    EXPECT_EQ(20u, stats.count);
+    EXPECT_GT(stats.min_ns, 0u);
+    expectOrdered(stats);
+    revGetLatencyStats(REV_LATENCY_GEN_MOVE_MONTE_CARLO, &stats);
+    EXPECT_EQ(1u, stats.count);
+    EXPECT_EQ(stats.min_ns, stats.max_ns);
+    EXPECT_EQ(stats.max_ns, stats.p999_ns);
+
+    revResetLatencyStats();
+    revGetLatencyStats(REV_LATENCY_SEARCH, &stats);
+    EXPECT_EQ(0u, stats.count);
+}
+
+TEST_F(LatencyTest, Threads) {
+    // Positions of a batch are recorded by their workers. Reused threads keep the counts.
+    revSetLatencyRecording(1);
+    std::vector<RevBoard*> boards;
+    for (int i = 0; i < 16; i++) {
+        RevBoard *b = revNewBoard();
+        for (int j = 0; j < i % 8; j++)
+            revMove(b, revGenMoveRandom(b));
+        boards.push_back(b);
+    }
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.type = SEARCH_ALPHA_BETA;
+    params.depth = 3;
+    params.threads = 4;
+    for (int i = 0; i < 3; i++)
+        revAnalyzeBatch(boards.data(), (int)boards.size(), &params, NULL, NULL, NULL);
+    RevLatencyStats stats;
+    revGetLatencyStats(REV_LATENCY_SEARCH, &stats);
+    EXPECT_EQ(48u, stats.count);
+    expectOrdered(stats);
+    revGetLatencyStats(REV_LATENCY_ANALYZE_BATCH, &stats);
+    EXPECT_EQ(3u, stats.count);
+    for (RevBoard *b : boards)
+        revFreeBoard(b);
+
+    RevGameArena *arena = revNewGameArena();
+    RevGameHandle game = revArenaNewGame(arena);
+    int moves = 0;
+    while (revHasLegalMoves(revArenaGetBoard(arena, game))) {
+        revArenaMove(arena, game, revGenMoveRandom(revArenaGetBoard(arena, game)));
+        moves++;
+    }
+    revFreeGameArena(arena);
+    revGetLatencyStats(REV_LATENCY_ARENA_MOVE, &stats);
+    EXPECT_EQ((uint64_t)moves, stats.count);
+    expectOrdered(stats);
+
+    // Threads of the caller give their histograms to later threads when they exit.
+    for (int i = 0; i < 10; i++) {
+        std::thread thread([&params, this]() {
+            RevSearchParams one_thread = params;
+            one_thread.threads = 1;
+            revSearch(board, &one_thread, NULL);
+        });
+        thread.join();
+    }
+    revGetLatencyStats(REV_LATENCY_SEARCH, &stats);
+    EXPECT_EQ(58u, stats.count);
+}
+
+TEST_F(LatencyTest, Engine) {
+    // Pondering and its prediction of the reply aren't requested searches.
+    revSetLatencyRecording(1);
+    RevEngine *engine = revNewEngine();
+    ASSERT_TRUE(engine != NULL);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.type = SEARCH_MONTE_CARLO;
+    params.trials = 0;
+    revMoveXY(board, 3, 2);
+    revPonderStart(engine, board, -1, &params);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    revMoveXY(board, 2, 2);
+    params.type = SEARCH_ALPHA_BETA;
+    params.depth = 4;
+    revSearchStart(engine, board, &params, NULL, NULL);
+    revSearchWait(engine, NULL);
+    RevLatencyStats stats;
+    revGetLatencyStats(REV_LATENCY_SEARCH, &stats);
+    EXPECT_EQ(1u, stats.count);
+
+    // Ponder hits are requests. They count from revSearchStart().
+    for (int finished = 0; finished < 2; finished++) {
+        params.depth = finished ? 1 : 0;
+        const int predicted = revGenMoveRandom(board);
+        revPonderStart(engine, board, predicted, &params);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        RevBoard *hit = revNewBoard();
+        revCopyBoard(board, hit);
+        revMove(hit, predicted);
+        params.time_ms = 20;
+        revSearchStart(engine, hit, &params, NULL, NULL);
+        revSearchWait(engine, NULL);
+        revFreeBoard(hit);
+        revGetLatencyStats(REV_LATENCY_SEARCH, &stats);
+        EXPECT_EQ(2u + finished, stats.count);
+        EXPECT_LT(stats.max_ns, 500000000u);
+    }
+    revFreeEngine(engine);
+}
+
+TEST_F(LatencyTest, revFormatLatencyStats) {
+    revSetLatencyRecording(1);
+    RevMcts *mcts = revNewMcts(4);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.trials = 100;
+    revSearchMcts(mcts, board, &params, NULL);
+    revFreeMcts(mcts);
+
+    const int length = revFormatLatencyStats(NULL, 0, REV_LATENCY_JSON);
+    std::vector<char> json(length + 1);
+    EXPECT_EQ(length, revFormatLatencyStats(json.data(), length + 1, REV_LATENCY_JSON));
+    const std::string text(json.data());
+    EXPECT_EQ((size_t)length, text.size());
+    EXPECT_EQ('{', text.front());
+    EXPECT_EQ('}', text.back());
+    for (int api = 0; api < REV_LATENCY_API_COUNT; api++)
+        EXPECT_NE(std::string::npos, text.find(revGetLatencyApiName(api)));
+    EXPECT_NE(std::string::npos, text.find("\"search_mcts\":{\"count\":1,"));
+    EXPECT_NE(std::string::npos, text.find("\"search\":{\"count\":0,"));
+    EXPECT_TRUE(revGetLatencyApiName(REV_LATENCY_API_COUNT) == NULL);
+
+    // Short buffers get the head of the text.
+    char head[8];
+    EXPECT_EQ(length, revFormatLatencyStats(head, sizeof(head), REV_LATENCY_JSON));
+    EXPECT_EQ(text.substr(0, 7), std::string(head));
+
+    char table[1024];
+    revFormatLatencyStats(table, sizeof(table), REV_LATENCY_TEXT);
+    EXPECT_NE(nullptr, strstr(table, "p999(us)"));
+    EXPECT_NE(nullptr, strstr(table, "search_mcts"));
+    EXPECT_EQ(nullptr, strstr(table, "arena_move"));
+}
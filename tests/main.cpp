@@ -3,6 +3,14 @@
 #include "reversi.h"
 #include "bitboard_tests.hpp"
 #include "reversi_tests.hpp"
+#include "search_tests.hpp"
+#include "engine_tests.hpp"
+#include "arena_tests.hpp"
+#include "wrapper_tests.hpp"
+#include "unique_tests.hpp"
+#include "latency_tests.hpp"
+#include "eval_tests.hpp"
+#include "features_tests.hpp"
 
 int main(int argc, char* argv[]) {
     ::testing::InitGoogleTest(&argc, argv);
@@ -270,6 +270,33 @@ TEST_F(ReversiTest, revGetMobility3) {
     free(array);
 }
 
+TEST_F(ReversiTest, revGetSortedMoves) {
+    int moves[64];
+    int count = revGetSortedMoves(board, moves);
+    EXPECT_EQ(revGetMobilityCount(board), count);
+    for (int i = 0; i < count; i++) {
+        EXPECT_TRUE(revIsLegalMove(board, moves[i]));
+    }
+
+    std::vector<int> ba = {
+        revXYToPos(2, 2), revXYToPos(4, 3), revXYToPos(3, 4),
+    };
+    std::vector<int> wa = {
+        revXYToPos(1, 1), revXYToPos(5, 2), revXYToPos(3, 5),
+    };
+    revSetBitboard(board, DISK_BLACK, revArrayToBitboard(&ba[0], ba.size()));
+    revSetBitboard(board, DISK_WHITE, revArrayToBitboard(&wa[0], wa.size()));
+    revUpdateMobility(board);
+    revPrintBoardWithMobility(board);
+    count = revGetSortedMoves(board, moves);
+    EXPECT_EQ(revGetMobilityCount(board), count);
+    EXPECT_EQ(3, count);
+    // Taking a corner is the best. The X-square next to an empty corner is the worst.
+    EXPECT_EQ(revXYToPos(0, 0), moves[0]);
+    EXPECT_EQ(revXYToPos(3, 6), moves[1]);
+    EXPECT_EQ(revXYToPos(6, 1), moves[2]);
+}
+
 static int inArray(int elm, int *array, int size) {
     int found = 0;
     int *ap = array;
@@ -279,6 +306,56 @@ static int inArray(int elm, int *array, int size) {
     return found;
 }
 
+TEST_F(ReversiTest, revGetStableDisks) {
+    EXPECT_EQ(0, revGetStableDisks(board, DISK_BLACK));
+    EXPECT_EQ(0, revGetStableDisks(board, DISK_WHITE));
+
+    std::vector<int> ba = {
+        revXYToPos(0, 0), revXYToPos(1, 0), revXYToPos(2, 0), revXYToPos(0, 1),
+        revXYToPos(1, 1), revXYToPos(4, 4),
+    };
+    std::vector<int> wa = {
+        revXYToPos(3, 0), revXYToPos(2, 1), revXYToPos(0, 2),
+    };
+    revSetBitboard(board, DISK_BLACK, revArrayToBitboard(&ba[0], ba.size()));
+    revSetBitboard(board, DISK_WHITE, revArrayToBitboard(&wa[0], wa.size()));
+    // The corner, edges next to it, and (1, 1) surrounded by them are stable.
+    std::vector<int> stable = {
+        revXYToPos(0, 0), revXYToPos(1, 0), revXYToPos(2, 0), revXYToPos(0, 1),
+        revXYToPos(1, 1),
+    };
+    EXPECT_EQ(revArrayToBitboard(&stable[0], stable.size()),
+              revGetStableDisks(board, DISK_BLACK));
+    EXPECT_EQ(0, revGetStableDisks(board, DISK_WHITE));
+
+    // Every disk is stable on a full board.
+    revSetBitboard(board, DISK_BLACK, 0x00000000ffffffff);
+    revSetBitboard(board, DISK_WHITE, 0xffffffff00000000);
+    EXPECT_EQ(0x00000000ffffffff, revGetStableDisks(board, DISK_BLACK));
+    EXPECT_EQ(0xffffffff00000000, revGetStableDisks(board, DISK_WHITE));
+}
+
+TEST_F(ReversiTest, revGetStableDisksNeverFlipped) {
+    revInitGenRandom(7);
+    for (int game = 0; game < 50; game++) {
+        revInitBoard(board);
+        RevBitboard stable[2] = { 0, 0 };
+        while (revHasLegalMoves(board)) {
+            revMove(board, revGenMoveRandom(board));
+            if (!revHasLegalMoves(board))
+                revChangePlayer(board);
+            for (int i = 0; i < 2; i++) {
+                RevDiskType disk = (RevDiskType)i;
+                // Stable disks stay the same color and keep being stable.
+                EXPECT_EQ(stable[i], revGetBitboard(board, disk) & stable[i]);
+                RevBitboard new_stable = revGetStableDisks(board, disk);
+                EXPECT_EQ(stable[i], new_stable & stable[i]);
+                stable[i] = new_stable;
+            }
+        }
+    }
+}
+
 TEST_F(ReversiTest, revIsLegalMoveXY) {
     EXPECT_TRUE(revIsLegalMoveXY(board, 3, 2));
     EXPECT_TRUE(revIsLegalMoveXY(board, 2, 3));
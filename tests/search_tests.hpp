@@ -0,0 +1,864 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+#include "reversi.h"
+#include "helpers.hpp"
+
+class SearchTest : public ::testing::Test {
+ protected:
+    RevBoard* board;
+
+    virtual void SetUp() {
+        board = revNewBoard();
+        ASSERT_TRUE(board != NULL);
+    }
+
+    virtual void TearDown() {
+        revFreeBoard(board);
+    }
+
+    void playRandomly(int empties) {
+        ::playRandomly(board, empties);
+    }
+};
+
+// Exact score with a plain minimax search. Empty squares are counted for the winner.
+static int solveByMinimax(RevBoard *board, int passed) {
+    if (!revHasLegalMoves(board)) {
+        if (passed) {
+            RevDiskType p = revGetCurrentPlayer(board);
+            int diff = revCountDisks(board, p) - revCountDisks(board, (RevDiskType)!p);
+            int empties = 64 - revCountDisks(board, DISK_BLACK) - revCountDisks(board, DISK_WHITE);
+            return diff + (diff > 0) * empties - (diff < 0) * empties;
+        }
+        RevBoard *child = revNewBoard();
+        revCopyBoard(board, child);
+        revChangePlayer(child);
+        int score = -solveByMinimax(child, 1);
+        revFreeBoard(child);
+        return score;
+    }
+    int best = -65;
+    RevBoard *child = revNewBoard();
+    int *moves = revGetMobilityAsArray(board);
+    for (int i = 0; i < revGetMobilityCount(board); i++) {
+        revCopyBoard(board, child);
+        revMove(child, moves[i]);
+        int score = -solveByMinimax(child, 0);
+        if (score > best) best = score;
+    }
+    free(moves);
+    revFreeBoard(child);
+    return best;
+}
+
+TEST_F(SearchTest, revSearchAlphaBeta) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.type = SEARCH_ALPHA_BETA;
+    params.depth = 4;
+    RevSearchResult result;
+    int move = revSearch(board, &params, &result);
+    EXPECT_TRUE(revIsLegalMove(board, move));
+    EXPECT_EQ(move, result.move);
+    EXPECT_EQ(4, result.depth);
+    EXPECT_GT(result.nodes, 0);
+    EXPECT_FALSE(result.timed_out);
+}
+
+TEST_F(SearchTest, revSearchExactScore) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 0;
+    for (int i = 0; i < 5; i++) {
+        revInitBoard(board);
+        playRandomly(8);
+        if (!revHasLegalMoves(board)) continue;
+        RevSearchResult result;
+        revSearch(board, &params, &result);
+        EXPECT_EQ(solveByMinimax(board, 0), result.score);
+    }
+}
+
+TEST_F(SearchTest, revSearchWLD) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.type = SEARCH_WLD;
+    for (int i = 0; i < 20; i++) {
+        revInitBoard(board);
+        playRandomly(9);
+        int exact = solveByMinimax(board, 0);
+        int expected = (exact > 0) ? REV_WLD_WIN : (exact < 0) ? REV_WLD_LOSS : REV_WLD_DRAW;
+        RevSearchResult result;
+        int move = revSearch(board, &params, &result);
+        EXPECT_EQ(expected, result.score);
+        EXPECT_EQ(expected, revSolveWLD(board));
+        if (!revHasLegalMoves(board)) {
+            EXPECT_EQ(-1, move);
+            continue;
+        }
+        // The move should keep the result.
+        ASSERT_TRUE(revIsLegalMove(board, move));
+        RevBoard *child = revNewBoard();
+        revCopyBoard(board, child);
+        revMove(child, move);
+        int child_exact = -solveByMinimax(child, 0);
+        EXPECT_EQ(expected, (child_exact > 0) - (child_exact < 0));
+        revFreeBoard(child);
+    }
+}
+
+TEST_F(SearchTest, revSearchWithHashTable) {
+    RevHashTable *hash = revNewHashTable(1);
+    ASSERT_TRUE(hash != NULL);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 0;
+    params.hash = hash;
+    for (int i = 0; i < 5; i++) {
+        revInitBoard(board);
+        playRandomly(9);
+        if (!revHasLegalMoves(board)) continue;
+        RevSearchResult result;
+        revSearch(board, &params, &result);
+        EXPECT_EQ(solveByMinimax(board, 0), result.score);
+        // The second search reuses the table.
+        RevSearchResult result2;
+        revSearch(board, &params, &result2);
+        EXPECT_EQ(result.score, result2.score);
+        EXPECT_LE(result2.nodes, result.nodes);
+    }
+    revClearHashTable(hash);
+    revFreeHashTable(hash);
+}
+
+TEST_F(SearchTest, revNewHashTableWithFlags) {
+    const int modes[] = {
+        0,
+        REV_HASH_TRANSPARENT_HUGE_PAGES,
+        REV_HASH_HUGE_PAGES,
+        REV_HASH_NUMA_INTERLEAVE,
+        REV_HASH_HUGE_PAGES | REV_HASH_TRANSPARENT_HUGE_PAGES | REV_HASH_NUMA_INTERLEAVE,
+    };
+    revInitBoard(board);
+    playRandomly(10);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 0;
+    int expected = 0;
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        RevHashTable *hash = revNewHashTableWithFlags(4, modes[i]);
+        ASSERT_TRUE(hash != NULL);
+        // Unavailable features fall back silently. Huge pages fall back to transparent ones.
+        int allowed = modes[i];
+        if (allowed & REV_HASH_HUGE_PAGES) allowed |= REV_HASH_TRANSPARENT_HUGE_PAGES;
+        const int flags = revGetHashTableFlags(hash);
+        EXPECT_EQ(flags, flags & allowed);
+        params.hash = hash;
+        RevSearchResult result;
+        revSearch(board, &params, &result);
+        if (i == 0)
+            expected = result.score;
+        EXPECT_EQ(expected, result.score);
+        revFreeHashTable(hash);
+    }
+    // Small tables never use huge pages.
+    RevHashTable *hash = revNewHashTableWithFlags(1, REV_HASH_TRANSPARENT_HUGE_PAGES);
+    ASSERT_TRUE(hash != NULL);
+    EXPECT_EQ(0, revGetHashTableFlags(hash));
+    revFreeHashTable(hash);
+}
+
+#ifndef _WIN32
+TEST_F(SearchTest, revOpenHashTable) {
+    const char *path = "hash_test.bin";
+    remove(path);
+    revInitBoard(board);
+    playRandomly(14);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 0;
+
+    RevHashTable *hash = revOpenHashTable(path, 4, 0);
+    ASSERT_TRUE(hash != NULL);
+    EXPECT_EQ(0, revGetHashTableFlags(hash));
+    params.hash = hash;
+    RevSearchResult cold;
+    revSearch(board, &params, &cold);
+    revFreeHashTable(hash);
+
+    // Another run starts warm. The size of the existing table is kept.
+    hash = revOpenHashTable(path, 16, 0);
+    ASSERT_TRUE(hash != NULL);
+    FILE *file = fopen(path, "rb");
+    ASSERT_TRUE(file != NULL);
+    fseek(file, 0, SEEK_END);
+    EXPECT_EQ(4096 + (4 << 20), ftell(file));
+    fclose(file);
+    params.hash = hash;
+    RevSearchResult warm;
+    revSearch(board, &params, &warm);
+    EXPECT_EQ(cold.score, warm.score);
+    EXPECT_LT(warm.nodes, cold.nodes);
+
+    // An incompatible table is not rebuilt while it's in use.
+    file = fopen(path, "r+b");
+    ASSERT_TRUE(file != NULL);
+    fseek(file, 8, SEEK_SET);
+    fputc(0xff, file);  // Version
+    fclose(file);
+    EXPECT_TRUE(revOpenHashTable(path, 4, 0) == NULL);
+    revFreeHashTable(hash);
+    hash = revOpenHashTable(path, 4, 0);
+    ASSERT_TRUE(hash != NULL);
+    params.hash = hash;
+    revSearch(board, &params, &warm);
+    EXPECT_EQ(cold.score, warm.score);
+    EXPECT_EQ(cold.nodes, warm.nodes);
+    revFreeHashTable(hash);
+
+    // Files that are not tables are kept.
+    file = fopen(path, "wb");
+    ASSERT_TRUE(file != NULL);
+    fputs("not a table", file);
+    fclose(file);
+    EXPECT_TRUE(revOpenHashTable(path, 4, 0) == NULL);
+
+    // Zeros are a table whose creator died only when the file has the size of a table.
+    const std::vector<char> zeros(4096 + 64 * 1024 + 1, 0);
+    file = fopen(path, "wb");
+    ASSERT_TRUE(file != NULL);
+    fwrite(zeros.data(), 1, zeros.size(), file);
+    fclose(file);
+    EXPECT_TRUE(revOpenHashTable(path, 4, 0) == NULL);
+    file = fopen(path, "rb");
+    ASSERT_TRUE(file != NULL);
+    std::vector<char> data(zeros.size() + 1);
+    EXPECT_EQ(zeros.size(), fread(data.data(), 1, data.size(), file));
+    fclose(file);
+    data.pop_back();
+    EXPECT_EQ(zeros, data);
+
+    file = fopen(path, "wb");
+    ASSERT_TRUE(file != NULL);
+    fwrite(zeros.data(), 1, zeros.size() - 1, file);
+    fclose(file);
+    hash = revOpenHashTable(path, 4, 0);
+    ASSERT_TRUE(hash != NULL);
+    revFreeHashTable(hash);
+    EXPECT_TRUE(revRemoveHashTable(path, 0));
+}
+
+TEST_F(SearchTest, revOpenHashTableSharedMemory) {
+    char name[64];
+    snprintf(name, sizeof(name), "/reversi_hash_test_%u", (unsigned)revGenIntRandom(0, 1 << 30));
+    revInitBoard(board);
+    playRandomly(14);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 0;
+
+    RevHashTable *hash = revOpenHashTable(name, 4, REV_HASH_SHARED_MEMORY);
+    ASSERT_TRUE(hash != NULL);
+    EXPECT_EQ(REV_HASH_SHARED_MEMORY, revGetHashTableFlags(hash));
+    // Attaching twice works like another process.
+    RevHashTable *other = revOpenHashTable(name, 4, REV_HASH_SHARED_MEMORY);
+    ASSERT_TRUE(other != NULL);
+    params.hash = hash;
+    RevSearchResult result;
+    revSearch(board, &params, &result);
+    params.hash = other;
+    RevSearchResult shared;
+    revSearch(board, &params, &shared);
+    EXPECT_EQ(result.score, shared.score);
+    EXPECT_LT(shared.nodes, result.nodes);
+
+    // Clearing one of them clears both.
+    revClearHashTable(hash);
+    revSearch(board, &params, &shared);
+    EXPECT_EQ(result.nodes, shared.nodes);
+    revFreeHashTable(other);
+    revFreeHashTable(hash);
+    EXPECT_TRUE(revRemoveHashTable(name, REV_HASH_SHARED_MEMORY));
+    EXPECT_FALSE(revRemoveHashTable(name, REV_HASH_SHARED_MEMORY));
+}
+#endif
+
+TEST_F(SearchTest, revSearchMultiThreaded) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 0;
+    for (int i = 0; i < 3; i++) {
+        revInitBoard(board);
+        playRandomly(12);
+        if (!revHasLegalMoves(board)) continue;
+        RevSearchResult result;
+        params.threads = 1;
+        revSearch(board, &params, &result);
+        // Lazy SMP should find the same exact score.
+        for (int threads : { 2, 4 }) {
+            RevSearchResult smp_result;
+            params.threads = threads;
+            int move = revSearch(board, &params, &smp_result);
+            EXPECT_TRUE(revIsLegalMove(board, move));
+            EXPECT_EQ(result.score, smp_result.score);
+        }
+    }
+}
+
+TEST_F(SearchTest, revSearchMonteCarloSeed) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.type = SEARCH_MONTE_CARLO;
+    params.trials = 1000;  // Not a multiple of the block size.
+    params.seed = 12345;
+    int differs = 0;
+    for (int i = 0; i < 3; i++) {
+        revInitBoard(board);
+        playRandomly(40);
+        if (!revHasLegalMoves(board)) continue;
+        params.threads = 1;
+        RevSearchResult result;
+        revSearch(board, &params, &result);
+        EXPECT_EQ(1000u, result.playouts);
+        // The same seed gives the same statistics with any number of threads.
+        for (int threads : { 1, 2, 3, 8 }) {
+            RevSearchResult mt_result;
+            params.threads = threads;
+            EXPECT_EQ(result.move, revSearch(board, &params, &mt_result));
+            EXPECT_EQ(result.score, mt_result.score);
+            EXPECT_EQ(result.playouts, mt_result.playouts);
+        }
+        params.seed++;
+        RevSearchResult other;
+        revSearch(board, &params, &other);
+        differs += other.move != result.move || other.score != result.score;
+        params.seed--;
+    }
+    EXPECT_GT(differs, 0);
+
+    // MCTS with one thread is also reproducible.
+    params.type = SEARCH_MCTS;
+    params.threads = 1;
+    RevSearchResult mcts_results[2];
+    for (RevSearchResult &mcts_result : mcts_results)
+        revSearch(board, &params, &mcts_result);
+    EXPECT_EQ(mcts_results[0].move, mcts_results[1].move);
+    EXPECT_EQ(mcts_results[0].score, mcts_results[1].score);
+    EXPECT_EQ(mcts_results[0].nodes, mcts_results[1].nodes);
+}
+
+TEST_F(SearchTest, revSearchTimed) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    RevSearchType types[] = { SEARCH_MONTE_CARLO, SEARCH_ALPHA_BETA };
+    for (RevSearchType type : types) {
+        params.type = type;
+        params.depth = 0;
+        params.trials = 0;
+        params.time_ms = 50;
+        RevSearchResult result;
+        int move = revSearch(board, &params, &result);
+        EXPECT_TRUE(revIsLegalMove(board, move));
+        EXPECT_TRUE(result.timed_out);
+        EXPECT_GE(result.elapsed_ms, 50);
+        EXPECT_LT(result.elapsed_ms, 500);
+        EXPECT_GT(result.nodes + result.playouts, 0);
+    }
+}
+
+TEST_F(SearchTest, revSearchNoMoves) {
+    revSetBitboard(board, DISK_WHITE, 0);
+    revUpdateMobility(board);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    EXPECT_EQ(-1, revSearch(board, &params, NULL));
+}
+
+TEST_F(SearchTest, revGenMoveTimed) {
+    int move = revGenMoveTimed(board, 20);
+    EXPECT_TRUE(revIsLegalMove(board, move));
+}
+
+TEST_F(SearchTest, revGenMoveAlphaBeta) {
+    // Test if revGenMoveAlphaBeta is stronger than revGenMoveRandom
+    int ab_win = 0;
+    int random_win = 0;
+    for (int i = 0; i < 10; i++) {
+        revInitBoard(board);
+        while (revHasLegalMoves(board)) {
+            int move;
+            if (revGetCurrentPlayer(board) == DISK_BLACK) {
+                move = revGenMoveAlphaBeta(board, 3);
+            } else {
+                move = revGenMoveRandom(board);
+            }
+            revMove(board, move);
+            if (!revHasLegalMoves(board)) {
+                revChangePlayer(board);
+            }
+        }
+        int winner = revGetWinner(board);
+        if (winner == DISK_BLACK) {
+            ab_win++;
+        } else if (winner == DISK_WHITE) {
+            random_win++;
+        }
+    }
+    printf("Alpha-Beta Search VS Random Move: W%d, L%d, D%d\n",
+           ab_win, random_win, 10 - ab_win - random_win);
+    EXPECT_GT(ab_win, random_win);
+}
+
+TEST_F(SearchTest, revSearchSelective) {
+    revInitGenRandom(3);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 8;
+    uint64_t full_nodes = 0;
+    uint64_t selective_nodes = 0;
+    for (int i = 0; i < 5; i++) {
+        revInitBoard(board);
+        playRandomly(40);
+        if (!revHasLegalMoves(board)) continue;
+        RevSearchResult result;
+        params.selectivity = 0;
+        revSearch(board, &params, &result);
+        full_nodes += result.nodes;
+        params.selectivity = 5;
+        int move = revSearch(board, &params, &result);
+        EXPECT_TRUE(revIsLegalMove(board, move));
+        EXPECT_EQ(8, result.depth);
+        selective_nodes += result.nodes;
+    }
+    EXPECT_LT(selective_nodes, full_nodes);
+}
+
+TEST_F(SearchTest, revSearchSelectiveExactScore) {
+    // Searches to the end are never pruned.
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 0;
+    params.selectivity = 5;
+    for (int i = 0; i < 5; i++) {
+        revInitBoard(board);
+        playRandomly(8);
+        if (!revHasLegalMoves(board)) continue;
+        RevSearchResult result;
+        revSearch(board, &params, &result);
+        EXPECT_EQ(solveByMinimax(board, 0), result.score);
+    }
+}
+
+TEST_F(SearchTest, revProbCutParamsFile) {
+    const char *path = "probcut_test.txt";
+    RevProbCutParams *params = revNewProbCutParams();
+    ASSERT_TRUE(params != NULL);
+    EXPECT_FALSE(revSetProbCutEntry(params, REV_PROBCUT_STAGES, 4, 2, 1.0, 0.0, 3.0));
+    EXPECT_FALSE(revSetProbCutEntry(params, 0, 4, 4, 1.0, 0.0, 3.0));
+    for (int stage = 0; stage < REV_PROBCUT_STAGES; stage++) {
+        for (int depth = 3; depth <= 8; depth++)
+            EXPECT_TRUE(revSetProbCutEntry(params, stage, depth, depth - 2, 1.0, 0.5, 2.0));
+    }
+    ASSERT_TRUE(revSaveProbCutParams(params, path));
+    RevProbCutParams *loaded = revLoadProbCutParams(path);
+    ASSERT_TRUE(loaded != NULL);
+
+    // Both of them should prune the same branches.
+    RevSearchParams search_params;
+    revInitSearchParams(&search_params);
+    search_params.depth = 7;
+    search_params.selectivity = 2;
+    playRandomly(44);
+    RevSearchResult result, loaded_result;
+    search_params.probcut = params;
+    revSearch(board, &search_params, &result);
+    search_params.probcut = loaded;
+    revSearch(board, &search_params, &loaded_result);
+    EXPECT_EQ(result.move, loaded_result.move);
+    EXPECT_EQ(result.score, loaded_result.score);
+    EXPECT_EQ(result.nodes, loaded_result.nodes);
+    revFreeProbCutParams(params);
+    revFreeProbCutParams(loaded);
+
+    FILE *file = fopen(path, "w");
+    ASSERT_TRUE(file != NULL);
+    fprintf(file, "# reversi-core ProbCut parameters\n0 4 1 broken\n");
+    fclose(file);
+    EXPECT_TRUE(revLoadProbCutParams(path) == NULL);
+    remove(path);
+    EXPECT_TRUE(revLoadProbCutParams(path) == NULL);
+}
+
+static void recordBatchResult(int index, const RevSearchResult *result, void *user_data) {
+    std::vector<int> *order = (std::vector<int> *)user_data;
+    order->push_back(index);
+    EXPECT_GE(result->move, 0);
+}
+
+TEST_F(SearchTest, revAnalyzeBatch) {
+    const int count = 12;
+    std::vector<RevBoard *> boards;
+    for (int i = 0; i < count; i++) {
+        RevBoard *b = revNewBoard();
+        do {
+            revInitBoard(board);
+            playRandomly(8);
+        } while (!revHasLegalMoves(board));
+        revCopyBoard(board, b);
+        boards.push_back(b);
+    }
+
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 0;
+    params.threads = 4;
+    std::vector<RevSearchResult> results(count);
+    std::vector<int> order;
+    revAnalyzeBatch(&boards[0], count, &params, &results[0], recordBatchResult, &order);
+
+    // Every position is reported once.
+    ASSERT_EQ(count, (int)order.size());
+    std::vector<int> sorted_order = order;
+    std::sort(sorted_order.begin(), sorted_order.end());
+    for (int i = 0; i < count; i++) {
+        EXPECT_EQ(i, sorted_order[i]);
+        EXPECT_TRUE(revIsLegalMove(boards[i], results[i].move));
+        EXPECT_EQ(solveByMinimax(boards[i], 0), results[i].score);
+    }
+
+    // Results and callback are optional.
+    params.depth = 2;
+    revAnalyzeBatch(&boards[0], count, &params, NULL, NULL, NULL);
+    for (RevBoard *b : boards)
+        revFreeBoard(b);
+}
+
+static void recordInfo(const RevSearchInfo *info, void *user_data) {
+    ((std::vector<RevSearchInfo> *)user_data)->push_back(*info);
+}
+
+// Checks that a line is a sequence of legal moves.
+static bool isLegalLine(RevBoard *board, const RevPvLine &line) {
+    RevBoard *b = revNewBoard();
+    revCopyBoard(board, b);
+    bool legal = line.length > 0;
+    for (int i = 0; legal && i < line.length; i++) {
+        if (line.pv[i] < 0) {
+            legal = !revHasLegalMoves(b);
+            revChangePlayer(b);
+        } else {
+            legal = revIsLegalMove(b, line.pv[i]);
+            revMove(b, line.pv[i]);
+        }
+    }
+    revFreeBoard(b);
+    return legal;
+}
+
+TEST_F(SearchTest, revSearchInfo) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 6;
+    params.info_interval_ms = 0;
+    std::vector<RevSearchInfo> infos;
+    params.info_callback = recordInfo;
+    params.info_data = &infos;
+    RevSearchResult result;
+    revSearch(board, &params, &result);
+
+    // Every iteration is reported without an interval.
+    ASSERT_EQ(6, (int)infos.size());
+    for (int i = 0; i < 6; i++) {
+        EXPECT_EQ(i + 1, infos[i].depth);
+        EXPECT_EQ(1, infos[i].line_count);
+        EXPECT_TRUE(isLegalLine(board, infos[i].lines[0]));
+        EXPECT_LE(infos[i].lines[0].length, i + 1);
+    }
+    EXPECT_EQ(result.move, infos[5].lines[0].pv[0]);
+    EXPECT_EQ(result.score, infos[5].lines[0].score);
+    EXPECT_GE(infos[5].lines[0].length, 4);
+    EXPECT_GT(infos[5].nodes, infos[0].nodes);
+
+    // A long interval skips iterations but keeps the last one.
+    infos.clear();
+    params.info_interval_ms = 100000;
+    revSearch(board, &params, &result);
+    ASSERT_GE(infos.size(), 1u);
+    EXPECT_LE(infos.size(), 2u);
+    EXPECT_EQ(6, infos.back().depth);
+}
+
+TEST_F(SearchTest, revSearchMultiPv) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 4;
+    params.info_interval_ms = 0;
+    params.multi_pv = 3;
+    std::vector<RevSearchInfo> infos;
+    params.info_callback = recordInfo;
+    params.info_data = &infos;
+    RevSearchParams child_params;
+    revInitSearchParams(&child_params);
+    child_params.depth = 3;
+    RevBoard *child = revNewBoard();
+    for (int n = 0; n < 5; n++) {
+        revInitBoard(board);
+        playRandomly(40);
+        if (revGetMobilityCount(board) < 3) continue;
+
+        // Exact scores of all moves, sorted
+        std::vector<int> expected;
+        int *moves = revGetMobilityAsArray(board);
+        bool has_pass = false;
+        for (int i = 0; i < revGetMobilityCount(board); i++) {
+            revCopyBoard(board, child);
+            revMove(child, moves[i]);
+            has_pass |= !revHasLegalMoves(child);
+            RevSearchResult child_result;
+            revSearch(child, &child_params, &child_result);
+            expected.push_back(-child_result.score);
+        }
+        free(moves);
+        if (has_pass) continue;
+        std::sort(expected.rbegin(), expected.rend());
+
+        infos.clear();
+        RevSearchResult result;
+        revSearch(board, &params, &result);
+        ASSERT_FALSE(infos.empty());
+        const RevSearchInfo &info = infos.back();
+        EXPECT_EQ(4, info.depth);
+        ASSERT_EQ(3, info.line_count);
+        for (int i = 0; i < 3; i++) {
+            EXPECT_EQ(expected[i], info.lines[i].score);
+            EXPECT_TRUE(isLegalLine(board, info.lines[i]));
+            for (int j = 0; j < i; j++)
+                EXPECT_NE(info.lines[i].pv[0], info.lines[j].pv[0]);
+        }
+        EXPECT_EQ(result.move, info.lines[0].pv[0]);
+        EXPECT_EQ(result.score, info.lines[0].score);
+    }
+    revFreeBoard(child);
+}
+
+TEST_F(SearchTest, revSearchMctsInfo) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.type = SEARCH_MCTS;
+    params.trials = 3000;
+    params.info_interval_ms = 0;
+    params.multi_pv = 2;
+    std::vector<RevSearchInfo> infos;
+    params.info_callback = recordInfo;
+    params.info_data = &infos;
+    RevSearchResult result;
+    revSearch(board, &params, &result);
+    ASSERT_GT(infos.size(), 1u);
+    const RevSearchInfo &info = infos.back();
+    EXPECT_EQ(3000u, info.playouts);
+    EXPECT_EQ(result.nodes, info.nodes);
+    ASSERT_EQ(2, info.line_count);
+    EXPECT_EQ(result.move, info.lines[0].pv[0]);
+    EXPECT_EQ(result.score, info.lines[0].score);
+    EXPECT_EQ(info.lines[0].length, info.depth);
+    EXPECT_GT(info.depth, 1);
+    for (int i = 0; i < 2; i++)
+        EXPECT_TRUE(isLegalLine(board, info.lines[i]));
+    for (size_t i = 1; i < infos.size(); i++)
+        EXPECT_GE(infos[i].playouts, infos[i - 1].playouts);
+}
+
+TEST_F(SearchTest, revSearchMcts) {
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.type = SEARCH_MCTS;
+    params.trials = 2000;
+    RevSearchResult result;
+    EXPECT_TRUE(revIsLegalMove(board, revSearch(board, &params, &result)));
+    EXPECT_EQ(2000, (int)result.playouts);
+    EXPECT_GT((int)result.nodes, 1);
+    EXPECT_GE(result.score, 0);
+    EXPECT_LE(result.score, 100);
+}
+
+TEST_F(SearchTest, revSearchMctsReuse) {
+    RevMcts *mcts = revNewMcts(4);
+    ASSERT_TRUE(mcts != NULL);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.trials = 3000;
+    int move = revSearchMcts(mcts, board, &params, NULL);
+    ASSERT_TRUE(revIsLegalMove(board, move));
+    EXPECT_EQ(3000, revMctsGetRootVisits(mcts));
+
+    // The subtree of the played move is kept.
+    revMove(board, move);
+    EXPECT_TRUE(revMctsAdvance(mcts, move));
+    const int kept = revMctsGetRootVisits(mcts);
+    EXPECT_GT(kept, 0);
+
+    // The opponent's reply is found by the next search without revMctsAdvance().
+    revMove(board, revGenMoveRandom(board));
+    move = revSearchMcts(mcts, board, &params, NULL);
+    EXPECT_TRUE(revIsLegalMove(board, move));
+    EXPECT_GT(revMctsGetRootVisits(mcts), 3000);
+
+    // An unrelated position starts a new tree.
+    revInitBoard(board);
+    revSearchMcts(mcts, board, &params, NULL);
+    EXPECT_EQ(3000, revMctsGetRootVisits(mcts));
+    EXPECT_FALSE(revMctsAdvance(mcts, 0));
+    EXPECT_EQ(0, revMctsGetRootVisits(mcts));
+    revFreeMcts(mcts);
+}
+
+TEST_F(SearchTest, revSearchMctsFullGame) {
+    // A small tree has to be compacted many times in a game.
+    RevMcts *mcts = revNewMcts(1);
+    ASSERT_TRUE(mcts != NULL);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.trials = 5000;
+    EXPECT_GT(playMctsAgainstRandom(board, mcts, &params, DISK_BLACK, 4), 0);
+    revFreeMcts(mcts);
+}
+
+TEST_F(SearchTest, revSetMctsRave) {
+    RevMcts *mcts = revNewMcts(1);
+    ASSERT_TRUE(mcts != NULL);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.trials = 2000;
+    params.seed = 777;
+    RevSearchResult plain;
+    revSearchMcts(mcts, board, &params, &plain);
+
+    // AMAF statistics change the choices of the tree.
+    revClearMcts(mcts);
+    revSetMctsRave(mcts, 300);
+    RevSearchResult rave;
+    EXPECT_TRUE(revIsLegalMove(board, revSearchMcts(mcts, board, &params, &rave)));
+    EXPECT_EQ(2000u, rave.playouts);
+    EXPECT_TRUE(rave.move != plain.move || rave.score != plain.score ||
+                rave.nodes != plain.nodes);
+
+    // Zero goes back to plain UCT.
+    revClearMcts(mcts);
+    revSetMctsRave(mcts, 0);
+    RevSearchResult disabled;
+    revSearchMcts(mcts, board, &params, &disabled);
+    EXPECT_EQ(plain.move, disabled.move);
+    EXPECT_EQ(plain.score, disabled.score);
+    EXPECT_EQ(plain.nodes, disabled.nodes);
+
+    // RAVE keeps working through compaction of a small tree in full games.
+    revSetMctsRave(mcts, 300);
+    params.seed = 0;
+    params.trials = 1000;
+    EXPECT_GT(playMctsAgainstRandom(board, mcts, &params, DISK_WHITE, 4), 0);
+    revFreeMcts(mcts);
+}
+
+struct EvaluatorLog {
+    int calls;
+    int positions;
+    int max_count;
+    int invalid;
+};
+
+// Disk difference as a win rate. It also checks the positions.
+static void evaluateByDisks(const RevPosition *positions, int count, float *values,
+                            void *user_data) {
+    EvaluatorLog *log = (EvaluatorLog *)user_data;
+    log->calls++;
+    log->positions += count;
+    log->max_count = std::max(log->max_count, count);
+    for (int i = 0; i < count; i++) {
+        RevBitboard p = positions[i].player;
+        RevBitboard o = positions[i].opponent;
+        if ((p & o) != 0 || revCountOnes(p | o) < 5) log->invalid++;
+        values[i] = 0.5f + (float)(revCountOnes(p) - revCountOnes(o)) / 128.0f;
+    }
+}
+
+TEST_F(SearchTest, revSetMctsEvaluator) {
+    RevMcts *mcts = revNewMcts(4);
+    ASSERT_TRUE(mcts != NULL);
+    EvaluatorLog log = { 0, 0, 0, 0 };
+    ASSERT_TRUE(revSetMctsEvaluator(mcts, evaluateByDisks, 16, &log));
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.trials = 2000;
+    RevSearchResult result;
+    EXPECT_TRUE(revIsLegalMove(board, revSearchMcts(mcts, board, &params, &result)));
+    EXPECT_EQ(2000, (int)result.playouts);
+    EXPECT_EQ(2000, revMctsGetRootVisits(mcts));
+    EXPECT_EQ(2000, log.positions);
+    EXPECT_EQ(16, log.max_count);
+    // Virtual losses spread most batches over different leaves.
+    EXPECT_LT(log.calls, 2000 / 4);
+    EXPECT_EQ(0, log.invalid);
+
+    // Back to random playouts
+    ASSERT_TRUE(revSetMctsEvaluator(mcts, NULL, 0, NULL));
+    revSearchMcts(mcts, board, &params, NULL);
+    EXPECT_EQ(4000, revMctsGetRootVisits(mcts));
+    EXPECT_EQ(2000, log.positions);
+    revFreeMcts(mcts);
+}
+
+struct SolvingEvaluator {
+    RevBoard *board;
+    RevSearchParams params;
+};
+
+// Exact win rates with SEARCH_WLD.
+static void evaluateBySolving(const RevPosition *positions, int count, float *values,
+                              void *user_data) {
+    SolvingEvaluator *solver = (SolvingEvaluator *)user_data;
+    for (int i = 0; i < count; i++) {
+        revInitBoard(solver->board);
+        revSetBitboard(solver->board, DISK_BLACK, positions[i].player);
+        revSetBitboard(solver->board, DISK_WHITE, positions[i].opponent);
+        revUpdateMobility(solver->board);
+        RevSearchResult result;
+        revSearch(solver->board, &solver->params, &result);
+        values[i] = (float)(result.score + 1) / 2.0f;
+    }
+}
+
+TEST_F(SearchTest, revSetMctsEvaluatorExact) {
+    // With exact values of leaves, the most visited move should keep the result of the game.
+    // Small endgames are searched to the end, so the averages of nodes converge to it.
+    RevMcts *mcts = revNewMcts(4);
+    ASSERT_TRUE(mcts != NULL);
+    SolvingEvaluator solver;
+    solver.board = revNewBoard();
+    revInitSearchParams(&solver.params);
+    solver.params.type = SEARCH_WLD;
+    solver.params.hash = revNewHashTable(1);
+    ASSERT_TRUE(solver.params.hash != NULL);
+    RevBoard *child = revNewBoard();
+    ASSERT_TRUE(revSetMctsEvaluator(mcts, evaluateBySolving, 8, &solver));
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.trials = 1000;
+    for (int i = 0; i < 5; i++) {
+        revInitBoard(board);
+        playRandomly(7);
+        if (!revHasLegalMoves(board)) continue;
+        revClearMcts(mcts);
+        int move = revSearchMcts(mcts, board, &params, NULL);
+        ASSERT_TRUE(revIsLegalMove(board, move));
+        revCopyBoard(board, child);
+        revMove(child, move);
+        EXPECT_EQ(revSolveWLD(board), -revSolveWLD(child));
+    }
+    revFreeBoard(child);
+    revFreeHashTable(solver.params.hash);
+    revFreeBoard(solver.board);
+    revFreeMcts(mcts);
+}
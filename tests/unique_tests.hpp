@@ -0,0 +1,134 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <set>
+#include <utility>
+#include <vector>
+#include "reversi.h"
+#include "helpers.hpp"
+
+typedef std::pair<RevBitboard, RevBitboard> UniquePosition;
+
+static UniquePosition canonicalBySquares(RevBitboard p, RevBitboard o) {
+    UniquePosition best(p, o);
+    for (int s = 1; s < 8; s++)
+        best = std::min(best, UniquePosition(transformBySquares(p, s), transformBySquares(o, s)));
+    return best;
+}
+
+// Counts unique positions with std::set and RevBoard.
+static std::vector<uint64_t> countUniqueBySet(int depth) {
+    std::vector<uint64_t> counts;
+    RevBoard *board = revNewBoard();
+    RevBoard *child = revNewBoard();
+    std::set<UniquePosition> level;
+    level.insert(canonicalBySquares(revGetBitboard(board, DISK_BLACK),
+                                    revGetBitboard(board, DISK_WHITE)));
+    counts.push_back(level.size());
+    for (int ply = 1; ply <= depth; ply++) {
+        std::set<UniquePosition> next;
+        for (const UniquePosition &pos : level) {
+            revInitBoard(board);
+            revSetBitboard(board, DISK_BLACK, pos.first);
+            revSetBitboard(board, DISK_WHITE, pos.second);
+            revUpdateMobility(board);
+            int *moves = revGetMobilityAsArray(board);
+            for (int i = 0; i < revGetMobilityCount(board); i++) {
+                revCopyBoard(board, child);
+                revMove(child, moves[i]);
+                if (!revHasLegalMoves(child)) {
+                    revChangePlayer(child);
+                    // Game over. It's stored from the side after the move.
+                    if (!revHasLegalMoves(child)) revChangePlayer(child);
+                }
+                RevDiskType p = revGetCurrentPlayer(child);
+                next.insert(canonicalBySquares(revGetBitboard(child, p),
+                                               revGetBitboard(child, (RevDiskType)!p)));
+            }
+            free(moves);
+        }
+        level.swap(next);
+        counts.push_back(level.size());
+    }
+    revFreeBoard(child);
+    revFreeBoard(board);
+    return counts;
+}
+
+class UniqueTest : public ::testing::Test {
+ protected:
+    RevEnumParams params;
+
+    virtual void SetUp() {
+        revInitEnumParams(&params);
+    }
+};
+
+TEST_F(UniqueTest, revCountUniquePositions) {
+    const int depth = 7;
+    std::vector<uint64_t> expected = countUniqueBySet(depth);
+    const uint64_t known[] = { 1, 1, 3, 14, 60, 322, 1773, 10649 };
+    for (int i = 0; i <= depth; i++)
+        EXPECT_EQ(known[i], expected[i]);
+    for (int threads : { 1, 3 }) {
+        uint64_t counts[depth + 1];
+        params.threads = threads;
+        ASSERT_TRUE(revCountUniquePositions(depth, &params, counts));
+        for (int i = 0; i <= depth; i++)
+            EXPECT_EQ(expected[i], counts[i]);
+    }
+}
+
+static void countPlies(int ply, uint64_t count, void *user_data) {
+    std::vector<uint64_t> *plies = (std::vector<uint64_t> *)user_data;
+    EXPECT_EQ((int)plies->size(), ply);
+    plies->push_back(count);
+}
+
+TEST_F(UniqueTest, revCountUniquePositionsWithFiles) {
+    // Ply 8 needs more than 1 MB, so it's sorted in parts and merged from files.
+    const int depth = 8;
+    std::vector<uint64_t> expected = countUniqueBySet(depth);
+    for (const char *temp_dir : { (const char *)NULL, "." }) {
+        for (int threads : { 1, 4 }) {
+            std::vector<uint64_t> plies;
+            uint64_t counts[depth + 1];
+            params.threads = threads;
+            params.memory_mb = 1;
+            params.temp_dir = temp_dir;
+            params.output_path = "unique_test.bin";
+            params.callback = countPlies;
+            params.user_data = &plies;
+            ASSERT_TRUE(revCountUniquePositions(depth, &params, counts));
+            EXPECT_EQ(expected, plies);
+            for (int i = 0; i <= depth; i++)
+                EXPECT_EQ(expected[i], counts[i]);
+
+            // The output has sorted canonical positions.
+            FILE *file = fopen("unique_test.bin", "rb");
+            ASSERT_TRUE(file != NULL);
+            std::vector<RevBitboard> keys(2 * counts[depth] + 2);
+            size_t read = fread(keys.data(), sizeof(RevBitboard), keys.size(), file);
+            fclose(file);
+            ASSERT_EQ(2 * counts[depth], read);
+            for (size_t i = 0; i < read; i += 2) {
+                UniquePosition pos(keys[i], keys[i + 1]);
+                EXPECT_EQ(canonicalBySquares(pos.first, pos.second), pos);
+                if (i > 0) {
+                    EXPECT_LT(UniquePosition(keys[i - 2], keys[i - 1]), pos);
+                }
+            }
+        }
+    }
+    remove("unique_test.bin");
+}
+
+TEST_F(UniqueTest, revCountUniquePositionsWithBadTempDir) {
+    // Ply 8 needs files, and they can't be made. The run fails cleanly.
+    uint64_t counts[10];
+    params.threads = 1;
+    params.memory_mb = 1;
+    params.temp_dir = "/nonexistent/reversi-core";
+    EXPECT_FALSE(revCountUniquePositions(9, &params, counts));
+    EXPECT_EQ(10649u, counts[7]);
+}
@@ -0,0 +1,190 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <vector>
+#include "reversi.hpp"
+
+class WrapperTest : public ::testing::Test {
+ protected:
+    RevBoard* board;
+
+    virtual void SetUp() {
+        board = revNewBoard();
+        ASSERT_TRUE(board != NULL);
+    }
+
+    virtual void TearDown() {
+        revFreeBoard(board);
+    }
+};
+
+template <rev::Color Side>
+static uint64_t perft(const rev::Board &board, int depth, bool passed = false) {
+    if (depth == 0) return 1;
+    constexpr rev::Color opp = rev::opponent(Side);
+    const rev::Bitboard moves = board.mobility<Side>();
+    if (moves == 0) {
+        if (passed) return 1;  // The game is over.
+        rev::Board next = board;
+        next.pass();
+        return perft<opp>(next, depth - 1, true);
+    }
+    uint64_t count = 0;
+    for (int pos : rev::squares(moves)) {
+        rev::Board next = board;
+        next.play<Side>(pos);
+        count += perft<opp>(next, depth - 1);
+    }
+    return count;
+}
+
+TEST_F(WrapperTest, Squares) {
+    std::vector<int> positions;
+    for (int pos : rev::squares(0x8000000000010005))
+        positions.push_back(pos);
+    EXPECT_EQ(std::vector<int>({ 0, 2, 16, 63 }), positions);
+    for (int pos : rev::squares(0)) {
+        ADD_FAILURE() << pos;
+    }
+}
+
+TEST_F(WrapperTest, InitialBoard) {
+    constexpr rev::Board initial;
+    static_assert(initial.disks<rev::Color::Black>() == 0x0000000810000000, "");
+    EXPECT_EQ(revGetMobility(board), initial.mobility());
+    EXPECT_EQ(initial, rev::Board::fromC(board));
+    EXPECT_EQ(60, rev::countOnes(initial.empties()));
+}
+
+TEST_F(WrapperTest, SameAsC) {
+    // Play random games with both APIs and compare them after every move.
+    for (int i = 0; i < 50; i++) {
+        revInitBoard(board);
+        rev::Board b;
+        while (revHasLegalMoves(board)) {
+            ASSERT_EQ(revGetMobility(board), b.mobility());
+            const int move = revGenMoveRandom(board);
+            EXPECT_EQ(revMove(board, move), b.play(move));
+            if (!revHasLegalMoves(board)) {
+                revChangePlayer(board);
+                b.pass();
+            }
+            ASSERT_EQ(rev::Board::fromC(board), b);
+        }
+        EXPECT_EQ(0u, b.mobility<rev::Color::Black>() | b.mobility<rev::Color::White>());
+    }
+}
+
+TEST_F(WrapperTest, ToC) {
+    rev::Board b;
+    b.play(19);
+    b.toC(board);
+    EXPECT_EQ(DISK_WHITE, revGetCurrentPlayer(board));
+    EXPECT_EQ(b.disks(rev::Color::Black), revGetBitboard(board, DISK_BLACK));
+    EXPECT_EQ(b.mobility(), revGetMobility(board));
+    EXPECT_EQ(3, revGetMobilityCount(board));
+}
+
+TEST_F(WrapperTest, Perft) {
+    // Known numbers of leaf nodes from the initial board.
+    const uint64_t expected[] = { 1, 4, 12, 56, 244, 1396, 8200, 55092, 390216 };
+    for (int depth = 0; depth < 9; depth++)
+        EXPECT_EQ(expected[depth], perft<rev::Color::Black>(rev::Board(), depth));
+}
+
+template <class Bits>
+static bool isTrueAt(Bits b, int pos) {
+    return ((b >> pos) & Bits(1)) != Bits(0);
+}
+
+// Flipped disks by walking squares with coordinates.
+template <int N>
+static typename rev::Geometry<N>::Bits flippedBySquares(typename rev::Geometry<N>::Bits p,
+                                                        typename rev::Geometry<N>::Bits o,
+                                                        int pos) {
+    using Bits = typename rev::Geometry<N>::Bits;
+    Bits flipped = 0;
+    if (isTrueAt(p | o, pos)) return flipped;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            if (dx == 0 && dy == 0) continue;
+            Bits line = 0;
+            int x = pos % N + dx;
+            int y = pos / N + dy;
+            for (; x >= 0 && x < N && y >= 0 && y < N && isTrueAt(o, x + y * N); x += dx, y += dy)
+                line |= Bits(1) << (x + y * N);
+            if (x >= 0 && x < N && y >= 0 && y < N && isTrueAt(p, x + y * N))
+                flipped |= line;
+        }
+    }
+    return flipped;
+}
+
+// Plays random games and compares move generation with the coordinate-based one.
+template <int N>
+static void checkRandomGames(int games) {
+    using Board = rev::BasicBoard<N>;
+    using Bits = typename Board::Bits;
+    for (int i = 0; i < games; i++) {
+        Board board;
+        for (int passes = 0; passes < 2;) {
+            const rev::Color side = board.player();
+            const Bits p = board.disks(side);
+            const Bits o = board.disks(rev::opponent(side));
+            Bits expected = 0;
+            for (int pos = 0; pos < N * N; pos++) {
+                if (flippedBySquares<N>(p, o, pos) != Bits(0))
+                    expected |= Bits(1) << pos;
+            }
+            const Bits moves = board.mobility();
+            ASSERT_TRUE(expected == moves) << "size " << N << ", game " << i;
+            if (moves == Bits(0)) {
+                board.pass();
+                passes++;
+                continue;
+            }
+            passes = 0;
+            std::vector<int> positions;
+            for (int pos : rev::squares(moves))
+                positions.push_back(pos);
+            const int move = positions[revGenIntRandom(0, (int)positions.size() - 1)];
+            ASSERT_TRUE(flippedBySquares<N>(p, o, move) == board.play(move));
+        }
+        EXPECT_EQ(N * N, rev::countOnes(board.disks(rev::Color::Black) |
+                                        board.disks(rev::Color::White)) +
+                         rev::countOnes(board.empties()));
+    }
+}
+
+TEST_F(WrapperTest, OtherSizes) {
+    static_assert(sizeof(rev::Board6::Bits) == 8, "6x6 should fit in 64 bits.");
+    static_assert(sizeof(rev::Board10::Bits) == 16, "10x10 should use 128 bits.");
+    constexpr rev::Board6 b6;
+    static_assert(b6.disks<rev::Color::Black>() == ((1ull << 15) | (1ull << 20)), "");
+    EXPECT_EQ(32, rev::countOnes(b6.empties()));
+    EXPECT_EQ(4, rev::countOnes(b6.mobility()));
+    rev::Board10 b10;
+    EXPECT_EQ(96, rev::countOnes(b10.empties()));
+    EXPECT_EQ(4, rev::countOnes(b10.mobility()));
+    checkRandomGames<4>(50);
+    checkRandomGames<6>(50);
+    checkRandomGames<8>(20);
+    checkRandomGames<10>(20);
+}
+
+TEST_F(WrapperTest, GenericKernels) {
+    // The shift-only kernels for 8x8 should agree with the fast ones.
+    for (int i = 0; i < 50; i++) {
+        revInitBoard(board);
+        while (revHasLegalMoves(board)) {
+            RevDiskType p = revGetCurrentPlayer(board);
+            rev::Bitboard p_board = revGetBitboard(board, p);
+            rev::Bitboard o_board = revGetBitboard(board, (RevDiskType)!p);
+            ASSERT_EQ(rev::mobility(p_board, o_board), rev::Kernels<8>::mobility(p_board, o_board));
+            const int move = revGenMoveRandom(board);
+            ASSERT_EQ(rev::flipped(p_board, o_board, move),
+                      rev::Kernels<8>::flipped(p_board, o_board, move));
+            revMove(board, move);
+            if (!revHasLegalMoves(board)) revChangePlayer(board);
+        }
+    }
+}
@@ -0,0 +1,901 @@
+// Benchmarks for reversi-core.
+// Usage: bench <workload> [args...]
+#ifndef _WIN32
+// clock_gettime() is hidden in strict C99 mode.
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "reversi.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define POSITION_COUNT 8
+
+// Wall-clock time for workloads that run searches in parallel.
+static uint64_t getWallUs(void) {
+#ifdef _WIN32
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (uint64_t)(count.QuadPart / freq.QuadPart * 1000000 +
+                      count.QuadPart % freq.QuadPart * 1000000 / freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+#endif
+}
+
+static uint64_t getWallMs(void) {
+    return getWallUs() / 1000;
+}
+
+static int countEmpties(RevBoard *board) {
+    return 64 - revCountDisks(board, DISK_BLACK) - revCountDisks(board, DISK_WHITE);
+}
+
+// Makes a fixed set of positions with seeded random moves.
+static void makePositions(RevBoard **boards, int count, int empties, uint32_t seed) {
+    revInitGenRandom(seed);
+    for (int i = 0; i < count; i++) {
+        RevBoard *board = revNewBoard();
+        for (;;) {
+            revInitBoard(board);
+            while (revHasLegalMoves(board) && countEmpties(board) > empties) {
+                revMove(board, revGenMoveRandom(board));
+                if (!revHasLegalMoves(board))
+                    revChangePlayer(board);
+            }
+            if (revHasLegalMoves(board)) break;
+        }
+        boards[i] = board;
+    }
+}
+
+static void freePositions(RevBoard **boards, int count) {
+    for (int i = 0; i < count; i++)
+        revFreeBoard(boards[i]);
+}
+
+// Measures the speedup and the search overhead of Lazy SMP.
+// Overhead is the ratio of extra nodes compared to one thread.
+static int benchSmp(int argc, char *argv[]) {
+    const int max_threads = (argc > 0) ? atoi(argv[0]) : 4;
+    const int depth = (argc > 1) ? atoi(argv[1]) : 9;
+    RevBoard *boards[POSITION_COUNT];
+    makePositions(boards, POSITION_COUNT, 36, 12345);
+    RevHashTable *hash = revNewHashTable(64);
+    if (hash == NULL) {
+        printf("Failed to allocate a transposition table.\n");
+        return 1;
+    }
+
+    printf("Lazy SMP: %d positions, depth %d\n", POSITION_COUNT, depth);
+    printf("threads  time(ms)        nodes     knps  speedup  overhead\n");
+    double base_time = 0;
+    double base_nodes = 0;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        RevSearchParams params;
+        revInitSearchParams(&params);
+        params.depth = depth;
+        params.threads = threads;
+        params.hash = hash;
+        uint64_t nodes = 0;
+        int elapsed_ms = 0;
+        for (int i = 0; i < POSITION_COUNT; i++) {
+            RevSearchResult result;
+            revClearHashTable(hash);
+            revSearch(boards[i], &params, &result);
+            nodes += result.nodes;
+            elapsed_ms += result.elapsed_ms;
+        }
+        if (threads == 1) {
+            base_time = elapsed_ms;
+            base_nodes = (double)nodes;
+        }
+        printf("%7d  %8d  %11llu  %7.0f  %7.2f  %7.1f%%\n",
+               threads, elapsed_ms, (unsigned long long)nodes,
+               (double)nodes / (elapsed_ms > 0 ? elapsed_ms : 1),
+               base_time / (elapsed_ms > 0 ? elapsed_ms : 1),
+               ((double)nodes / base_nodes - 1.0) * 100.0);
+    }
+    revFreeHashTable(hash);
+    freePositions(boards, POSITION_COUNT);
+    return 0;
+}
+
+// Measures root-parallel Monte Carlo Search, and checks that a fixed seed gives the same
+// results with any number of threads.
+static int benchMonteCarlo(int argc, char *argv[]) {
+    const int max_threads = (argc > 0) ? atoi(argv[0]) : 4;
+    const int trials = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 100000;
+    RevBoard *boards[POSITION_COUNT];
+    makePositions(boards, POSITION_COUNT, 40, 13579);
+    int moves[POSITION_COUNT];
+    int scores[POSITION_COUNT];
+
+    printf("Monte Carlo: %d positions, %d trials\n", POSITION_COUNT, trials);
+    printf("threads  time(ms)  playouts/s  speedup  same\n");
+    double base_time = 0;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        RevSearchParams params;
+        revInitSearchParams(&params);
+        params.type = SEARCH_MONTE_CARLO;
+        params.trials = trials;
+        params.threads = threads;
+        params.seed = 24680;
+        uint64_t playouts = 0;
+        int same = 1;
+        const uint64_t start = getWallMs();
+        for (int i = 0; i < POSITION_COUNT; i++) {
+            RevSearchResult result;
+            revSearch(boards[i], &params, &result);
+            playouts += result.playouts;
+            if (threads == 1) {
+                moves[i] = result.move;
+                scores[i] = result.score;
+            }
+            same &= result.move == moves[i] && result.score == scores[i];
+        }
+        const int elapsed_ms = (int)(getWallMs() - start);
+        if (threads == 1)
+            base_time = elapsed_ms;
+        printf("%7d  %8d  %10.0f  %7.2f  %4s\n",
+               threads, elapsed_ms, (double)playouts * 1000 / (elapsed_ms > 0 ? elapsed_ms : 1),
+               base_time / (elapsed_ms > 0 ? elapsed_ms : 1), same ? "yes" : "no");
+    }
+    freePositions(boards, POSITION_COUNT);
+    return 0;
+}
+
+// Measures searches with big transposition tables on each type of memory.
+// Each mode reports the fastest of 3 rounds, because the gain is a few percent.
+static int benchHash(int argc, char *argv[]) {
+    const int size_mb = (argc > 0 && atoi(argv[0]) > 0) ? atoi(argv[0]) : 1024;
+    const int depth = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 11;
+    RevBoard *boards[POSITION_COUNT];
+    makePositions(boards, POSITION_COUNT, 36, 12345);
+    static const struct {
+        const char *name;
+        int flags;
+    } modes[] = {
+        { "4KB pages", 0 },
+        { "THP", REV_HASH_TRANSPARENT_HUGE_PAGES },
+        { "hugetlb", REV_HASH_HUGE_PAGES },
+        { "THP+NUMA", REV_HASH_TRANSPARENT_HUGE_PAGES | REV_HASH_NUMA_INTERLEAVE },
+    };
+
+    printf("Hash: %d MB, %d positions, depth %d\n", size_mb, POSITION_COUNT, depth);
+    printf("       mode  flags  alloc(ms)  time(ms)        nodes     knps\n");
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        const uint64_t start = getWallMs();
+        RevHashTable *hash = revNewHashTableWithFlags(size_mb, modes[m].flags);
+        if (hash == NULL) {
+            printf("Failed to allocate a transposition table.\n");
+            return 1;
+        }
+        const int alloc_ms = (int)(getWallMs() - start);
+        RevSearchParams params;
+        revInitSearchParams(&params);
+        params.depth = depth;
+        params.hash = hash;
+        uint64_t nodes = 0;
+        int elapsed_ms = 0;
+        for (int round = 0; round < 3; round++) {
+            revClearHashTable(hash);
+            uint64_t round_nodes = 0;
+            const uint64_t round_start = getWallMs();
+            for (int i = 0; i < POSITION_COUNT; i++) {
+                RevSearchResult result;
+                revSearch(boards[i], &params, &result);
+                round_nodes += result.nodes;
+            }
+            const int round_ms = (int)(getWallMs() - round_start);
+            if (round == 0 || round_ms < elapsed_ms) {
+                elapsed_ms = round_ms;
+                nodes = round_nodes;
+            }
+        }
+        printf("  %9s  %5d  %9d  %8d  %11llu  %7.0f\n", modes[m].name,
+               revGetHashTableFlags(hash), alloc_ms, elapsed_ms, (unsigned long long)nodes,
+               (double)nodes / (elapsed_ms > 0 ? elapsed_ms : 1));
+        revFreeHashTable(hash);
+    }
+    freePositions(boards, POSITION_COUNT);
+    return 0;
+}
+
+// Measures exact endgame solving.
+static int benchEndgame(int argc, char *argv[]) {
+    const int empties = (argc > 0) ? atoi(argv[0]) : 16;
+    RevBoard *boards[POSITION_COUNT];
+    makePositions(boards, POSITION_COUNT, empties, 54321);
+    RevHashTable *hash = revNewHashTable(64);
+    if (hash == NULL) {
+        printf("Failed to allocate a transposition table.\n");
+        return 1;
+    }
+
+    printf("Endgame: %d positions, %d empties\n", POSITION_COUNT, empties);
+    printf("position  score  time(ms)        nodes\n");
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 0;
+    params.hash = hash;
+    uint64_t nodes = 0;
+    int elapsed_ms = 0;
+    for (int i = 0; i < POSITION_COUNT; i++) {
+        RevSearchResult result;
+        revClearHashTable(hash);
+        revSearch(boards[i], &params, &result);
+        printf("%8d  %5d  %8d  %11llu\n",
+               i, result.score, result.elapsed_ms, (unsigned long long)result.nodes);
+        nodes += result.nodes;
+        elapsed_ms += result.elapsed_ms;
+    }
+    printf("   total         %8d  %11llu\n", elapsed_ms, (unsigned long long)nodes);
+    revFreeHashTable(hash);
+    freePositions(boards, POSITION_COUNT);
+    return 0;
+}
+
+typedef struct CostlyEvaluator {
+    int call_us;  // Fixed cost of each call, like launching a neural network
+    int calls;
+} CostlyEvaluator;
+
+// Disk difference as a win rate, after busy-waiting for the cost of the call.
+static void evaluateCostly(const RevPosition *positions, int count, float *values,
+                           void *user_data) {
+    CostlyEvaluator *evaluator = (CostlyEvaluator *)user_data;
+    const uint64_t end = getWallUs() + (uint64_t)evaluator->call_us;
+    while (getWallUs() < end) {}
+    for (int i = 0; i < count; i++) {
+        const int diff = revCountOnes(positions[i].player) - revCountOnes(positions[i].opponent);
+        values[i] = 0.5f + (float)diff / 128.0f;
+    }
+    evaluator->calls++;
+}
+
+// Leaves per second of MCTS with an evaluator that has a fixed cost per call.
+static int benchMctsBatch(int argc, char *argv[]) {
+    const int time_ms = (argc > 0) ? atoi(argv[0]) : 1000;
+    const int call_us = (argc > 1) ? atoi(argv[1]) : 100;
+    RevMcts *mcts = revNewMcts(64);
+    if (mcts == NULL) {
+        printf("Failed to allocate memory.\n");
+        return 1;
+    }
+    RevBoard *boards[POSITION_COUNT];
+    makePositions(boards, POSITION_COUNT, 40, 13579);
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.time_ms = time_ms / POSITION_COUNT;
+    params.trials = 0;
+
+    printf("MCTS batch: %d positions, %d ms each, %d us per call\n",
+           POSITION_COUNT, params.time_ms, call_us);
+    printf("batch  leaves/s  leaves/call  speedup\n");
+    static const int batch_sizes[] = { 1, 4, 16, 64, 256 };
+    double base = 0;
+    for (int i = 0; i < 5; i++) {
+        CostlyEvaluator evaluator = { call_us, 0 };
+        revSetMctsEvaluator(mcts, evaluateCostly, batch_sizes[i], &evaluator);
+        uint64_t leaves = 0;
+        int elapsed_ms = 0;
+        for (int j = 0; j < POSITION_COUNT; j++) {
+            RevSearchResult result;
+            revClearMcts(mcts);
+            revSearchMcts(mcts, boards[j], &params, &result);
+            leaves += result.playouts;
+            elapsed_ms += result.elapsed_ms;
+        }
+        const double rate = (double)leaves * 1000 / (elapsed_ms > 0 ? elapsed_ms : 1);
+        if (i == 0) base = rate;
+        printf("%5d  %8.0f  %11.1f  %6.2fx\n", batch_sizes[i], rate,
+               (double)leaves / (evaluator.calls > 0 ? evaluator.calls : 1), rate / base);
+    }
+    freePositions(boards, POSITION_COUNT);
+    revFreeMcts(mcts);
+    return 0;
+}
+
+// Compares the win/loss/draw solver with exact solving on the same positions.
+static int benchWld(int argc, char *argv[]) {
+    const int empties = (argc > 0) ? atoi(argv[0]) : 18;
+    RevBoard *boards[POSITION_COUNT];
+    makePositions(boards, POSITION_COUNT, empties, 54321);
+    RevHashTable *hash = revNewHashTable(64);
+    if (hash == NULL) {
+        printf("Failed to allocate a transposition table.\n");
+        return 1;
+    }
+
+    printf("WLD: %d positions, %d empties\n", POSITION_COUNT, empties);
+    printf("position  exact  wld  exact(ms)  wld(ms)  exact_nodes    wld_nodes\n");
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = 0;
+    params.hash = hash;
+    uint64_t nodes[2] = { 0, 0 };
+    int elapsed_ms[2] = { 0, 0 };
+    int mismatches = 0;
+    for (int i = 0; i < POSITION_COUNT; i++) {
+        RevSearchResult results[2];
+        for (int j = 0; j < 2; j++) {
+            params.type = (j == 0) ? SEARCH_ALPHA_BETA : SEARCH_WLD;
+            revClearHashTable(hash);
+            revSearch(boards[i], &params, &results[j]);
+            nodes[j] += results[j].nodes;
+            elapsed_ms[j] += results[j].elapsed_ms;
+        }
+        const int sign = (results[0].score > 0) - (results[0].score < 0);
+        if (sign != results[1].score) mismatches++;
+        printf("%8d  %5d  %3d  %9d  %7d  %11llu  %11llu\n", i, results[0].score,
+               results[1].score, results[0].elapsed_ms, results[1].elapsed_ms,
+               (unsigned long long)results[0].nodes, (unsigned long long)results[1].nodes);
+    }
+    printf("   total              %9d  %7d  %11llu  %11llu\n", elapsed_ms[0], elapsed_ms[1],
+           (unsigned long long)nodes[0], (unsigned long long)nodes[1]);
+    printf("speedup: %.2fx, mismatches: %d\n",
+           (double)elapsed_ms[0] / (elapsed_ms[1] > 0 ? elapsed_ms[1] : 1), mismatches);
+    revFreeHashTable(hash);
+    freePositions(boards, POSITION_COUNT);
+    return mismatches > 0;
+}
+
+// Compares selectivity levels of Multi-ProbCut with the full-width search.
+// Agreement is the ratio of positions where the best move is the same as the full-width one.
+static int benchProbCut(int argc, char *argv[]) {
+    const int depth = (argc > 0) ? atoi(argv[0]) : 10;
+    RevProbCutParams *probcut = NULL;
+    if (argc > 1) {
+        probcut = revLoadProbCutParams(argv[1]);
+        if (probcut == NULL) {
+            printf("Failed to load %s.\n", argv[1]);
+            return 1;
+        }
+    }
+    RevBoard *boards[POSITION_COUNT];
+    makePositions(boards, POSITION_COUNT, 40, 24680);
+    RevHashTable *hash = revNewHashTable(64);
+    if (hash == NULL) {
+        printf("Failed to allocate a transposition table.\n");
+        return 1;
+    }
+
+    printf("Multi-ProbCut: %d positions, depth %d\n", POSITION_COUNT, depth);
+    printf("selectivity  time(ms)        nodes  speedup  agreement  score_diff\n");
+    int full_moves[POSITION_COUNT];
+    int full_scores[POSITION_COUNT];
+    double base_time = 0;
+    for (int selectivity = 0; selectivity <= 5; selectivity++) {
+        RevSearchParams params;
+        revInitSearchParams(&params);
+        params.depth = depth;
+        params.hash = hash;
+        params.selectivity = selectivity;
+        params.probcut = probcut;
+        uint64_t nodes = 0;
+        int elapsed_ms = 0;
+        int agreed = 0;
+        int score_diff = 0;
+        for (int i = 0; i < POSITION_COUNT; i++) {
+            RevSearchResult result;
+            revClearHashTable(hash);
+            revSearch(boards[i], &params, &result);
+            if (selectivity == 0) {
+                full_moves[i] = result.move;
+                full_scores[i] = result.score;
+            }
+            agreed += result.move == full_moves[i];
+            score_diff += abs(result.score - full_scores[i]);
+            nodes += result.nodes;
+            elapsed_ms += result.elapsed_ms;
+        }
+        if (selectivity == 0)
+            base_time = elapsed_ms;
+        printf("%11d  %8d  %11llu  %7.2f  %8d%%  %10.2f\n",
+               selectivity, elapsed_ms, (unsigned long long)nodes,
+               base_time / (elapsed_ms > 0 ? elapsed_ms : 1),
+               agreed * 100 / POSITION_COUNT, (double)score_diff / POSITION_COUNT);
+    }
+    revFreeHashTable(hash);
+    revFreeProbCutParams(probcut);
+    freePositions(boards, POSITION_COUNT);
+    return 0;
+}
+
+// Compares revAnalyzeBatch() with a loop of revSearch() calls on the same positions.
+static int benchBatch(int argc, char *argv[]) {
+    const int count = (argc > 0) ? atoi(argv[0]) : 200;
+    const int threads = (argc > 1) ? atoi(argv[1]) : 4;
+    const int depth = (argc > 2) ? atoi(argv[2]) : 6;
+    if (count <= 0) return 1;
+    RevBoard **boards = (RevBoard **)malloc(sizeof(RevBoard *) * count);
+    RevSearchResult *results = (RevSearchResult *)malloc(sizeof(RevSearchResult) * count);
+    RevHashTable *hash = revNewHashTable(64);
+    if (boards == NULL || results == NULL || hash == NULL) {
+        printf("Failed to allocate memory.\n");
+        return 1;
+    }
+    makePositions(boards, count, 36, 13579);
+
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = depth;
+    params.hash = hash;
+    printf("Batch: %d positions, depth %d\n", count, depth);
+    printf("     mode  threads  time(ms)  positions/s\n");
+
+    revClearHashTable(hash);
+    uint64_t start = getWallMs();
+    for (int i = 0; i < count; i++)
+        revSearch(boards[i], &params, &results[i]);
+    const int serial_ms = (int)(getWallMs() - start);
+    printf("   serial  %7d  %8d  %11.1f\n", 1, serial_ms,
+           count * 1000.0 / (serial_ms > 0 ? serial_ms : 1));
+
+    for (int t = 1; t <= threads; t *= 2) {
+        params.threads = t;
+        revClearHashTable(hash);
+        start = getWallMs();
+        revAnalyzeBatch(boards, count, &params, results, NULL, NULL);
+        const int batch_ms = (int)(getWallMs() - start);
+        printf("    batch  %7d  %8d  %11.1f\n", t, batch_ms,
+               count * 1000.0 / (batch_ms > 0 ? batch_ms : 1));
+    }
+    revFreeHashTable(hash);
+    freePositions(boards, count);
+    free(boards);
+    free(results);
+    return 0;
+}
+
+// Plays random games in an arena, and returns nanoseconds per revArenaMove().
+static double playArenaGames(int count) {
+    RevGameArena *arena = revNewGameArena();
+    RevGameHandle *handles = (RevGameHandle *)malloc(sizeof(RevGameHandle) * count);
+    if (arena == NULL || handles == NULL) return 0.0;
+    for (int i = 0; i < count; i++)
+        handles[i] = revArenaNewGame(arena);
+    revInitGenRandom(24680);
+    uint64_t moves = 0;
+    const uint64_t start = getWallUs();
+    for (int active = count; active > 0;) {
+        active = 0;
+        for (int i = 0; i < count; i++) {
+            RevBoard *board = revArenaGetBoard(arena, handles[i]);
+            if (!revHasLegalMoves(board)) continue;
+            revArenaMove(arena, handles[i], revGenMoveRandom(board));
+            moves++;
+            active++;
+        }
+    }
+    const uint64_t elapsed_us = getWallUs() - start;
+    free(handles);
+    revFreeGameArena(arena);
+    return (moves > 0) ? elapsed_us * 1000.0 / (double)moves : 0.0;
+}
+
+// Records latencies of searches in three game stages and of arena moves,
+// and prints the histograms. It also measures the cost of recording on arena moves.
+static int benchLatency(int argc, char *argv[]) {
+    const int count = (argc > 0) ? atoi(argv[0]) : 150;
+    const int depth = (argc > 1) ? atoi(argv[1]) : 8;
+    const int json = argc > 2 && strcmp(argv[2], "json") == 0;
+    if (count < 3) return 1;
+    const int per_stage = count / 3;
+    RevBoard **boards = (RevBoard **)malloc(sizeof(RevBoard *) * per_stage * 3);
+    RevHashTable *hash = revNewHashTable(64);
+    if (boards == NULL || hash == NULL) {
+        printf("Failed to allocate memory.\n");
+        return 1;
+    }
+    const int stage_empties[3] = { 50, 36, 20 };
+    for (int i = 0; i < 3; i++)
+        makePositions(boards + i * per_stage, per_stage, stage_empties[i], 11223 + i);
+
+    const double off_ns = playArenaGames(20000);
+    revSetLatencyRecording(1);
+    revResetLatencyStats();
+    const double on_ns = playArenaGames(20000);
+
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = depth;
+    params.hash = hash;
+    for (int i = 0; i < per_stage * 3; i++)
+        revSearch(boards[i], &params, NULL);
+    params.threads = 4;
+    revAnalyzeBatch(boards, per_stage * 3, &params, NULL, NULL, NULL);
+    revSetLatencyRecording(0);
+
+    printf("Latency: %d positions at 50, 36, and 20 empties, depth %d\n", per_stage * 3, depth);
+    printf("Arena moves: %.1f ns without recording, %.1f ns with recording\n\n", off_ns, on_ns);
+    const int format = json ? REV_LATENCY_JSON : REV_LATENCY_TEXT;
+    const int length = revFormatLatencyStats(NULL, 0, format);
+    char *text = (char *)malloc(length + 1);
+    if (text != NULL) {
+        revFormatLatencyStats(text, length + 1, format);
+        printf("%s\n", text);
+        free(text);
+    }
+    revFreeHashTable(hash);
+    freePositions(boards, per_stage * 3);
+    free(boards);
+    return 0;
+}
+
+// Plays self-play games with a fixed time per move,
+// and compares root visits per decision with and without tree reuse.
+static int benchMcts(int argc, char *argv[]) {
+    const int time_ms = (argc > 0) ? atoi(argv[0]) : 50;
+    const int games = (argc > 1) ? atoi(argv[1]) : 4;
+    RevMcts *mcts = revNewMcts(64);
+    RevBoard *board = revNewBoard();
+    if (mcts == NULL || board == NULL) {
+        printf("Failed to allocate memory.\n");
+        return 1;
+    }
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.time_ms = time_ms;
+    printf("MCTS: %d games, %d ms per move\n", games, time_ms);
+    printf("   mode  decisions  playouts/decision  visits/decision\n");
+
+    for (int reuse = 0; reuse <= 1; reuse++) {
+        revInitGenRandom(24680);
+        uint64_t playouts = 0;
+        uint64_t visits = 0;
+        int decisions = 0;
+        for (int i = 0; i < games; i++) {
+            revInitBoard(board);
+            revClearMcts(mcts);
+            while (revHasLegalMoves(board)) {
+                RevSearchResult result;
+                if (!reuse)
+                    revClearMcts(mcts);
+                const int move = revSearchMcts(mcts, board, &params, &result);
+                playouts += result.playouts;
+                visits += (uint64_t)revMctsGetRootVisits(mcts);
+                decisions++;
+                revMove(board, move);
+                revMctsAdvance(mcts, move);
+                if (!revHasLegalMoves(board)) {
+                    revChangePlayer(board);
+                    revMctsAdvance(mcts, -1);
+                }
+            }
+        }
+        if (decisions == 0) decisions = 1;
+        printf("  %5s  %9d  %17.0f  %15.0f\n", reuse ? "reuse" : "fresh", decisions,
+               (double)playouts / decisions, (double)visits / decisions);
+    }
+    revFreeBoard(board);
+    revFreeMcts(mcts);
+    return 0;
+}
+
+// Plays games between MCTS with RAVE and plain UCT at the same number of playouts per move.
+// Each equivalence plays both colors from the same openings.
+static int benchRave(int argc, char *argv[]) {
+    const int trials = (argc > 0 && atoi(argv[0]) > 0) ? atoi(argv[0]) : 300;
+    const int games = (argc > 1 && atoi(argv[1]) > 0) ? atoi(argv[1]) : 100;
+    static const float default_equivalences[] = { 100, 300, 1000, 3000 };
+    const float *equivalences = default_equivalences;
+    int equivalence_count = 4;
+    float equivalence_arg;
+    if (argc > 2 && atof(argv[2]) > 0) {
+        equivalence_arg = (float)atof(argv[2]);
+        equivalences = &equivalence_arg;
+        equivalence_count = 1;
+    }
+    RevMcts *players[2] = { revNewMcts(64), revNewMcts(64) };
+    RevBoard *board = revNewBoard();
+    if (players[0] == NULL || players[1] == NULL || board == NULL) {
+        printf("Failed to allocate memory.\n");
+        return 1;
+    }
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.trials = trials;
+
+    printf("RAVE vs UCT: %d games, %d playouts per move\n", games * 2, trials);
+    printf("  equivalence  wins  draws  losses  win rate\n");
+    for (int e = 0; e < equivalence_count; e++) {
+        revSetMctsRave(players[0], equivalences[e]);
+        revInitGenRandom(11235);
+        int results[3] = { 0, 0, 0 };  // Wins, draws, and losses of RAVE
+        for (int i = 0; i < games * 2; i++) {
+            // RAVE plays black in even games.
+            const RevDiskType rave_color = (i % 2 == 0) ? DISK_BLACK : DISK_WHITE;
+            revInitBoard(board);
+            for (int ply = 0; ply < 4; ply++)
+                revMove(board, revGenMoveRandom(board));
+            revClearMcts(players[0]);
+            revClearMcts(players[1]);
+            while (revHasLegalMoves(board)) {
+                const int rave_turn = revGetCurrentPlayer(board) == rave_color;
+                RevSearchResult result;
+                const int move = revSearchMcts(players[!rave_turn], board, &params, &result);
+                revMove(board, move);
+                if (!revHasLegalMoves(board))
+                    revChangePlayer(board);
+            }
+            const int diff = revCountDisks(board, rave_color) -
+                             revCountDisks(board, (RevDiskType)!rave_color);
+            results[(diff > 0) ? 0 : (diff == 0) ? 1 : 2]++;
+        }
+        printf("  %11.0f  %4d  %5d  %6d  %7.1f%%\n", equivalences[e],
+               results[0], results[1], results[2],
+               (results[0] + results[1] * 0.5) * 100.0 / (games * 2));
+    }
+    revFreeBoard(board);
+    revFreeMcts(players[0]);
+    revFreeMcts(players[1]);
+    return 0;
+}
+
+// A game of a server that doesn't use RevGameArena.
+typedef struct Session {
+    RevBoard *board;
+    int history_length;
+    int8_t history[128];
+} Session;
+
+// Plays many games at once, one move per game in each sweep.
+// Compares sessions with boards from revNewBoard() and games in RevGameArena.
+// Both of them record the history of moves.
+static int benchArena(int argc, char *argv[]) {
+    const int count = (argc > 0) ? atoi(argv[0]) : 200000;
+    if (count <= 0) return 1;
+    Session **sessions = (Session **)malloc(sizeof(Session *) * count);
+    RevBoard **boards = (RevBoard **)malloc(sizeof(RevBoard *) * count);
+    RevGameHandle *handles = (RevGameHandle *)malloc(sizeof(RevGameHandle) * count);
+    RevGameArena *arena = revNewGameArena();
+    if (sessions == NULL || boards == NULL || handles == NULL || arena == NULL) {
+        printf("Failed to allocate memory.\n");
+        return 1;
+    }
+    printf("Arena: %d games\n", count);
+    printf("     mode  alloc(ms)  play(ms)\n");
+
+    revInitGenRandom(97531);
+    uint64_t start = getWallMs();
+    for (int i = 0; i < count; i++) {
+        sessions[i] = (Session *)malloc(sizeof(Session));
+        sessions[i]->board = revNewBoard();
+        sessions[i]->history_length = 0;
+    }
+    const int malloc_alloc_ms = (int)(getWallMs() - start);
+    start = getWallMs();
+    for (int active = count; active > 0;) {
+        active = 0;
+        for (int i = 0; i < count; i++) {
+            Session *session = sessions[i];
+            RevBoard *board = session->board;
+            if (!revHasLegalMoves(board)) continue;
+            const int move = revGenMoveRandom(board);
+            revMove(board, move);
+            session->history[session->history_length++] = (int8_t)move;
+            if (!revHasLegalMoves(board)) {
+                revChangePlayer(board);
+                if (revHasLegalMoves(board))
+                    session->history[session->history_length++] = -1;
+            }
+            active++;
+        }
+    }
+    const int malloc_play_ms = (int)(getWallMs() - start);
+    for (int i = 0; i < count; i++) {
+        revFreeBoard(sessions[i]->board);
+        free(sessions[i]);
+    }
+    printf("   malloc  %9d  %8d\n", malloc_alloc_ms, malloc_play_ms);
+
+    revInitGenRandom(97531);
+    start = getWallMs();
+    for (int i = 0; i < count; i++) {
+        handles[i] = revArenaNewGame(arena);
+        revArenaSetAIPlayers(arena, handles[i], REV_ARENA_AI_BLACK | REV_ARENA_AI_WHITE);
+    }
+    const int arena_alloc_ms = (int)(getWallMs() - start);
+    start = getWallMs();
+    for (;;) {
+        int cursor = 0;
+        int total = 0;
+        int n;
+        // Small chunks keep the boards in the cache until they are played.
+        while ((n = revArenaNextWaitingGames(arena, &cursor, handles, boards, 256)) > 0) {
+            for (int i = 0; i < n; i++)
+                revArenaMove(arena, handles[i], revGenMoveRandom(boards[i]));
+            total += n;
+        }
+        if (total == 0) break;
+    }
+    const int arena_play_ms = (int)(getWallMs() - start);
+    printf("    arena  %9d  %8d\n", arena_alloc_ms, arena_play_ms);
+
+    revFreeGameArena(arena);
+    free(handles);
+    free(boards);
+    free(sessions);
+    return 0;
+}
+
+// Converts boards to planes of floats square by square with revGetDisk(),
+// and with revExtractFeatures() in each format. It checks that the floats are the same.
+static int benchFeatures(int argc, char *argv[]) {
+    const int count = (argc > 0) ? atoi(argv[0]) : 10000;
+    const int repeat = (argc > 1) ? atoi(argv[1]) : 100;
+    if (count <= 0 || repeat <= 0) return 1;
+    const size_t tensor_size = REV_FEATURE_PLANES * 64;
+    RevBoard **boards = (RevBoard **)malloc(sizeof(RevBoard *) * count);
+    float *expected = (float *)malloc(sizeof(float) * tensor_size * count);
+    void *out = malloc(sizeof(float) * tensor_size * count * 8);
+    if (boards == NULL || expected == NULL || out == NULL) {
+        printf("Failed to allocate memory.\n");
+        return 1;
+    }
+    makePositions(boards, count, 30, 8642);
+    printf("Features: %d boards, %d times\n", count, repeat);
+    printf("        mode  time(ms)  Mtensors/s\n");
+
+    uint64_t start = getWallUs();
+    for (int r = 0; r < repeat; r++) {
+        for (int i = 0; i < count; i++) {
+            RevBoard *board = boards[i];
+            const RevDiskType player = revGetCurrentPlayer(board);
+            const RevBitboard mobility = revGetMobility(board);
+            float *planes = expected + tensor_size * i;
+            for (int pos = 0; pos < 64; pos++) {
+                const RevDiskType disk = revGetDisk(board, pos);
+                planes[pos] = (disk == player);
+                planes[64 + pos] = (disk != player && disk != DISK_NONE);
+                planes[128 + pos] = (disk == DISK_NONE);
+                planes[192 + pos] = (float)revIsTrueAt(mobility, pos);
+            }
+        }
+    }
+    uint64_t us = getWallUs() - start;
+    printf("  revGetDisk  %8d  %10.2f\n", (int)(us / 1000),
+           (double)count * repeat / (double)(us > 0 ? us : 1));
+
+    static const struct {
+        const char *name;
+        int flags;
+    } modes[] = {
+        { "float", 0 },
+        { "uint8", REV_FEATURES_UINT8 },
+        { "float x8", REV_FEATURES_SYMMETRIES },
+        { "uint8 x8", REV_FEATURES_UINT8 | REV_FEATURES_SYMMETRIES },
+    };
+    int ok = 1;
+    for (int m = 0; m < 4; m++) {
+        int tensors = 0;
+        start = getWallUs();
+        for (int r = 0; r < repeat; r++)
+            tensors = revExtractFeatures(boards, count, out, modes[m].flags);
+        us = getWallUs() - start;
+        printf("  %10s  %8d  %10.2f\n", modes[m].name, (int)(us / 1000),
+               (double)tensors * repeat / (double)(us > 0 ? us : 1));
+        if (modes[m].flags == 0)
+            ok = memcmp(out, expected, sizeof(float) * tensor_size * count) == 0;
+    }
+    if (!ok) printf("revExtractFeatures() doesn't match revGetDisk().\n");
+
+    freePositions(boards, count);
+    free(boards);
+    free(expected);
+    free(out);
+    return ok ? 0 : 1;
+}
+
+// Runs playouts, Monte Carlo decisions, and searches in one thread.
+// It's the training run of PGO builds, and tools/pgo.py compares its total time.
+static int benchPgo(int argc, char *argv[]) {
+    const int repeat = (argc > 0 && atoi(argv[0]) > 0) ? atoi(argv[0]) : 1;
+    RevBoard *midgames[POSITION_COUNT];
+    RevBoard *endgames[POSITION_COUNT];
+    makePositions(midgames, POSITION_COUNT, 40, 11111);
+    makePositions(endgames, POSITION_COUNT, 14, 22222);
+    RevHashTable *hash = revNewHashTable(16);
+    RevMcts *mcts = revNewMcts(16);
+    if (hash == NULL || mcts == NULL) {
+        printf("Failed to allocate memory.\n");
+        return 1;
+    }
+    revInitGenRandom(33333);
+
+    printf("PGO training: %d positions per phase, %d times\n", POSITION_COUNT, repeat);
+    printf("       phase  time(ms)\n");
+    RevSearchParams params;
+    RevSearchResult result;
+    int total_ms = 0;
+    static const char *names[] = { "playout", "montecarlo", "mcts", "midgame", "endgame" };
+    for (int phase = 0; phase < 5; phase++) {
+        const uint64_t start = getWallMs();
+        for (int i = 0; i < POSITION_COUNT * repeat; i++) {
+            revInitSearchParams(&params);
+            params.threads = 1;
+            params.hash = hash;
+            revClearHashTable(hash);
+            switch (phase) {
+            case 0:
+                params.type = SEARCH_MONTE_CARLO;
+                params.trials = 50000;
+                revSearch(midgames[i % POSITION_COUNT], &params, &result);
+                break;
+            case 1:
+                revGenMoveMonteCarlo(midgames[i % POSITION_COUNT], 10000);
+                break;
+            case 2:
+                params.trials = 25000;
+                revClearMcts(mcts);
+                revSearchMcts(mcts, midgames[i % POSITION_COUNT], &params, &result);
+                break;
+            case 3:
+                params.depth = 10;
+                revSearch(midgames[i % POSITION_COUNT], &params, &result);
+                break;
+            default:
+                params.depth = 0;
+                revSearch(endgames[i % POSITION_COUNT], &params, &result);
+                break;
+            }
+        }
+        const int elapsed_ms = (int)(getWallMs() - start);
+        printf("  %10s  %8d\n", names[phase], elapsed_ms);
+        total_ms += elapsed_ms;
+    }
+    printf("  %10s  %8d\n", "total", total_ms);
+    revFreeMcts(mcts);
+    revFreeHashTable(hash);
+    freePositions(midgames, POSITION_COUNT);
+    freePositions(endgames, POSITION_COUNT);
+    return 0;
+}
+
+typedef struct Workload {
+    const char *name;
+    const char *usage;
+    int (*run)(int argc, char *argv[]);
+} Workload;
+
+static const Workload workloads[] = {
+    { "smp", "smp [max_threads] [depth]", benchSmp },
+    { "hash", "hash [size_mb] [depth]", benchHash },
+    { "montecarlo", "montecarlo [max_threads] [trials]", benchMonteCarlo },
+    { "endgame", "endgame [empties]", benchEndgame },
+    { "wld", "wld [empties]", benchWld },
+    { "probcut", "probcut [depth] [params_file]", benchProbCut },
+    { "batch", "batch [positions] [max_threads] [depth]", benchBatch },
+    { "mcts", "mcts [time_ms] [games]", benchMcts },
+    { "mctsbatch", "mctsbatch [time_ms] [call_us]", benchMctsBatch },
+    { "rave", "rave [trials] [games] [equivalence]", benchRave },
+    { "arena", "arena [games]", benchArena },
+    { "features", "features [boards] [repeat]", benchFeatures },
+    { "latency", "latency [positions] [depth] [json]", benchLatency },
+    { "pgo", "pgo [repeat]", benchPgo },
+};
+
+int main(int argc, char *argv[]) {
+    const int workload_count = sizeof(workloads) / sizeof(Workload);
+    if (argc >= 2) {
+        for (int i = 0; i < workload_count; i++) {
+            if (strcmp(argv[1], workloads[i].name) == 0)
+                return workloads[i].run(argc - 2, argv + 2);
+        }
+    }
+    printf("Usage: bench <workload> [args...]\n");
+    for (int i = 0; i < workload_count; i++)
+        printf("  %s\n", workloads[i].usage);
+    return 1;
+}
@@ -0,0 +1,424 @@
+// Engine server that speaks a GTP-like protocol over stdin and stdout.
+// Usage: engine [hash_mb] [hash_file]
+//
+// Each request is a line of `[id] command [args...]`.
+// Each response is `=[id] result` on success or `?[id] message` on failure,
+// followed by an empty line. Requests are processed in order, so a client can
+// send a batch of requests without waiting, and match responses by their ids.
+//
+// The board, the transposition table, and the engine thread are kept between
+// requests, so later searches start with a warm table. With hash_file, the table is
+// kept in the file, and shared with other servers that use the same file.
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "reversi.h"
+
+#define DEFAULT_HASH_MB 64
+#define MAX_LINE 1024
+#define MAX_RESPONSE 8192
+#define MAX_ARGS 8
+
+typedef struct Server {
+    RevBoard *board;
+    RevEngine *engine;
+    RevHashTable *hash;
+    int hash_mb;  // Size for a new table
+    RevSearchParams params;
+    RevSearchInfo info;  // The last progress of search(). line_count is 0 if unknown.
+    int ponder;  // TRUE to ponder after genmove.
+    int quit;
+} Server;
+
+typedef struct Request {
+    const char *id;  // Empty when the request has no id.
+    int argc;
+    char *argv[MAX_ARGS];
+} Request;
+
+// Multi-line results should start with a line break.
+static void respond(const Request *req, int ok, const char *fmt, ...) {
+    char text[MAX_RESPONSE];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+    const char *sep = (text[0] == '\0' || text[0] == '\n') ? "" : " ";
+    printf("%c%s%s%s\n\n", ok ? '=' : '?', req->id, sep, text);
+    fflush(stdout);
+}
+
+static const char *colorToString(RevDiskType color) {
+    return (color == DISK_BLACK) ? "b" : "w";
+}
+
+// Returns DISK_NONE for unknown colors.
+static RevDiskType parseColor(const char *str) {
+    if (strcmp(str, "b") == 0 || strcmp(str, "black") == 0) return DISK_BLACK;
+    if (strcmp(str, "w") == 0 || strcmp(str, "white") == 0) return DISK_WHITE;
+    return DISK_NONE;
+}
+
+// Converts "a1" to 0 and "h8" to 63. Returns -1 for "pass" and -2 for invalid moves.
+static int parseMove(const char *str) {
+    if (strcmp(str, "pass") == 0) return -1;
+    const int x = tolower((unsigned char)str[0]) - 'a';
+    const int y = str[0] ? str[1] - '1' : -1;
+    if (x < 0 || x >= 8 || y < 0 || y >= 8 || str[2] != '\0') return -2;
+    return revXYToPos(x, y);
+}
+
+static void moveToString(int move, char *str) {
+    if (move < 0) {
+        strcpy(str, "pass");
+        return;
+    }
+    str[0] = (char)('a' + move % 8);
+    str[1] = (char)('1' + move / 8);
+    str[2] = '\0';
+}
+
+// The search thread can't use the table while it's being replaced or cleared.
+// Recreating the engine joins the thread and stops pondering.
+static int restartEngine(Server *server) {
+    revFreeEngine(server->engine);
+    server->engine = revNewEngine();
+    return server->engine != NULL;
+}
+
+static void storeInfo(const RevSearchInfo *info, void *user_data) {
+    *(RevSearchInfo *)user_data = *info;
+}
+
+// Runs a search on the engine thread and waits for it.
+// Pondering doesn't use the callback, so it never overwrites server->info.
+static void search(Server *server, RevSearchResult *result) {
+    RevSearchParams params = server->params;
+    params.info_callback = storeInfo;
+    params.info_data = &server->info;
+    server->info.line_count = 0;
+    revSearchStart(server->engine, server->board, &params, NULL, NULL);
+    revSearchWait(server->engine, result);
+}
+
+// Appends " pv <moves...>" to text.
+static void appendPv(char *text, const RevPvLine *line) {
+    char move_str[8];
+    strcat(text, " pv");
+    for (int i = 0; i < line->length; i++) {
+        moveToString(line->pv[i], move_str);
+        strcat(text, " ");
+        strcat(text, move_str);
+    }
+}
+
+static void cmdSetBoard(Server *server, const Request *req) {
+    if (req->argc < 3 || strlen(req->argv[1]) != 64) {
+        respond(req, 0, "usage: setboard <64 chars of X, O, or .> <b|w>");
+        return;
+    }
+    const RevDiskType color = parseColor(req->argv[2]);
+    if (color == DISK_NONE) {
+        respond(req, 0, "invalid color");
+        return;
+    }
+    RevBitboard black = 0, white = 0;
+    for (int pos = 0; pos < 64; pos++) {
+        const char c = req->argv[1][pos];
+        if (c == 'X' || c == 'x' || c == '*') {
+            black |= (RevBitboard)1 << pos;
+        } else if (c == 'O' || c == 'o') {
+            white |= (RevBitboard)1 << pos;
+        } else if (c != '.' && c != '-') {
+            respond(req, 0, "invalid board");
+            return;
+        }
+    }
+    revSetBitboard(server->board, DISK_BLACK, black);
+    revSetBitboard(server->board, DISK_WHITE, white);
+    if (revGetCurrentPlayer(server->board) != color)
+        revChangePlayer(server->board);
+    else
+        revUpdateMobility(server->board);
+    respond(req, 1, "");
+}
+
+static void cmdPlay(Server *server, const Request *req) {
+    if (req->argc < 3) {
+        respond(req, 0, "usage: play <b|w> <move|pass>");
+        return;
+    }
+    RevBoard *board = server->board;
+    const RevDiskType color = parseColor(req->argv[1]);
+    const int move = parseMove(req->argv[2]);
+    if (color != revGetCurrentPlayer(board)) {
+        respond(req, 0, "not %s's turn", req->argv[1]);
+    } else if (move == -1) {
+        if (revHasLegalMoves(board)) {
+            respond(req, 0, "pass is not allowed");
+        } else {
+            revChangePlayer(board);
+            respond(req, 1, "");
+        }
+    } else if (move < 0 || !revIsLegalMove(board, move)) {
+        respond(req, 0, "illegal move");
+    } else {
+        revMove(board, move);
+        respond(req, 1, "");
+    }
+}
+
+// genmove plays the best move. search only reports it.
+static void cmdGenMove(Server *server, const Request *req, int play) {
+    RevBoard *board = server->board;
+    if (play) {
+        if (req->argc < 2 || parseColor(req->argv[1]) == DISK_NONE) {
+            respond(req, 0, "usage: genmove <b|w>");
+            return;
+        }
+        if (parseColor(req->argv[1]) != revGetCurrentPlayer(board)) {
+            respond(req, 0, "not %s's turn", req->argv[1]);
+            return;
+        }
+    }
+
+    RevSearchResult result;
+    result.move = -1;
+    if (revHasLegalMoves(board))
+        search(server, &result);
+    char move_str[8];
+    moveToString(result.move, move_str);
+    if (!play) {
+        // Other lines of multi-PV follow the best one.
+        char text[MAX_RESPONSE];
+        snprintf(text, sizeof(text), "%s score %d depth %d nodes %llu time %d", move_str,
+                 result.score, result.depth, (unsigned long long)result.nodes,
+                 result.elapsed_ms);
+        const RevSearchInfo *info = &server->info;
+        if (info->line_count > 0 && info->lines[0].pv[0] == result.move)
+            appendPv(text, &info->lines[0]);
+        for (int i = 1; i < info->line_count; i++) {
+            moveToString(info->lines[i].pv[0], move_str);
+            sprintf(text + strlen(text), "\n%s score %d", move_str, info->lines[i].score);
+            appendPv(text, &info->lines[i]);
+        }
+        respond(req, 1, "%s", text);
+        return;
+    }
+
+    if (result.move >= 0)
+        revMove(board, result.move);
+    else
+        revChangePlayer(board);
+    respond(req, 1, "%s", move_str);
+    if (server->ponder && revHasLegalMoves(board))
+        revPonderStart(server->engine, board, -1, &server->params);
+}
+
+static void cmdSet(Server *server, const Request *req) {
+    if (req->argc < 3) {
+        respond(req, 0, "usage: set <name> <value>");
+        return;
+    }
+    const char *name = req->argv[1];
+    const char *value = req->argv[2];
+    RevSearchParams *params = &server->params;
+    const int n = atoi(value);
+    if (strcmp(name, "type") == 0) {
+        if (strcmp(value, "alphabeta") == 0) {
+            params->type = SEARCH_ALPHA_BETA;
+        } else if (strcmp(value, "montecarlo") == 0) {
+            params->type = SEARCH_MONTE_CARLO;
+        } else if (strcmp(value, "wld") == 0) {
+            params->type = SEARCH_WLD;
+        } else {
+            respond(req, 0, "type should be alphabeta, montecarlo, or wld");
+            return;
+        }
+    } else if (strcmp(name, "depth") == 0 && n >= 0) {
+        params->depth = n;
+    } else if (strcmp(name, "time") == 0 && n >= 0) {
+        params->time_ms = n;
+    } else if (strcmp(name, "trials") == 0 && n >= 0) {
+        params->trials = n;
+    } else if (strcmp(name, "threads") == 0 && n >= 0) {
+        params->threads = n;
+    } else if (strcmp(name, "selectivity") == 0 && n >= 0 && n <= 5) {
+        params->selectivity = n;
+    } else if (strcmp(name, "multipv") == 0 && n >= 1 && n <= REV_MAX_MULTI_PV) {
+        params->multi_pv = n;
+    } else if (strcmp(name, "ponder") == 0) {
+        server->ponder = (strcmp(value, "on") == 0 || n > 0);
+        if (!server->ponder && !restartEngine(server)) {
+            server->quit = 1;
+            respond(req, 0, "failed to restart the engine");
+            return;
+        }
+    } else if ((strcmp(name, "hash") == 0 && n > 0) || strcmp(name, "hashfile") == 0) {
+        if (!restartEngine(server)) {
+            server->quit = 1;
+            respond(req, 0, "failed to restart the engine");
+            return;
+        }
+        const int is_file = strcmp(name, "hashfile") == 0;
+        RevHashTable *hash = is_file ? revOpenHashTable(value, server->hash_mb, 0) :
+                                       revNewHashTable(n);
+        if (hash == NULL) {
+            if (is_file)
+                respond(req, 0, "failed to open %s", value);
+            else
+                respond(req, 0, "failed to allocate %d MB", n);
+            return;
+        }
+        revFreeHashTable(server->hash);
+        server->hash = hash;
+        if (!is_file) server->hash_mb = n;
+        params->hash = hash;
+    } else {
+        respond(req, 0, "invalid option");
+        return;
+    }
+    respond(req, 1, "");
+}
+
+static void cmdShowBoard(Server *server, const Request *req) {
+    char text[8 * 17 + 64];
+    char *p = text;
+    p += sprintf(p, "\n");
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++) {
+            const RevDiskType disk = revGetDiskXY(server->board, x, y);
+            *p++ = (disk == DISK_BLACK) ? 'X' : (disk == DISK_WHITE) ? 'O' : '.';
+        }
+        *p++ = '\n';
+    }
+    sprintf(p, "%s to move", colorToString(revGetCurrentPlayer(server->board)));
+    respond(req, 1, "%s", text);
+}
+
+static void cmdClearHash(Server *server, const Request *req) {
+    if (!restartEngine(server)) {
+        server->quit = 1;
+        respond(req, 0, "failed to restart the engine");
+        return;
+    }
+    revClearHashTable(server->hash);
+    respond(req, 1, "");
+}
+
+// Latency histograms of searches since the start or the last reset.
+static void cmdLatency(const Request *req) {
+    if (req->argc > 1 && strcmp(req->argv[1], "reset") == 0) {
+        revResetLatencyStats();
+        respond(req, 1, "");
+        return;
+    }
+    const int json = req->argc > 1 && strcmp(req->argv[1], "json") == 0;
+    char text[MAX_RESPONSE - 64];
+    text[0] = '\n';
+    revFormatLatencyStats(text + 1, sizeof(text) - 1, json ? REV_LATENCY_JSON : REV_LATENCY_TEXT);
+    // An empty line would end the response.
+    const size_t length = strlen(text);
+    if (text[length - 1] == '\n') text[length - 1] = '\0';
+    respond(req, 1, "%s", json ? text + 1 : text);
+}
+
+static const char *commands[] = {
+    "protocol_version", "name", "version", "list_commands", "quit", "clear_board",
+    "setboard", "play", "genmove", "search", "set", "showboard", "clear_hash", "latency",
+};
+
+static void handleRequest(Server *server, const Request *req) {
+    const char *cmd = req->argv[0];
+    if (strcmp(cmd, "protocol_version") == 0) {
+        respond(req, 1, "2");
+    } else if (strcmp(cmd, "name") == 0) {
+        respond(req, 1, "reversi-core");
+    } else if (strcmp(cmd, "version") == 0) {
+        respond(req, 1, "%s", revGetVersion());
+    } else if (strcmp(cmd, "list_commands") == 0) {
+        char text[512] = "";
+        for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+            strcat(text, "\n");
+            strcat(text, commands[i]);
+        }
+        respond(req, 1, "%s", text);
+    } else if (strcmp(cmd, "quit") == 0) {
+        server->quit = 1;
+        respond(req, 1, "");
+    } else if (strcmp(cmd, "clear_board") == 0) {
+        revInitBoard(server->board);
+        respond(req, 1, "");
+    } else if (strcmp(cmd, "setboard") == 0) {
+        cmdSetBoard(server, req);
+    } else if (strcmp(cmd, "play") == 0) {
+        cmdPlay(server, req);
+    } else if (strcmp(cmd, "genmove") == 0) {
+        cmdGenMove(server, req, 1);
+    } else if (strcmp(cmd, "search") == 0) {
+        cmdGenMove(server, req, 0);
+    } else if (strcmp(cmd, "set") == 0) {
+        cmdSet(server, req);
+    } else if (strcmp(cmd, "showboard") == 0) {
+        cmdShowBoard(server, req);
+    } else if (strcmp(cmd, "clear_hash") == 0) {
+        cmdClearHash(server, req);
+    } else if (strcmp(cmd, "latency") == 0) {
+        cmdLatency(req);
+    } else {
+        respond(req, 0, "unknown command");
+    }
+}
+
+// Splits a line into an optional numeric id and arguments. Returns FALSE for empty lines.
+static int parseRequest(char *line, Request *req) {
+    req->id = "";
+    req->argc = 0;
+    for (char *token = strtok(line, " \t\r\n"); token != NULL && req->argc < MAX_ARGS;
+         token = strtok(NULL, " \t\r\n")) {
+        if (req->argc == 0 && req->id[0] == '\0' && isdigit((unsigned char)token[0])) {
+            req->id = token;
+            continue;
+        }
+        req->argv[req->argc++] = token;
+    }
+    return req->argc > 0;
+}
+
+int main(int argc, char *argv[]) {
+    const int hash_mb = (argc > 1) ? atoi(argv[1]) : DEFAULT_HASH_MB;
+    Server server;
+    server.board = revNewBoard();
+    server.engine = revNewEngine();
+    server.hash = (argc > 2) ? revOpenHashTable(argv[2], hash_mb, 0) : revNewHashTable(hash_mb);
+    server.hash_mb = hash_mb;
+    if (server.board == NULL || server.engine == NULL || server.hash == NULL) {
+        fprintf(stderr, "Failed to initialize the engine.\n");
+        return 1;
+    }
+    revInitGenRandom(1);
+    revSetLatencyRecording(1);
+    revInitSearchParams(&server.params);
+    server.params.depth = 0;
+    server.params.time_ms = 1000;
+    server.params.hash = server.hash;
+    server.info.line_count = 0;
+    server.ponder = 0;
+    server.quit = 0;
+
+    char line[MAX_LINE];
+    while (!server.quit && fgets(line, sizeof(line), stdin) != NULL) {
+        if (line[0] == '#') continue;
+        Request req;
+        if (parseRequest(line, &req))
+            handleRequest(&server, &req);
+    }
+
+    if (server.engine != NULL)
+        revFreeEngine(server.engine);
+    revFreeHashTable(server.hash);
+    revFreeBoard(server.board);
+    return 0;
+}
@@ -0,0 +1,345 @@
+// Differential tests for move generation kernels.
+// Usage: kernels [positions] [seed]
+//
+// Every back end is compared with a slow reference that walks each direction square by square.
+// Positions are random disk patterns and positions from random games.
+// For each position, it checks mobility of both players and flipped disks of every legal move.
+// It also plays random games with each back end and compares traces of the games.
+// Then it measures the throughput of each back end on the same positions.
+// The exit code is nonzero if any back end differs from the reference.
+#ifndef _WIN32
+// clock_gettime() is hidden in strict C99 mode.
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "reversi.h"
+#include "internal.h"
+#include "rng.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define TRACE_GAMES 10000
+
+typedef struct Backend {
+    const char *name;
+    RevBitboard (*mobility)(RevBitboard p_board, RevBitboard o_board);
+    RevBitboard (*flipped)(RevBitboard p_board, RevBitboard o_board, int pos);
+} Backend;
+
+typedef struct Position {
+    RevBitboard p_board;
+    RevBitboard o_board;
+} Position;
+
+static uint64_t getWallUs(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (uint64_t)(count.QuadPart * 1000000 / freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+#endif
+}
+
+static const int DIR_X[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+static const int DIR_Y[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+static inline int hasDisk(RevBitboard b, int x, int y) {
+    return (int)((b >> (x + y * 8)) & 1);
+}
+
+// Reference: walks each direction from pos until a square that isn't the opponent's.
+static RevBitboard refFlipped(RevBitboard p_board, RevBitboard o_board, int pos) {
+    if (((p_board | o_board) >> pos) & 1) return 0;
+    RevBitboard flipped = 0;
+    for (int d = 0; d < 8; d++) {
+        RevBitboard line = 0;
+        int x = pos % 8 + DIR_X[d];
+        int y = pos / 8 + DIR_Y[d];
+        while (x >= 0 && x < 8 && y >= 0 && y < 8 && hasDisk(o_board, x, y)) {
+            line |= (RevBitboard)1 << (x + y * 8);
+            x += DIR_X[d];
+            y += DIR_Y[d];
+        }
+        if (x >= 0 && x < 8 && y >= 0 && y < 8 && hasDisk(p_board, x, y))
+            flipped |= line;
+    }
+    return flipped;
+}
+
+static RevBitboard refMobility(RevBitboard p_board, RevBitboard o_board) {
+    RevBitboard mobility = 0;
+    for (int pos = 0; pos < 64; pos++) {
+        if (refFlipped(p_board, o_board, pos) != 0)
+            mobility |= (RevBitboard)1 << pos;
+    }
+    return mobility;
+}
+
+// The kernels in src/internal.h that searches use.
+static RevBitboard scalarMobility(RevBitboard p_board, RevBitboard o_board) {
+    return calcMobility(p_board, o_board);
+}
+
+static RevBitboard scalarFlipped(RevBitboard p_board, RevBitboard o_board, int pos) {
+    return calcFlipped(p_board, o_board, pos);
+}
+
+// revUpdateMobility() and revMove() through the public API.
+static RevBoard *api_board;
+
+static void setApiBoard(RevBitboard p_board, RevBitboard o_board) {
+    revInitBoard(api_board);
+    revSetBitboard(api_board, DISK_BLACK, p_board);
+    revSetBitboard(api_board, DISK_WHITE, o_board);
+}
+
+static RevBitboard apiMobility(RevBitboard p_board, RevBitboard o_board) {
+    setApiBoard(p_board, o_board);
+    revUpdateMobility(api_board);
+    return revGetMobility(api_board);
+}
+
+static RevBitboard apiFlipped(RevBitboard p_board, RevBitboard o_board, int pos) {
+    setApiBoard(p_board, o_board);
+    return revMove(api_board, pos);
+}
+
+// Add new back ends here. Guard them with the macros that they require.
+static const Backend backends[] = {
+    { "scalar", scalarMobility, scalarFlipped },
+    { "api", apiMobility, apiFlipped },
+};
+
+static const Backend reference = { "reference", refMobility, refFlipped };
+
+static void makeRandomPositions(Position *positions, int count, Rng *rng) {
+    for (int i = 0; i < count; i++) {
+        // Vary the density so that both sparse and crowded boards are covered.
+        const int density = rngBounded(rng, 8);
+        RevBitboard disks = rngNext(rng);
+        for (int j = 0; j < density % 4; j++) {
+            if (density < 4)
+                disks &= rngNext(rng);
+            else
+                disks |= rngNext(rng);
+        }
+        const RevBitboard colors = rngNext(rng);
+        positions[i].p_board = disks & colors;
+        positions[i].o_board = disks & ~colors;
+    }
+}
+
+// Records every position of random games from the initial board.
+static void makeGamePositions(Position *positions, int count, Rng *rng) {
+    RevBitboard p_board = 0x0000000810000000;
+    RevBitboard o_board = 0x0000001008000000;
+    int passed = 0;
+    for (int i = 0; i < count; i++) {
+        positions[i].p_board = p_board;
+        positions[i].o_board = o_board;
+        RevBitboard moves = refMobility(p_board, o_board);
+        if (moves == 0 && passed) {
+            // The game is over. Start a new one.
+            p_board = 0x0000000810000000;
+            o_board = 0x0000001008000000;
+            passed = 0;
+            continue;
+        }
+        passed = (moves == 0);
+        if (moves != 0) {
+            for (int n = rngBounded(rng, countOnes(moves)); n > 0; n--)
+                moves &= moves - 1;
+            const int pos = firstOnePos(moves);
+            const RevBitboard flipped = refFlipped(p_board, o_board, pos);
+            p_board ^= flipped | ((RevBitboard)1 << pos);
+            o_board ^= flipped;
+        }
+        const RevBitboard tmp = p_board;
+        p_board = o_board;
+        o_board = tmp;
+    }
+}
+
+static void printPosition(const Position *position) {
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++)
+            printf(" %c", hasDisk(position->p_board, x, y) ? 'X' :
+                          hasDisk(position->o_board, x, y) ? 'O' : '.');
+        printf("\n");
+    }
+}
+
+// Adds the number of mismatches of each back end to errors.
+// Only the first mismatch of each back end is printed.
+static void reportMismatch(const Backend *backend, uint64_t *errors, const Position *position,
+                           const char *what, RevBitboard actual, RevBitboard expected) {
+    if ((*errors)++ > 0) return;
+    printf("%s: %s 0x%016llx, expected 0x%016llx\n", backend->name, what,
+           (unsigned long long)actual, (unsigned long long)expected);
+    printPosition(position);
+}
+
+static void checkPositions(const Position *positions, int count, uint64_t *errors) {
+    const int backend_count = sizeof(backends) / sizeof(Backend);
+    for (int i = 0; i < count; i++) {
+        const Position *position = &positions[i];
+        for (int side = 0; side < 2; side++) {
+            const RevBitboard p_board = side ? position->o_board : position->p_board;
+            const RevBitboard o_board = side ? position->p_board : position->o_board;
+            const RevBitboard mobility = refMobility(p_board, o_board);
+            for (int b = 0; b < backend_count; b++) {
+                const RevBitboard actual = backends[b].mobility(p_board, o_board);
+                if (actual != mobility)
+                    reportMismatch(&backends[b], &errors[b], position,
+                                   side ? "mobility of O" : "mobility of X", actual, mobility);
+            }
+            // Flipping is only defined for legal moves.
+            for (RevBitboard m = mobility; m; m &= m - 1) {
+                const int pos = firstOnePos(m);
+                const RevBitboard flipped = refFlipped(p_board, o_board, pos);
+                for (int b = 0; b < backend_count; b++) {
+                    const RevBitboard actual = backends[b].flipped(p_board, o_board, pos);
+                    if (actual != flipped) {
+                        char what[32];
+                        snprintf(what, sizeof(what), "flipped at %d by %s", pos,
+                                 side ? "O" : "X");
+                        reportMismatch(&backends[b], &errors[b], position, what, actual,
+                                       flipped);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Plays a random game in the same way as playout() in src/search.c,
+// and returns a hash of every move and position.
+static uint64_t traceGame(const Backend *backend, uint64_t seed) {
+    Rng rng;
+    rngSeed(&rng, seed);
+    RevBitboard p_board = 0x0000000810000000;
+    RevBitboard o_board = 0x0000001008000000;
+    uint64_t trace = seed;
+    int passed = 0;
+    for (;;) {
+        RevBitboard moves = backend->mobility(p_board, o_board);
+        int pos = -1;
+        if (moves == 0) {
+            if (passed) break;
+            passed = 1;
+        } else {
+            passed = 0;
+            for (int n = rngBounded(&rng, countOnes(moves)); n > 0; n--)
+                moves &= moves - 1;
+            pos = firstOnePos(moves);
+            const RevBitboard flipped = backend->flipped(p_board, o_board, pos);
+            p_board ^= flipped | ((RevBitboard)1 << pos);
+            o_board ^= flipped;
+        }
+        uint64_t x = trace ^ (uint64_t)(pos + 1) ^ p_board;
+        trace = splitMix64(&x) ^ o_board;
+        const RevBitboard tmp = p_board;
+        p_board = o_board;
+        o_board = tmp;
+    }
+    return trace;
+}
+
+// Returns the number of games whose traces differ from the reference.
+static int checkTraces(const Backend *backend, const uint64_t *expected, uint64_t seed) {
+    int errors = 0;
+    for (int i = 0; i < TRACE_GAMES; i++) {
+        if (traceGame(backend, seed + (uint64_t)i) != expected[i]) {
+            if (errors++ == 0)
+                printf("%s: trace of game %d differs\n", backend->name, i);
+        }
+    }
+    return errors;
+}
+
+// Prints millions of mobility and flip calls per second.
+static void measureBackend(const Backend *backend, const Position *positions, int count) {
+    RevBitboard sink = 0;
+    uint64_t start = getWallUs();
+    for (int i = 0; i < count; i++)
+        sink ^= backend->mobility(positions[i].p_board, positions[i].o_board);
+    const uint64_t mobility_us = getWallUs() - start + 1;
+
+    uint64_t flips = 0;
+    start = getWallUs();
+    for (int i = 0; i < count; i++) {
+        const RevBitboard p_board = positions[i].p_board;
+        const RevBitboard o_board = positions[i].o_board;
+        for (RevBitboard m = scalarMobility(p_board, o_board); m; m &= m - 1) {
+            sink ^= backend->flipped(p_board, o_board, firstOnePos(m));
+            flips++;
+        }
+    }
+    const uint64_t flip_us = getWallUs() - start + 1;
+    printf("  %-10s  %11.1f  %11.1f  (%llx)\n", backend->name,
+           (double)count / mobility_us, (double)flips / flip_us, (unsigned long long)(sink & 0xf));
+}
+
+int main(int argc, char *argv[]) {
+    const int count = (argc > 1) ? atoi(argv[1]) : 1000000;
+    const uint64_t seed = (argc > 2) ? strtoull(argv[2], NULL, 10) : 20240601;
+    const int backend_count = sizeof(backends) / sizeof(Backend);
+    if (count <= 0) {
+        printf("Usage: kernels [positions] [seed]\n");
+        return 1;
+    }
+    Position *positions = (Position *)malloc(sizeof(Position) * count);
+    uint64_t *traces = (uint64_t *)malloc(sizeof(uint64_t) * TRACE_GAMES);
+    api_board = revNewBoard();
+    if (positions == NULL || traces == NULL || api_board == NULL) {
+        printf("Failed to allocate memory.\n");
+        return 1;
+    }
+
+    Rng rng;
+    rngSeed(&rng, seed);
+    uint64_t errors[sizeof(backends) / sizeof(Backend)] = { 0 };
+    const char *kinds[2] = { "random", "game" };
+    for (int kind = 0; kind < 2; kind++) {
+        if (kind == 0)
+            makeRandomPositions(positions, count, &rng);
+        else
+            makeGamePositions(positions, count, &rng);
+        printf("Checking %d %s positions\n", count, kinds[kind]);
+        checkPositions(positions, count, errors);
+    }
+
+    printf("Checking traces of %d games\n", TRACE_GAMES);
+    for (int i = 0; i < TRACE_GAMES; i++)
+        traces[i] = traceGame(&reference, seed + (uint64_t)i);
+    for (int b = 0; b < backend_count; b++)
+        errors[b] += (uint64_t)checkTraces(&backends[b], traces, seed);
+
+    // Positions from games are the last ones generated.
+    printf("Throughput on game positions (M calls/s)\n");
+    printf("  %-10s  %11s  %11s\n", "backend", "mobility", "flipped");
+    measureBackend(&reference, positions, count);
+    for (int b = 0; b < backend_count; b++)
+        measureBackend(&backends[b], positions, count);
+
+    int failed = 0;
+    for (int b = 0; b < backend_count; b++) {
+        printf("%s: %s (%llu errors)\n", backends[b].name, errors[b] ? "FAILED" : "OK",
+               (unsigned long long)errors[b]);
+        failed |= errors[b] != 0;
+    }
+    revFreeBoard(api_board);
+    free(traces);
+    free(positions);
+    return failed;
+}
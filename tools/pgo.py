@@ -0,0 +1,84 @@
+"""Builds reversi-core with and without profile-guided optimization and compares them.
+
+Usage: python3 tools/pgo.py [--lto] [--static] [--rounds N] [--builddir DIR]
+
+It makes two release builds in DIR (build-pgo by default).
+  plain: -Db_pgo=off
+  pgo:   -Db_pgo=generate, a training run of `bench pgo`, then -Db_pgo=use
+Both builds get the same --lto (-Db_lto=true) and --static (-Ddefault_library=static) options.
+Then it runs `bench pgo` on both builds in turn, and reports the best total time of each build.
+"""
+import argparse
+import os
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def run(args, **kwargs):
+    print("+ " + " ".join(args), flush=True)
+    subprocess.run(args, check=True, **kwargs)
+
+
+def setup(builddir, options):
+    if os.path.exists(os.path.join(builddir, "build.ninja")):
+        run(["meson", "configure", builddir] + options)
+    else:
+        run(["meson", "setup", builddir, ROOT] + options)
+    run(["meson", "compile", "-C", builddir])
+
+
+def bench_total_ms(builddir):
+    """Runs the training workload and returns its total time in milliseconds."""
+    bench = os.path.join(builddir, "tools", "bench")
+    out = subprocess.run([bench, "pgo"], check=True, stdout=subprocess.PIPE,
+                         universal_newlines=True).stdout
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) == 2 and fields[0] == "total":
+            return int(fields[1])
+    raise RuntimeError("Unexpected output of bench pgo:\n" + out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--lto", action="store_true", help="enable link-time optimization")
+    parser.add_argument("--static", action="store_true", help="build a static library")
+    parser.add_argument("--rounds", type=int, default=5, help="measurements per build")
+    parser.add_argument("--builddir", default="build-pgo", help="directory for the builds")
+    args = parser.parse_args()
+
+    options = ["--buildtype=release", "-Dexamples=false", "-Dtests=false", "-Dtools=true",
+               "-Db_lto=%s" % ("true" if args.lto else "false"),
+               "-Ddefault_library=%s" % ("static" if args.static else "shared")]
+    plain_dir = os.path.join(args.builddir, "plain")
+    pgo_dir = os.path.join(args.builddir, "pgo")
+
+    setup(plain_dir, options + ["-Db_pgo=off"])
+    setup(pgo_dir, options + ["-Db_pgo=generate"])
+    print("Training...", flush=True)
+    bench_total_ms(pgo_dir)
+    setup(pgo_dir, options + ["-Db_pgo=use"])
+
+    # Runs alternate between the builds so that both see the same machine load.
+    # The best time of each build is the least disturbed one.
+    best = {plain_dir: None, pgo_dir: None}
+    for i in range(args.rounds):
+        for builddir in best:
+            ms = bench_total_ms(builddir)
+            print("round %d: %s %d ms" % (i + 1, os.path.basename(builddir), ms), flush=True)
+            if best[builddir] is None or ms < best[builddir]:
+                best[builddir] = ms
+
+    plain_ms = best[plain_dir]
+    pgo_ms = best[pgo_dir]
+    print("plain: %d ms" % plain_ms)
+    print("pgo:   %d ms" % pgo_ms)
+    print("speedup: %.3fx (lto: %s, static: %s)" %
+          (plain_ms / max(pgo_ms, 1), args.lto, args.static))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
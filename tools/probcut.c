@@ -0,0 +1,195 @@
+// Calibration tool for Multi-ProbCut.
+// Usage:
+//   probcut log <log_file> [positions_per_stage] [max_depth] [seed]
+//   probcut fit <log_file> <params_file>
+//
+// "log" searches random positions at every depth from 1 to max_depth,
+// and writes a line of `empties score_at_depth1 score_at_depth2 ...` for each position.
+// "fit" reads the log, fits deep_score = a * shallow_score + b for each stage and depth,
+// and saves the parameters for revLoadProbCutParams().
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "reversi.h"
+
+#define MIN_SAMPLES 20
+
+static int countEmpties(RevBoard *board) {
+    return 64 - revCountDisks(board, DISK_BLACK) - revCountDisks(board, DISK_WHITE);
+}
+
+// Depth of the shallow search that predicts a deep search.
+static int getShallowDepth(int depth) {
+    return (depth / 4) * 2 + (depth & 1);
+}
+
+// Plays random and shallow-searched moves in turn, so positions stay close to real games.
+static int makePosition(RevBoard *board, int empties) {
+    revInitBoard(board);
+    while (countEmpties(board) > empties) {
+        if (!revHasLegalMoves(board)) return 0;
+        int move = revGenMoveRandom(board);
+        if (revGenIntRandom(0, 1))
+            move = revGenMoveAlphaBeta(board, 2);
+        revMove(board, move);
+        if (!revHasLegalMoves(board))
+            revChangePlayer(board);
+    }
+    return revHasLegalMoves(board);
+}
+
+static int logSearches(int argc, char *argv[]) {
+    if (argc < 1) return -1;
+    const char *path = argv[0];
+    const int positions = (argc > 1) ? atoi(argv[1]) : 100;
+    const int max_depth = (argc > 2) ? atoi(argv[2]) : 10;
+    const uint32_t seed = (argc > 3) ? (uint32_t)atoi(argv[3]) : 1;
+    if (max_depth < 1 || max_depth > REV_PROBCUT_MAX_DEPTH) {
+        printf("max_depth should be 1 to %d.\n", REV_PROBCUT_MAX_DEPTH);
+        return 1;
+    }
+
+    FILE *file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Failed to open %s.\n", path);
+        return 1;
+    }
+    RevHashTable *hash = revNewHashTable(64);
+    RevBoard *board = revNewBoard();
+    if (hash == NULL || board == NULL) {
+        printf("Failed to allocate memory.\n");
+        fclose(file);
+        return 1;
+    }
+
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.hash = hash;
+    revInitGenRandom(seed);
+    fprintf(file, "# empties score_at_depth1 ... score_at_depth%d\n", max_depth);
+    for (int stage = 0; stage < REV_PROBCUT_STAGES; stage++) {
+        for (int i = 0; i < positions; i++) {
+            const int empties = 60 - stage * 10 - revGenIntRandom(0, 9);
+            if (empties < 1 || !makePosition(board, empties)) {
+                i--;
+                continue;
+            }
+            revClearHashTable(hash);
+            fprintf(file, "%d", empties);
+            for (int depth = 1; depth <= max_depth; depth++) {
+                RevSearchResult result;
+                params.depth = depth;
+                revSearch(board, &params, &result);
+                fprintf(file, " %d", result.score);
+            }
+            fprintf(file, "\n");
+        }
+        printf("stage %d: %d positions\n", stage, positions);
+    }
+    revFreeBoard(board);
+    revFreeHashTable(hash);
+    fclose(file);
+    return 0;
+}
+
+typedef struct Regression {
+    double n, sx, sy, sxx, sxy, syy;
+} Regression;
+
+static int fitParams(int argc, char *argv[]) {
+    if (argc < 2) return -1;
+    FILE *file = fopen(argv[0], "r");
+    if (file == NULL) {
+        printf("Failed to open %s.\n", argv[0]);
+        return 1;
+    }
+
+    static Regression regs[REV_PROBCUT_STAGES][REV_PROBCUT_MAX_DEPTH + 1];
+    memset(regs, 0, sizeof(regs));
+    char line[1024];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (line[0] == '#') continue;
+        int scores[REV_PROBCUT_MAX_DEPTH + 1];
+        int count = 0;
+        int empties, len;
+        const char *p = line;
+        if (sscanf(p, "%d%n", &empties, &len) != 1) continue;
+        p += len;
+        while (count < REV_PROBCUT_MAX_DEPTH && sscanf(p, "%d%n", &scores[count + 1], &len) == 1) {
+            p += len;
+            count++;
+        }
+
+        int stage = (60 - empties) / 10;
+        if (stage < 0) stage = 0;
+        if (stage >= REV_PROBCUT_STAGES) stage = REV_PROBCUT_STAGES - 1;
+        // Searches to the end are exact and never pruned by ProbCut.
+        for (int depth = 3; depth <= count && depth < empties; depth++) {
+            Regression *reg = &regs[stage][depth];
+            const double x = scores[getShallowDepth(depth)];
+            const double y = scores[depth];
+            reg->n += 1;
+            reg->sx += x;
+            reg->sy += y;
+            reg->sxx += x * x;
+            reg->sxy += x * y;
+            reg->syy += y * y;
+        }
+    }
+    fclose(file);
+
+    RevProbCutParams *params = revNewProbCutParams();
+    if (params == NULL) {
+        printf("Failed to allocate memory.\n");
+        return 1;
+    }
+    printf("stage  depth  shallow  samples       a       b   sigma\n");
+    for (int stage = 0; stage < REV_PROBCUT_STAGES; stage++) {
+        for (int depth = 3; depth <= REV_PROBCUT_MAX_DEPTH; depth++) {
+            const Regression *reg = &regs[stage][depth];
+            const double var_x = reg->n * reg->sxx - reg->sx * reg->sx;
+            double a = 0, b = 0, sigma = 0;
+            if (reg->n >= MIN_SAMPLES && var_x > 0) {
+                a = (reg->n * reg->sxy - reg->sx * reg->sy) / var_x;
+                b = (reg->sy - a * reg->sx) / reg->n;
+                // Sum of squared residuals
+                const double sse = reg->syy - 2 * a * reg->sxy - 2 * b * reg->sy +
+                                   a * a * reg->sxx + 2 * a * b * reg->sx + b * b * reg->n;
+                sigma = sqrt((sse > 0 ? sse : 0) / (reg->n - 2));
+            }
+            // Depths without enough samples are not pruned.
+            if (a <= 0) {
+                a = 1;
+                b = 0;
+                sigma = 0;
+            } else {
+                printf("%5d  %5d  %7d  %7.0f  %6.3f  %6.2f  %6.2f\n",
+                       stage, depth, getShallowDepth(depth), reg->n, a, b, sigma);
+            }
+            revSetProbCutEntry(params, stage, depth, getShallowDepth(depth), a, b, sigma);
+        }
+    }
+    const int ok = revSaveProbCutParams(params, argv[1]);
+    revFreeProbCutParams(params);
+    if (!ok) {
+        printf("Failed to save %s.\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int ret = -1;
+    if (argc >= 2 && strcmp(argv[1], "log") == 0)
+        ret = logSearches(argc - 2, argv + 2);
+    else if (argc >= 2 && strcmp(argv[1], "fit") == 0)
+        ret = fitParams(argc - 2, argv + 2);
+    if (ret < 0) {
+        printf("Usage:\n");
+        printf("  probcut log <log_file> [positions_per_stage] [max_depth] [seed]\n");
+        printf("  probcut fit <log_file> <params_file>\n");
+        return 1;
+    }
+    return ret;
+}
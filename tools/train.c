@@ -0,0 +1,255 @@
+// Training tool for the pattern evaluation.
+// Usage:
+//   train gen <records_file> [games] [depth] [random_moves] [seed]
+//   train fit <records_file> <weights_file> [epochs] [threads] [learning_rate] [init_file]
+//   train eval <records_file> <weights_file>
+//
+// "gen" plays games with alpha-beta searches after random opening moves, and appends a record
+// of each position with the final disk difference for the player to move.
+// "fit" loads the records, trains weights with revTrainEvalWeights(), and saves them for
+// revLoadEvalWeights(). It starts from init_file if it's specified, or from zero.
+// "eval" prints the mean squared error of weights for each game stage.
+//
+// Records are RevEvalRecord in the native byte order, so files from other sources can be
+// concatenated with them. All records are loaded in memory, 24 bytes each.
+#ifndef _WIN32
+// clock_gettime() is hidden in strict C99 mode.
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "reversi.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static uint64_t getWallMs(void) {
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#endif
+}
+
+// Passes when the current player has no legal moves. Returns FALSE when the game is over.
+static int skipPass(RevBoard *board) {
+    if (revHasLegalMoves(board)) return 1;
+    revChangePlayer(board);
+    return revHasLegalMoves(board);
+}
+
+static int genRecords(int argc, char *argv[]) {
+    if (argc < 1) return -1;
+    const char *path = argv[0];
+    const int games = (argc > 1) ? atoi(argv[1]) : 1000;
+    const int depth = (argc > 2) ? atoi(argv[2]) : 4;
+    const int random_moves = (argc > 3) ? atoi(argv[3]) : 10;
+    const uint32_t seed = (argc > 4) ? (uint32_t)atoi(argv[4]) : 1;
+
+    FILE *file = fopen(path, "ab");
+    if (file == NULL) {
+        printf("Failed to open %s.\n", path);
+        return 1;
+    }
+    RevHashTable *hash = revNewHashTable(16);
+    RevBoard *board = revNewBoard();
+    if (hash == NULL || board == NULL) {
+        printf("Failed to allocate memory.\n");
+        fclose(file);
+        return 1;
+    }
+
+    RevSearchParams params;
+    revInitSearchParams(&params);
+    params.depth = depth;
+    params.hash = hash;
+    revInitGenRandom(seed);
+    const uint64_t start_ms = getWallMs();
+    uint64_t total = 0;
+    int ok = 1;
+    for (int game = 0; ok && game < games; game++) {
+        RevEvalRecord records[64];
+        RevDiskType players[64];
+        int count = 0;
+        revInitBoard(board);
+        for (int ply = 0; skipPass(board); ply++) {
+            const RevDiskType player = revGetCurrentPlayer(board);
+            int move;
+            if (ply < random_moves) {
+                move = revGenMoveRandom(board);
+            } else {
+                RevSearchResult result;
+                move = revSearch(board, &params, &result);
+                records[count].p_board = revGetBitboard(board, player);
+                records[count].o_board = revGetBitboard(board, (RevDiskType)!player);
+                players[count] = player;
+                count++;
+            }
+            revMove(board, move);
+        }
+        const int black = revCountDisks(board, DISK_BLACK);
+        const int white = revCountDisks(board, DISK_WHITE);
+        const int black_diff = black - white;
+        const int empties = 64 - black - white;
+        // Empty squares are counted for the winner, as in the scores of searches.
+        const int final_diff = black_diff + ((black_diff > 0) ? empties :
+                                             (black_diff < 0) ? -empties : 0);
+        for (int i = 0; i < count; i++)
+            records[i].score = (players[i] == DISK_BLACK) ? final_diff : -final_diff;
+        ok = fwrite(records, sizeof(RevEvalRecord), (size_t)count, file) == (size_t)count;
+        total += (uint64_t)count;
+    }
+    revFreeBoard(board);
+    revFreeHashTable(hash);
+    if (fclose(file) != 0 || !ok) {
+        printf("Failed to write %s.\n", path);
+        return 1;
+    }
+    printf("%d games, %llu records, %llu ms\n", games, (unsigned long long)total,
+           (unsigned long long)(getWallMs() - start_ms));
+    return 0;
+}
+
+// Returns NULL when it failed. count is set to the number of records.
+static RevEvalRecord *loadRecords(const char *path, size_t *count) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Failed to open %s.\n", path);
+        return NULL;
+    }
+    size_t capacity = 1 << 16;
+    RevEvalRecord *records = (RevEvalRecord *)malloc(sizeof(RevEvalRecord) * capacity);
+    *count = 0;
+    while (records != NULL) {
+        if (*count == capacity) {
+            capacity *= 2;
+            RevEvalRecord *grown =
+                (RevEvalRecord *)realloc(records, sizeof(RevEvalRecord) * capacity);
+            if (grown == NULL) {
+                free(records);
+                records = NULL;
+                break;
+            }
+            records = grown;
+        }
+        const size_t read = fread(records + *count, sizeof(RevEvalRecord), capacity - *count,
+                                  file);
+        if (read == 0) break;
+        *count += read;
+    }
+    fclose(file);
+    if (records == NULL) printf("Failed to allocate memory.\n");
+    return records;
+}
+
+static void printEpoch(int epoch, double mse, void *user_data) {
+    const uint64_t start_ms = *(const uint64_t *)user_data;
+    printf("%5d  %10.3f  %9llu\n", epoch, mse, (unsigned long long)(getWallMs() - start_ms));
+    fflush(stdout);
+}
+
+static int fitWeights(int argc, char *argv[]) {
+    if (argc < 2) return -1;
+    RevTrainParams params;
+    revInitTrainParams(&params);
+    if (argc > 2) params.epochs = atoi(argv[2]);
+    if (argc > 3) params.threads = atoi(argv[3]);
+    if (argc > 4) params.learning_rate = atof(argv[4]);
+
+    RevEvalWeights *weights = (argc > 5) ? revLoadEvalWeights(argv[5]) : revNewEvalWeights();
+    if (weights == NULL) {
+        if (argc > 5)
+            printf("Failed to load %s.\n", argv[5]);
+        else
+            printf("Failed to allocate memory.\n");
+        return 1;
+    }
+    size_t count;
+    uint64_t start_ms = getWallMs();
+    RevEvalRecord *records = loadRecords(argv[0], &count);
+    if (records == NULL) {
+        revFreeEvalWeights(weights);
+        return 1;
+    }
+    printf("%llu records, loaded in %llu ms\n", (unsigned long long)count,
+           (unsigned long long)(getWallMs() - start_ms));
+
+    start_ms = getWallMs();
+    params.callback = printEpoch;
+    params.user_data = &start_ms;
+    printf("epoch         mse   time(ms)\n");
+    int ok = revTrainEvalWeights(weights, records, count, &params);
+    if (!ok) {
+        printf("Failed to allocate memory.\n");
+    } else if (!revSaveEvalWeights(weights, argv[1])) {
+        printf("Failed to save %s.\n", argv[1]);
+        ok = 0;
+    }
+    free(records);
+    revFreeEvalWeights(weights);
+    return ok ? 0 : 1;
+}
+
+static int evalWeights(int argc, char *argv[]) {
+    if (argc < 2) return -1;
+    RevEvalWeights *weights = revLoadEvalWeights(argv[1]);
+    if (weights == NULL) {
+        printf("Failed to load %s.\n", argv[1]);
+        return 1;
+    }
+    size_t count;
+    RevEvalRecord *records = loadRecords(argv[0], &count);
+    RevBoard *board = revNewBoard();
+    if (records == NULL || board == NULL) {
+        free(records);
+        revFreeBoard(board);
+        revFreeEvalWeights(weights);
+        return 1;
+    }
+
+    double sse[REV_EVAL_STAGES] = { 0 };
+    size_t counts[REV_EVAL_STAGES] = { 0 };
+    int features[REV_EVAL_FEATURES];
+    for (size_t i = 0; i < count; i++) {
+        revSetBitboard(board, revGetCurrentPlayer(board), records[i].p_board);
+        revSetBitboard(board, (RevDiskType)!revGetCurrentPlayer(board), records[i].o_board);
+        const int stage = revGetEvalFeatures(board, features);
+        const double error = records[i].score - revEvaluate(weights, board);
+        sse[stage] += error * error;
+        counts[stage]++;
+    }
+    printf("stage     records         mse\n");
+    for (int stage = 0; stage < REV_EVAL_STAGES; stage++) {
+        printf("%5d  %10llu  %10.3f\n", stage, (unsigned long long)counts[stage],
+               (counts[stage] > 0) ? sse[stage] / (double)counts[stage] : 0.0);
+    }
+    free(records);
+    revFreeBoard(board);
+    revFreeEvalWeights(weights);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int ret = -1;
+    if (argc >= 2 && strcmp(argv[1], "gen") == 0)
+        ret = genRecords(argc - 2, argv + 2);
+    else if (argc >= 2 && strcmp(argv[1], "fit") == 0)
+        ret = fitWeights(argc - 2, argv + 2);
+    else if (argc >= 2 && strcmp(argv[1], "eval") == 0)
+        ret = evalWeights(argc - 2, argv + 2);
+    if (ret < 0) {
+        printf("Usage:\n");
+        printf("  train gen <records_file> [games] [depth] [random_moves] [seed]\n");
+        printf("  train fit <records_file> <weights_file> [epochs] [threads] [learning_rate]"
+               " [init_file]\n");
+        printf("  train eval <records_file> <weights_file>\n");
+        return 1;
+    }
+    return ret;
+}
@@ -0,0 +1,64 @@
+// Counts unique positions at each ply from the initial position.
+// Usage: unique <depth> [threads] [memory_mb] [temp_dir] [output_file]
+//
+// Transpositions and symmetric positions are counted once.
+// Plies that don't fit in memory_mb are sorted in parts and merged from files in temp_dir.
+// The positions of the last ply are saved to output_file if it's specified.
+#ifndef _WIN32
+// clock_gettime() is hidden in strict C99 mode.
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include "reversi.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define MAX_DEPTH 60
+
+static uint64_t getWallMs(void) {
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+#endif
+}
+
+static void printPly(int ply, uint64_t count, void *user_data) {
+    const uint64_t start_ms = *(const uint64_t *)user_data;
+    printf("%4d  %14llu  %9llu\n", ply, (unsigned long long)count,
+           (unsigned long long)(getWallMs() - start_ms));
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+    const int depth = (argc > 1) ? atoi(argv[1]) : -1;
+    if (depth < 0 || depth > MAX_DEPTH) {
+        printf("Usage:\n");
+        printf("  unique <depth> [threads] [memory_mb] [temp_dir] [output_file]\n");
+        return 1;
+    }
+    RevEnumParams params;
+    revInitEnumParams(&params);
+    if (argc > 2) params.threads = atoi(argv[2]);
+    if (argc > 3) params.memory_mb = atoi(argv[3]);
+    if (argc > 4) params.temp_dir = argv[4];
+    if (argc > 5) params.output_path = argv[5];
+    uint64_t start_ms = getWallMs();
+    params.callback = printPly;
+    params.user_data = &start_ms;
+
+    uint64_t counts[MAX_DEPTH + 1];
+    printf(" ply       positions   time(ms)\n");
+    if (!revCountUniquePositions(depth, &params, counts)) {
+        printf("Failed to allocate memory or to write temporary files.\n");
+        return 1;
+    }
+    return 0;
+}